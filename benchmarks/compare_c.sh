@@ -0,0 +1,51 @@
+#!/bin/sh
+# Runs each benchmark through the interpreter and through `--emit-c` + the system C compiler,
+# checks that both print the same thing and reports the wall time of each.
+#
+#   benchmarks/compare_c.sh ./latimer                      # every benchmark
+#   benchmarks/compare_c.sh ./latimer benchmarks/calls.lt  # just these
+#
+# CC and CFLAGS pick the C compiler (default: cc -O2).
+
+latimer=${1:?usage: compare_c.sh path/to/latimer [file.lt ...]}
+shift
+[ $# -eq 0 ] && set -- "$(dirname "$0")"/*.lt
+
+cc=${CC:-cc}
+cflags=${CFLAGS:--O2}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now() {
+    date +%s%N
+}
+
+printf '%-24s %12s %12s %12s\n' benchmark interpreter "emit-c" speedup
+for file in "$@"; do
+    name=$(basename "$file" .lt)
+
+    if ! "$latimer" --emit-c "$work/$name.c" "$file" 2> "$work/emit.err"; then
+        printf '%-24s skipped: %s\n' "$name" "$(head -n 1 "$work/emit.err")"
+        continue
+    fi
+    if ! $cc $cflags -o "$work/$name" "$work/$name.c"; then
+        printf '%-24s skipped: C compiler failed\n' "$name"
+        continue
+    fi
+
+    start=$(now)
+    "$latimer" "$file" > "$work/interpreter.out" 2>&1
+    interpreted=$(( ($(now) - start) / 1000000 ))
+
+    start=$(now)
+    "$work/$name" > "$work/compiled.out" 2>&1
+    compiled=$(( ($(now) - start) / 1000000 ))
+
+    if ! cmp -s "$work/interpreter.out" "$work/compiled.out"; then
+        printf '%-24s output differs\n' "$name"
+        continue
+    fi
+
+    printf '%-24s %10sms %10sms %11sx\n' "$name" "$interpreted" "$compiled" \
+        "$(awk "BEGIN { printf \"%.1f\", $interpreted / ($compiled > 0 ? $compiled : 1) }")"
+done
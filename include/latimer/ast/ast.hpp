@@ -5,9 +5,21 @@
 #include <vector>
 
 #include <latimer/lexical_analysis/token.hpp>
+#include <latimer/semantic_analysis/type.hpp>
 
 class AstVisitor;
 
+// Filled in by the Resolver: the variable lives `depth_` environments up from the current one,
+// at index `slot_` of that environment.
+struct VariableSlot {
+    static constexpr int GLOBAL = -1;     // `slot_` indexes the global environment directly
+    static constexpr int UNRESOLVED = -2; // not visible at runtime, using it is a runtime error
+    static constexpr int CAPTURE = -3;    // `slot_` indexes the running function's closure
+
+    int depth_ = UNRESOLVED;
+    int slot_ = 0;
+};
+
 class AstNode {
     public:
     int line_;
@@ -67,8 +79,11 @@ using AstExprPtr = std::unique_ptr<AstExpr>;
 
 class AstExpr : public AstNode {
 public:
+    TypePtr type_; // static type, recorded by the Checker
+
     explicit AstExpr(int line)
-        : AstNode(line) {}
+        : AstNode(line)
+        , type_() {}
 
     virtual ~AstExpr() = default;
 
@@ -114,6 +129,89 @@ public:
     void accept(AstVisitor& visitor) override;
 };
 
+// Unary expression whose operand type the Checker proved, so it runs with a single tag test for
+// null instead of trying every type the operator takes.
+// Produced by the TypeSpecializer from an AstExprUnary.
+class AstExprTypedUnary : public AstExprUnary {
+public:
+    enum Kind {
+        INT_NEGATE,
+        INT_BIT_NOT,
+        DOUBLE_NEGATE,
+        BOOL_NOT,
+    };
+
+    Kind kind_;
+
+    explicit AstExprTypedUnary(int line, Token op, AstExprPtr right, Kind kind)
+        : AstExprUnary(line, op, std::move(right))
+        , kind_(kind) {}
+
+    void accept(AstVisitor& visitor) override;
+};
+
+// Binary expression whose operand types the Checker proved, so it runs with a single tag test per
+// operand for null instead of trying every pair of types the operator takes.
+// Produced by the TypeSpecializer from an AstExprBinary.
+class AstExprTypedBinary : public AstExprBinary {
+public:
+    enum Kind {
+        INT_ADD,
+        INT_SUBTRACT,
+        INT_MULTIPLY,
+        INT_DIVIDE,
+        INT_MODULO,
+        INT_SHIFT_LEFT,
+        INT_SHIFT_RIGHT,
+        INT_BIT_AND,
+        INT_BIT_OR,
+        INT_BIT_XOR,
+        INT_LESS,
+        INT_LESS_EQUAL,
+        INT_GREATER,
+        INT_GREATER_EQUAL,
+        INT_EQUAL,
+        INT_NOT_EQUAL,
+
+        DOUBLE_ADD,
+        DOUBLE_SUBTRACT,
+        DOUBLE_MULTIPLY,
+        DOUBLE_DIVIDE,
+        DOUBLE_LESS,
+        DOUBLE_LESS_EQUAL,
+        DOUBLE_GREATER,
+        DOUBLE_GREATER_EQUAL,
+        DOUBLE_EQUAL,
+        DOUBLE_NOT_EQUAL,
+
+        CHAR_LESS,
+        CHAR_LESS_EQUAL,
+        CHAR_GREATER,
+        CHAR_GREATER_EQUAL,
+        CHAR_EQUAL,
+        CHAR_NOT_EQUAL,
+
+        BOOL_EQUAL,
+        BOOL_NOT_EQUAL,
+
+        STRING_CONCAT,
+        STRING_LESS,
+        STRING_LESS_EQUAL,
+        STRING_GREATER,
+        STRING_GREATER_EQUAL,
+        STRING_EQUAL,
+        STRING_NOT_EQUAL,
+    };
+
+    Kind kind_;
+
+    explicit AstExprTypedBinary(int line, AstExprPtr left, Token op, AstExprPtr right, Kind kind)
+        : AstExprBinary(line, std::move(left), op, std::move(right))
+        , kind_(kind) {}
+
+    void accept(AstVisitor& visitor) override;
+};
+
 class AstExprTernary : public AstExpr {
 public:
     AstExprPtr condition_;
@@ -196,10 +294,26 @@ public:
 class AstExprVariable : public AstExpr {
 public:
     Token name_;
+    VariableSlot slot_;
 
     explicit AstExprVariable(int line, Token name)
         : AstExpr(line)
-        , name_(name) {}
+        , name_(name)
+        , slot_() {}
+
+    void accept(AstVisitor& visitor) override;
+};
+
+// Read of a temporary the LoopInvariantHoister computes before a loop, keeping the expression it
+// replaced. Computing the temporary up front fails when an operand is null, which leaves it null;
+// the expression then runs here instead, failing where it would have without the hoisting.
+class AstExprHoisted : public AstExprVariable {
+public:
+    AstExprPtr expr_;
+
+    explicit AstExprHoisted(int line, Token name, AstExprPtr expr)
+        : AstExprVariable(line, name)
+        , expr_(std::move(expr)) {}
 
     void accept(AstVisitor& visitor) override;
 };
@@ -208,11 +322,13 @@ class AstExprAssignment : public AstExpr {
 public:
     Token name_;
     AstExprPtr value_;
+    VariableSlot slot_;
 
     explicit AstExprAssignment(int line, Token name, AstExprPtr value)
         : AstExpr(line)
         , name_(name)
-        , value_(std::move(value)) {}
+        , value_(std::move(value))
+        , slot_() {}
 
     void accept(AstVisitor& visitor) override;
 };
@@ -248,12 +364,16 @@ public:
     AstTypePtr type_;
     Token name_;
     AstExprPtr initializer_;
+    int slot_; // index in the enclosing environment, set by the Resolver
+    bool speculative_; // A hoisted temporary: an initializer that fails leaves it null instead
 
     explicit AstStatVarDecl(int line, AstTypePtr type, Token name, AstExprPtr initializer)
         : AstStat(line)
         , type_(std::move(type))
         , name_(name)
-        , initializer_(std::move(initializer)) {}
+        , initializer_(std::move(initializer))
+        , slot_(0)
+        , speculative_(false) {}
 
     void accept(AstVisitor& visitor) override;
 };
@@ -303,13 +423,15 @@ public:
     AstExprPtr condition_;
     AstExprPtr increment_;
     AstStatPtr body_;
+    size_t localCount_; // slots needed by the loop's own environment, set by the Resolver
 
     explicit AstStatFor(int line, AstStatPtr initializer, AstExprPtr condition, AstExprPtr increment, AstStatPtr body)
         : AstStat(line)
         , initializer_(std::move(initializer))
         , condition_(std::move(condition))
         , increment_(std::move(increment))
-        , body_(std::move(body)) {}
+        , body_(std::move(body))
+        , localCount_(0) {}
 
     void accept(AstVisitor& visitor) override;
 };
@@ -333,10 +455,12 @@ public:
 class AstStatBlock : public AstStat {
 public:
     std::vector<AstStatPtr> body_;
+    size_t localCount_; // set by the Resolver
 
     explicit AstStatBlock(int line, std::vector<AstStatPtr> body)
         : AstStat(line)
-        , body_(std::move(body)) {}
+        , body_(std::move(body))
+        , localCount_(0) {}
     
     void accept(AstVisitor& visitor) override;
 };
@@ -350,6 +474,13 @@ public:
     std::vector<Token> paramNames_;
     AstStatPtr body_;
 
+    // Set by the Resolver. The closure holds the captures in order followed by the function
+    // itself; the call environment holds the parameters followed by the body's locals.
+    int slot_;
+    std::vector<VariableSlot> captureSlots_;
+    size_t localCount_;
+    bool pure_; // Set by the PurityAnalyzer: the result depends only on the arguments and closure
+
     explicit AstStatFuncDecl(int line, AstTypePtr returnType, Token name, std::vector<Token> captures, std::vector<AstTypePtr> paramTypes, std::vector<Token> paramNames, AstStatPtr body)
         : AstStat(line)
         , returnType_(std::move(returnType))
@@ -357,7 +488,11 @@ public:
         , captures_(captures)
         , paramTypes_(std::move(paramTypes))
         , paramNames_(paramNames)
-        , body_(std::move(body)) {}
+        , body_(std::move(body))
+        , slot_(0)
+        , captureSlots_()
+        , localCount_(0)
+        , pure_(false) {}
 
     void accept(AstVisitor& visitor) override;
 };
@@ -365,10 +500,12 @@ public:
 class AstStatReturn : public AstStat {
 public:
     AstExprPtr value_;
+    bool tailCall_; // Set by the TailCallMarker when value_ is a call whose frame can replace ours
 
     explicit AstStatReturn(int line, AstExprPtr value)
         : AstStat(line)
-        , value_(std::move(value)) {}
+        , value_(std::move(value))
+        , tailCall_(false) {}
 
     void accept(AstVisitor& visitor) override;
 };
@@ -394,6 +531,11 @@ public:
     virtual void visitAssignmentExpr(AstExprAssignment& expr) = 0;
     virtual void visitCallExpr(AstExprCall& expr) = 0;
 
+    // Visitors that don't care about type specialization see the plain node
+    virtual void visitTypedUnaryExpr(AstExprTypedUnary& expr) { visitUnaryExpr(expr); }
+    virtual void visitTypedBinaryExpr(AstExprTypedBinary& expr) { visitBinaryExpr(expr); }
+    virtual void visitHoistedExpr(AstExprHoisted& expr) { visitVariableExpr(expr); }
+
     virtual void visitVarDeclStat(AstStatVarDecl& stat) = 0;
     virtual void visitExpressionStat(AstStatExpression& stat) = 0;
     virtual void visitIfElseStat(AstStatIfElse& stat) = 0;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+
+// Base for passes that rewrite the AST in place. By default every visit just transforms the node's
+// children; a pass overrides the visits it cares about and replaces the node being visited by
+// moving the new node into exprReplacement_ / statReplacement_ before returning.
+class AstTransformer : public AstVisitor {
+public:
+    void transform(std::vector<AstStatPtr>& statements);
+
+protected:
+    AstExprPtr exprReplacement_;
+    AstStatPtr statReplacement_;
+
+    void transformExpr(AstExprPtr& expr);
+    void transformStat(AstStatPtr& stat);
+
+    void visitPrimitiveType(AstTypePrimitive& type) override;
+    void visitFunctionType(AstTypeFunction& type) override;
+
+    void visitGroupExpr(AstExprGroup& expr) override;
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTernaryExpr(AstExprTernary& expr) override;
+    void visitLiteralNullExpr(AstExprLiteralNull& expr) override;
+    void visitLiteralBoolExpr(AstExprLiteralBool& expr) override;
+    void visitLiteralIntExpr(AstExprLiteralInt& expr) override;
+    void visitLiteralDoubleExpr(AstExprLiteralDouble& expr) override;
+    void visitLiteralStringExpr(AstExprLiteralString& expr) override;
+    void visitLiteralCharExpr(AstExprLiteralChar& expr) override;
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitHoistedExpr(AstExprHoisted& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitExpressionStat(AstStatExpression& stat) override;
+    void visitIfElseStat(AstStatIfElse& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBreakStat(AstStatBreak& stat) override;
+    void visitContinueStat(AstStatContinue& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+    void visitReturnStat(AstStatReturn& stat) override;
+};
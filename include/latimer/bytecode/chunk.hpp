@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <latimer/interpreter/value.hpp>
+
+enum class OpCode : uint8_t {
+    // Constants and literals
+    CONSTANT,        // u16 constant index
+    NIL,
+    TRUE,
+    FALSE,
+    POP,
+    POP_N,           // u16 count
+
+    // Variables
+    GET_LOCAL,       // u16 slot (relative to the frame base)
+    SET_LOCAL,       // u16 slot
+    GET_GLOBAL,      // u16 global index
+    SET_GLOBAL,      // u16 global index
+    GET_CAPTURE,     // u16 capture index
+    SET_CAPTURE,     // u16 capture index
+    GET_UNDEFINED,   // u16 constant index of the variable name
+    SET_UNDEFINED,   // u16 constant index of the variable name
+
+    // Operators
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    MODULO,
+    SHIFT_LEFT,
+    SHIFT_RIGHT,
+    BIT_AND,
+    BIT_OR,
+    BIT_XOR,
+    LOGICAL_AND,
+    LOGICAL_OR,
+    EQUAL,
+    NOT_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    NOT,
+    BIT_NOT,
+    NEGATE,
+
+    // Control flow
+    JUMP,            // u16 forward offset
+    JUMP_IF_FALSE,   // u8 condition kind, u16 forward offset; pops the condition
+    LOOP,            // u16 backward offset
+
+    // Functions
+    CALL,            // u8 argument count
+    TAIL_CALL,       // u8 argument count; a closure takes over the current frame, anything else is a CALL
+    CLOSURE,         // u16 function index, then per capture: u8 kind, u16 index
+    RETURN,
+};
+
+// Where a captured value is copied from when a CLOSURE instruction runs
+enum class CaptureKind : uint8_t {
+    LOCAL,
+    GLOBAL,
+    CAPTURE,
+    UNDEFINED, // index is a constant holding the variable name
+};
+
+// Which statement a JUMP_IF_FALSE belongs to, so the VM reports the same errors as the AstInterpreter
+enum class ConditionKind : uint8_t {
+    IF,
+    WHILE,
+    FOR,
+    TERNARY,
+};
+
+struct Chunk {
+    std::vector<uint8_t> code_;
+    std::vector<int> lines_;
+    std::vector<Runtime::Value> constants_;
+
+    void write(uint8_t byte, int line);
+    void writeShort(uint16_t value, int line);
+    size_t addConstant(Runtime::Value value);
+};
+
+struct FunctionProto {
+    std::string name_;
+    size_t arity_;
+    size_t captureCount_;
+    Chunk chunk_;
+
+    explicit FunctionProto(std::string name, size_t arity)
+        : name_(std::move(name))
+        , arity_(arity)
+        , captureCount_(0)
+        , chunk_() {}
+};
+
+using FunctionProtoPtr = std::unique_ptr<FunctionProto>;
+
+// Output of the BytecodeCompiler. functions_[0] is the top-level script.
+struct Program {
+    std::vector<FunctionProtoPtr> functions_;
+    std::vector<std::string> globalNames_;
+};
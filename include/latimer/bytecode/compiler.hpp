@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/bytecode/chunk.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+// Compiles a checked AST into bytecode for the VM.
+// Scoping mirrors the AstInterpreter: functions only see their parameters, their own
+// locals, their capture list, themselves and the natives. Names the AstInterpreter would
+// fail to find at runtime compile to GET_UNDEFINED/SET_UNDEFINED so the error surfaces
+// at the same point of execution.
+class BytecodeCompiler : public AstVisitor {
+public:
+    explicit BytecodeCompiler(Utils::ErrorHandler& errorHandler);
+
+    Program compile(const std::vector<AstStatPtr>& statements);
+
+private:
+    struct Local {
+        std::string name_;
+        int depth_;
+    };
+
+    struct Loop {
+        size_t start_;
+        int scopeDepth_;
+        std::vector<size_t> breakJumps_;
+        std::vector<size_t> continueJumps_;
+    };
+
+    struct FunctionState {
+        FunctionProto* proto_;
+        FunctionState* enclosing_;
+        std::string selfName_;
+        std::vector<std::string> captures_;
+        std::vector<Local> locals_;
+        std::vector<Loop> loops_;
+        int scopeDepth_;
+        bool isScript_;
+    };
+
+    enum class VarKind {
+        LOCAL,
+        GLOBAL,
+        CAPTURE,
+        UNDEFINED,
+    };
+
+    struct VarRef {
+        VarKind kind_;
+        uint16_t index_;
+    };
+
+    Utils::ErrorHandler& errorHandler_;
+    Program program_;
+    FunctionState* current_;
+    std::unordered_map<std::string, uint16_t> globals_;
+    std::unordered_set<std::string> natives_;
+    int line_;
+
+    void compileStat(AstStat& stat);
+    void compileExpr(AstExpr& expr);
+
+    Chunk& chunk();
+    void emit(OpCode op);
+    void emitByte(uint8_t byte);
+    void emitShort(uint16_t value);
+    void emitOp(OpCode op, uint16_t operand);
+    uint16_t makeConstant(Runtime::Value value);
+    size_t emitJump(OpCode op);
+    size_t emitConditionalJump(ConditionKind kind);
+    void patchJump(size_t offset);
+    void emitLoop(size_t loopStart);
+    void emitPops(size_t count);
+
+    void beginScope();
+    void endScope();
+    size_t localsAbove(int depth);
+    void declareVariable(const std::string& name);
+    VarRef resolve(FunctionState& state, const std::string& name);
+    uint16_t addGlobal(const std::string& name);
+
+    void visitPrimitiveType(AstTypePrimitive& type) override;
+    void visitFunctionType(AstTypeFunction& type) override;
+
+    void visitGroupExpr(AstExprGroup& expr) override;
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTernaryExpr(AstExprTernary& expr) override;
+    void visitLiteralNullExpr(AstExprLiteralNull& expr) override;
+    void visitLiteralBoolExpr(AstExprLiteralBool& expr) override;
+    void visitLiteralIntExpr(AstExprLiteralInt& expr) override;
+    void visitLiteralDoubleExpr(AstExprLiteralDouble& expr) override;
+    void visitLiteralStringExpr(AstExprLiteralString& expr) override;
+    void visitLiteralCharExpr(AstExprLiteralChar& expr) override;
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitExpressionStat(AstStatExpression& stat) override;
+    void visitIfElseStat(AstStatIfElse& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBreakStat(AstStatBreak& stat) override;
+    void visitContinueStat(AstStatContinue& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+    void visitReturnStat(AstStatReturn& stat) override;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <latimer/bytecode/chunk.hpp>
+#include <latimer/interpreter/collector.hpp>
+#include <latimer/interpreter/value.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+// A compiled function together with the values copied out of its capture list
+class Closure : public Runtime::CollectedCallable {
+public:
+    const FunctionProto* proto_;
+    std::vector<Runtime::Value> captures_;
+
+    explicit Closure(Runtime::Collector& collector, const FunctionProto* proto);
+
+    Runtime::Value* ownedValues(size_t& count) override;
+    size_t arity() const override;
+    Runtime::Value call(int line, AstInterpreter& interpreter, Runtime::Arguments arguments) override;
+    std::string toString() const override;
+};
+
+class VM {
+public:
+    explicit VM(Utils::ErrorHandler& errorHandler);
+
+    void interpret(const Program& program);
+
+    Runtime::Collector& collector();
+
+private:
+    struct CallFrame {
+        Closure* closure_;
+        const uint8_t* ip_;
+        size_t base_;
+    };
+
+    static constexpr size_t FRAMES_MAX = 1 << 16;
+
+    Runtime::Collector collector_; // First, so every closure is gone before it is
+    Utils::ErrorHandler& errorHandler_;
+    const Program* program_;
+    std::vector<Runtime::Value> stack_;
+    std::vector<CallFrame> frames_;
+    std::vector<Runtime::Value> globals_;
+
+    void run();
+    void callValue(const Runtime::Value& callee, uint8_t argCount, int line);
+    int currentLine();
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/optimizer/scope_tracker.hpp>
+#include <latimer/semantic_analysis/type.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+// Translates a checked AST into a standalone C program (`--emit-c`) that prints what the
+// AstInterpreter would, so a script can be built once with the system C compiler.
+//
+// The Checker's types become C types: int64_t, double, bool, char, and reference counted
+// lt_string* / lt_closure* from the runtime (see c_runtime.hpp). Expressions are lowered into
+// temporaries one operation at a time, so operands run left to right like in the interpreter,
+// and every string or closure temporary owns a reference that its consumer releases.
+//
+// Every function becomes a top-level C function taking its closure as the first argument.
+// Scoping mirrors the AstInterpreter: a function sees its parameters, locals, captures (a copy
+// kept in its closure), itself and the natives, and a name it would fail to find at runtime
+// compiles to the same runtime error. A self call in tail position becomes a jump, so tail
+// recursion runs in constant stack as it does in the interpreter.
+//
+// Null has no C representation, so a `null` literal is reported as an error, and a function
+// that ends without returning its value stops the program with a runtime error.
+class CEmitter : public AstVisitor {
+public:
+    explicit CEmitter(Utils::ErrorHandler& errorHandler);
+
+    std::string emit(const std::vector<AstStatPtr>& statements);
+
+private:
+    struct Unsupported {
+        int line_;
+        std::string what_;
+    };
+
+    struct Binding {
+        std::string lvalue_; // Where the value lives: a C local, a closure field or self_
+        TypePtr type_;
+        bool self_; // The function's own name inside its body
+        bool read_; // Whether any code reads it, so that unread scalar locals can be marked used
+    };
+
+    struct Loop {
+        size_t scopeDepth_; // Blocks opened before the loop, which break/continue leave alone
+        int label_;
+        bool continued_;
+    };
+
+    struct Function {
+        int id_; // 0 for main()
+        const AstStatFuncDecl* decl_; // nullptr for main()
+        TypePtr returnType_;
+        std::string body_;
+        int indent_;
+        int temps_;
+        bool tailCalled_;
+        std::vector<std::vector<std::string>> managed_; // Per C block, the string/closure locals it releases
+        std::vector<std::vector<const void*>> scalars_; // Per C block, the keys of its other locals
+        std::vector<Loop> loops_;
+    };
+
+    Utils::ErrorHandler& errorHandler_;
+    ScopeTracker scopes_;
+    std::unordered_map<const void*, Binding> bindings_;
+    Function* current_;
+    int functions_;
+    int labels_;
+    std::unordered_map<std::string, std::string> literals_; // String literal => its global
+    std::string literalInits_;
+    std::string declarations_;
+    std::string definitions_;
+    std::string result_; // C expression of the last expression, empty for void
+    TypePtr type_; // Last converted AstType
+
+    void emitStat(AstStat& stat);
+    std::string emitExpr(AstExpr& expr);
+    TypePtr convertType(AstType& type);
+
+    void line(const std::string& code);
+    std::string temp(const Type& type, const std::string& init);
+    void declare(const std::string& name, const void* key, Binding binding);
+    const Binding* lookup(const std::string& name) const;
+    const Binding* read(const std::string& name); // lookup() that marks the binding read
+
+    void beginScope();
+    void endScope();
+    void markUnreadLocals(); // `(void)` the innermost block's scalar locals nothing read, for -Wall
+    void emitScoped(AstStat& stat);
+    void releaseLocals(size_t fromScope);
+    void emitLoop(AstStat& body, AstExpr* condition, AstExpr* increment);
+    void emitArguments(AstExprCall& expr, std::vector<std::string>& arguments);
+    bool emitNativeCall(AstExprCall& expr);
+
+    std::string cType(const Type& type) const;
+    std::string signature(const FunctionType& type) const;
+    bool managed(const Type& type) const;
+    std::string show(const Type& type, const std::string& value) const;
+    std::string stringLiteral(const std::string& value);
+
+    void visitPrimitiveType(AstTypePrimitive& type) override;
+    void visitFunctionType(AstTypeFunction& type) override;
+
+    void visitGroupExpr(AstExprGroup& expr) override;
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTernaryExpr(AstExprTernary& expr) override;
+    void visitLiteralNullExpr(AstExprLiteralNull& expr) override;
+    void visitLiteralBoolExpr(AstExprLiteralBool& expr) override;
+    void visitLiteralIntExpr(AstExprLiteralInt& expr) override;
+    void visitLiteralDoubleExpr(AstExprLiteralDouble& expr) override;
+    void visitLiteralStringExpr(AstExprLiteralString& expr) override;
+    void visitLiteralCharExpr(AstExprLiteralChar& expr) override;
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitExpressionStat(AstStatExpression& stat) override;
+    void visitIfElseStat(AstStatIfElse& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitBreakStat(AstStatBreak& stat) override;
+    void visitContinueStat(AstStatContinue& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+    void visitReturnStat(AstStatReturn& stat) override;
+};
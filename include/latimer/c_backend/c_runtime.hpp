@@ -0,0 +1,5 @@
+#pragma once
+
+// The C source of the runtime that every file written by the CEmitter starts with: reference
+// counted strings and closures, printing, the natives and runtime errors.
+const char* cRuntimeSource();
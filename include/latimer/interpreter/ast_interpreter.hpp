@@ -1,63 +1,91 @@
 #pragma once
 
-#include <exception>
+#include <memory>
+#include <string>
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
 
 #include <latimer/lexical_analysis/token.hpp>
 #include <latimer/utils/error_handler.hpp>
+#include <latimer/utils/tracer.hpp>
 #include <latimer/ast/ast.hpp>
 #include <latimer/interpreter/value.hpp>
-
-class Environment;
-using EnvironmentPtr = std::shared_ptr<Environment>;
-
-class Environment {
-public:
-    std::unordered_map<std::string, Runtime::Value> values_;
-    std::unordered_set<std::string> declared_;
-    EnvironmentPtr enclosing_;
-
-    explicit Environment();
-    explicit Environment(EnvironmentPtr enclosing);
-    
-    void declare(std::string name);
-    bool isDeclared(std::string name);
-    void define(std::string name, Runtime::Value value);
-    void assign(Token name, Runtime::Value value);
-    Runtime::Value get(Token name);
-};
-
-class EnvironmentGuard {
-public:
-    EnvironmentPtr& target_;
-    EnvironmentPtr previous_;
-
-    EnvironmentGuard(EnvironmentPtr& env, EnvironmentPtr newEnv)
-        : target_(env)
-        , previous_(env) {
-            target_ = newEnv;
-    }
-
-    ~EnvironmentGuard() {
-        target_ = previous_;
-    }
+#include <latimer/interpreter/collector.hpp>
+#include <latimer/interpreter/environment.hpp>
+#include <latimer/interpreter/heap_profiler.hpp>
+#include <latimer/interpreter/line_counter.hpp>
+#include <latimer/interpreter/memoizer.hpp>
+#include <latimer/interpreter/profiler.hpp>
+#include <latimer/interpreter/sample_profiler.hpp>
+#include <latimer/jit/jit.hpp>
+
+// What observes a run of the AstInterpreter, each nullptr unless its option is on
+struct Instrumentation {
+    Profiler* profiler_ = nullptr;
+    SampleProfiler* sampler_ = nullptr;
+    Tracer* tracer_ = nullptr; // Only followed into calls if it traces them
+    HeapProfiler* heap_ = nullptr;
+    LineCounter* lines_ = nullptr;
 };
 
 class AstInterpreter : public AstVisitor {
 public:
-    explicit AstInterpreter(Utils::ErrorHandler& errorHandler);
+    explicit AstInterpreter(Utils::ErrorHandler& errorHandler, bool jit = false, bool memoize = false, Instrumentation instrumentation = {});
 
     void interpret(const std::vector<AstStatPtr>& statements);
 
+    struct AllocationStats {
+        size_t framesPushed_;
+        size_t arenaChunks_;
+        size_t arenaBytes_;
+        size_t closures_;
+        size_t capturedValues_;
+    };
+
+    AllocationStats allocationStats() const;
+    const Jit* jit() const; // nullptr unless the JIT is enabled
+    const Memoizer* memoizer() const; // nullptr unless memoization is enabled
+    Runtime::Collector& collector();
+
+    // Named global slots, then the frames being run and the value stack, for heap snapshots
+    HeapProfiler::Roots heapRoots() const;
+
 private:
+    // How a statement finished. break/continue/return unwind by returning this from execute(...)
+    // up to the enclosing loop or call instead of throwing, so exceptions are left to real errors
+    enum class Completion {
+        NORMAL,
+        BREAK,
+        CONTINUE,
+        RETURN,
+    };
+
+    Runtime::Collector collector_; // First, so every closure is gone before it is
     Runtime::Value result_;
+    Completion completion_;
+    Runtime::Value returnValue_;
     Utils::ErrorHandler& errorHandler_;
-    EnvironmentPtr globals_;
-    EnvironmentPtr env_;
-
-    void execute(AstStat& stat);
+    Environment globals_;
+    Environment* env_;
+    Runtime::Value* closure_; // Captures of the running function, then the function; nullptr in the script
+    std::vector<Runtime::Value> stack_; // Arguments of the calls being set up
+    Runtime::Value tailCallee_; // Set by a tail `return f(...)` for the enclosing UserFunction::call
+    std::vector<Runtime::Value> tailArguments_;
+    int tailCallLine_;
+    FrameArena frames_;
+    size_t closures_;
+    size_t capturedValues_;
+    std::unique_ptr<Jit> jit_;
+    Jit::Entry* running_; // JIT entry of the function being interpreted, whose loops count towards it
+    std::unique_ptr<Memoizer> memoizer_;
+    Profiler* profiler_; // nullptr unless profiling
+    SampleProfiler* sampler_; // nullptr unless sampling; its shadow stack follows the calls
+    Tracer* tracer_; // nullptr unless tracing calls
+    HeapProfiler* heap_; // nullptr unless tracking allocations
+    uint64_t* lineCounts_; // A LineCounter's counts, indexed by line; nullptr unless counting lines
+    bool tracksLines_; // Whether the sampler or heap profiler wants the line of every statement
+    std::vector<std::string> globalNames_; // By slot, filled in for heap snapshots
+
+    Completion execute(AstStat& stat);
     Runtime::Value evaluate(AstExpr& expr);
 
     void visitPrimitiveType(AstTypePrimitive& type) override;
@@ -66,6 +94,8 @@ private:
     void visitGroupExpr(AstExprGroup& expr) override;
     void visitUnaryExpr(AstExprUnary& expr) override;
     void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTypedUnaryExpr(AstExprTypedUnary& expr) override;
+    void visitTypedBinaryExpr(AstExprTypedBinary& expr) override;
     void visitTernaryExpr(AstExprTernary& expr) override;
     void visitLiteralNullExpr(AstExprLiteralNull& expr) override;
     void visitLiteralBoolExpr(AstExprLiteralBool& expr) override;
@@ -74,6 +104,7 @@ private:
     void visitLiteralStringExpr(AstExprLiteralString& expr) override;
     void visitLiteralCharExpr(AstExprLiteralChar& expr) override;
     void visitVariableExpr(AstExprVariable& expr) override;
+    void visitHoistedExpr(AstExprHoisted& expr) override;
     void visitAssignmentExpr(AstExprAssignment& expr) override;
     void visitCallExpr(AstExprCall& expr) override;
 
@@ -88,26 +119,35 @@ private:
     void visitFuncDeclStat(AstStatFuncDecl& stat) override;
     void visitReturnStat(AstStatReturn& stat) override;
 
-    struct BreakSignal : public std::exception {};
-    struct ContinueSignal : public std::exception {};
-    struct ReturnSignal : public std::exception {
-        Runtime::Value value_;
-
-        explicit ReturnSignal(Runtime::Value value)
-            : std::exception()
-            , value_(value) {}
-    };
-    bool requireBool(const Runtime::Value& value, int line, const std::string& errorMsg);
-    void executeBlocK(const std::vector<AstStatPtr>& body, EnvironmentPtr localEnv);
-
-    struct UserFunction : public Runtime::Callable {
+    // The generic operators on evaluated operands; typed expressions fall back to them on a null
+    void applyUnary(AstExprUnary& expr, const Runtime::Value& right);
+    void applyBinary(AstExprBinary& expr, const Runtime::Value& left, const Runtime::Value& right);
+    Runtime::Callable* requireCallable(const Runtime::Value& callee, Runtime::Arguments arguments, int line);
+    bool requireBool(const Runtime::Value& value, int line, const char* errorMsg);
+    Runtime::Value& lookup(const VariableSlot& slot);
+    Runtime::Value* ownedArguments(Runtime::Arguments arguments);
+    Completion executeBlocK(const std::vector<AstStatPtr>& body);
+    void trackLine(int line);
+
+    // A flat closure: the captured values in order, then the function itself, sized once when the
+    // declaration runs. The body reads them by the CAPTURE slots the Resolver assigned, so a call
+    // frame has no enclosing environment.
+    struct UserFunction : public Runtime::CollectedCallable {
         AstStatFuncDecl* decl_;
-        EnvironmentPtr closure_;
+        AstStatBlock* body_;
+        std::unique_ptr<Runtime::Value[]> captures_;
+        Jit::Entry* jit_; // nullptr unless the JIT is enabled
+        std::unique_ptr<Memoizer::Table> memo_; // nullptr unless memoizing a pure function
 
-        explicit UserFunction(AstStatFuncDecl* decl, EnvironmentPtr closer);
+        explicit UserFunction(Runtime::Collector& collector, AstStatFuncDecl* decl, AstStatBlock* body, Jit::Entry* jit, std::unique_ptr<Memoizer::Table> memo);
+        ~UserFunction() override;
 
+        Runtime::Value* ownedValues(size_t& count) override;
         size_t arity() const override;
-        Runtime::Value call(int line, AstInterpreter& interpreter, const std::vector<Runtime::Value>& arguments) override;
+        Runtime::Value call(int line, AstInterpreter& interpreter, Runtime::Arguments arguments) override;
         std::string toString() const override;
+
+    private:
+        Runtime::Value run(int line, AstInterpreter& interpreter, Runtime::Arguments arguments);
     };
 };
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <latimer/interpreter/value.hpp>
+
+namespace Runtime {
+
+class Collector;
+
+// A callable owning Values of its own, the captures of a closure. Reference counting alone can't
+// free these: a closure's last slot holds the closure itself, and closures can be assigned into
+// each other's captures. Every one of them is tracked by its engine's Collector while it lives.
+class CollectedCallable : public Callable {
+public:
+    explicit CollectedCallable(Collector& collector);
+    ~CollectedCallable() override;
+
+    CollectedCallable(const CollectedCallable&) = delete;
+    CollectedCallable& operator=(const CollectedCallable&) = delete;
+
+    // The Values this callable owns, which the Collector traces and clears
+    virtual Value* ownedValues(size_t& count) = 0;
+
+    CollectedCallable* asCollected() override { return this; }
+
+private:
+    friend class Collector;
+
+    Collector& collector_;
+    CollectedCallable* previous_;
+    CollectedCallable* next_;
+    int64_t references_; // Scratch during a collection
+};
+
+// Mark-sweep collector for reference cycles between closures, backing up the reference counts
+// that free everything else. Values held by the engines' C++ code are not enumerable, so roots are
+// found by subtraction: a tracked closure counted more times than the tracked closures refer to
+// it is referenced from outside them (an environment, a stack, a local) and is live. Everything
+// reachable from a live closure through captures is marked, and the captures of the rest are
+// cleared, which lets their counts drop to zero.
+//
+// maybeCollect() runs a collection once the number of tracked closures reaches the threshold. The
+// threshold then becomes twice the survivors, but never less than the configured one, so the
+// work stays proportional to allocation.
+class Collector {
+public:
+    static constexpr size_t DEFAULT_THRESHOLD = 1 << 14;
+
+    struct Stats {
+        size_t collections_;
+        size_t freed_;
+        size_t tracked_; // Closures alive now
+        size_t peakTracked_;
+        double totalPauseMs_;
+        double maxPauseMs_;
+    };
+
+    Collector();
+    ~Collector(); // Frees the cycles nothing refers to any more
+
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+
+    void setThreshold(size_t threshold);
+
+    // Called by the engines before they allocate a closure, when every live one is counted
+    void maybeCollect();
+    void collect();
+
+    Stats stats() const;
+
+private:
+    friend class CollectedCallable;
+
+    CollectedCallable* tracked_; // Most recently allocated first
+    size_t trackedCount_;
+    size_t threshold_;
+    size_t nextCollection_;
+    Stats stats_;
+
+    void track(CollectedCallable* callable);
+    void untrack(CollectedCallable* callable);
+    CollectedCallable* trackedChild(const Value& value) const;
+};
+
+} // namespace Runtime
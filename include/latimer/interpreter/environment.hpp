@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <latimer/interpreter/value.hpp>
+
+// Variables are addressed by the slots the Resolver assigned, so lookups never hash names.
+// The globals own their slots on the heap; block, loop and call frames borrow theirs from the
+// interpreter's FrameArena. Captures are not environments at all, see AstInterpreter::UserFunction.
+class Environment {
+public:
+    Runtime::Value* values_;
+    size_t size_;
+    Environment* enclosing_;
+
+    explicit Environment(size_t slotCount);
+    Environment(Environment* enclosing, Runtime::Value* values, size_t slotCount);
+
+    Environment(const Environment&) = delete;
+    Environment& operator=(const Environment&) = delete;
+
+    // Only heap environments grow; frames are sized by the Resolver up front
+    void define(size_t slot, Runtime::Value value);
+    Environment* ancestor(int depth);
+
+private:
+    std::vector<Runtime::Value> storage_;
+};
+
+// Region allocator for frames. Closures copy their captures out by value, so a frame is never
+// referenced after the block, loop or call that pushed it exits, and frames can be released
+// strictly in reverse order. Chunks are kept once allocated, so steady-state execution pushes
+// and pops frames without touching the heap.
+class FrameArena {
+public:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+    FrameArena();
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    Environment* push(Environment* enclosing, size_t slotCount);
+    void pop(Environment* frame);
+
+    size_t framesPushed() const;
+    size_t chunksAllocated() const;
+    size_t bytesReserved() const;
+
+private:
+    // Where the arena's top was before a frame was pushed, stored in front of the frame
+    struct Mark {
+        size_t chunk_;
+        size_t top_;
+    };
+
+    struct Chunk {
+        std::unique_ptr<std::byte[]> data_;
+        size_t size_;
+    };
+
+    std::vector<Chunk> chunks_;
+    size_t current_;
+    size_t top_;
+    size_t framesPushed_;
+    size_t chunksAllocated_;
+    size_t bytesReserved_;
+
+    std::byte* allocate(size_t bytes);
+};
+
+// Enters a frame for the lifetime of the guard and restores the previous environment on exit.
+// Very Important bc it guarantees that our environment is properly restored (and the frame
+// released) when execute(...) throws an error. Consider this scenario in REPL:
+// > int a = 1;
+// > { int a = 2; some runtime error code }
+// > print a;
+// without the guard, prints 2 (which is incorrect); with guard, prints 1 (correct)
+class EnvironmentGuard {
+public:
+    Environment*& target_;
+    Environment* previous_;
+    FrameArena& arena_;
+
+    EnvironmentGuard(Environment*& env, FrameArena& arena, Environment* enclosing, size_t slotCount)
+        : target_(env)
+        , previous_(env)
+        , arena_(arena) {
+            target_ = arena_.push(enclosing, slotCount);
+    }
+
+    ~EnvironmentGuard() {
+        arena_.pop(target_);
+        target_ = previous_;
+    }
+};
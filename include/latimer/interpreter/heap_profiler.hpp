@@ -0,0 +1,93 @@
+#pragma once
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Runtime {
+class Value;
+} // namespace Runtime
+
+// Allocation tracking for the AstInterpreter (`--heap-profile`). While it runs, strings, closures
+// and call/block frames report when they are made and freed, tagged with the line of the statement
+// being executed; the AST is accounted once up front. Every allocation is kept in a table until
+// freed, so live and peak bytes are exact per category and per line, at the cost of a hash insert
+// and erase per object, which only this mode pays: otherwise the hooks are a null check.
+//
+// A snapshot lists every value reachable from the roots the interpreter passes in (globals, the
+// current frames, the value stack), each object once, closures with their captures. SIGUSR1 asks
+// for one during the run, written at the next statement boundary, for watching a long job grow.
+class HeapProfiler {
+public:
+    enum class Category {
+        AST,
+        FRAME,
+        STRING,
+        CLOSURE,
+        COUNT,
+    };
+
+    // Set between start() and stop(); what the hooks report to
+    static HeapProfiler* active_;
+
+    using Roots = std::vector<std::pair<std::string, const Runtime::Value*>>;
+
+    explicit HeapProfiler(std::string path);
+    ~HeapProfiler();
+
+    HeapProfiler(const HeapProfiler&) = delete;
+    HeapProfiler& operator=(const HeapProfiler&) = delete;
+
+    void start();
+    void stop();
+
+    void setLine(int line) { line_ = line; }
+
+    void allocated(Category category, const void* object, size_t bytes);
+    void freed(const void* object); // Objects made before start() are not known and ignored
+    void allocatedUpFront(Category category, size_t bytes);
+
+    bool snapshotRequested() const { return snapshotRequested_ != 0; }
+    std::string takeSnapshotPath(); // Clears the request; <path>.1, <path>.2, ...
+
+    // Per-category totals, then the lines that allocated the most
+    void printReport(std::ostream& out) const;
+
+    // The same numbers as JSON, with a snapshot of what the roots reach at exit
+    void writeReport(std::ostream& out, const Roots& roots) const;
+
+    static void writeSnapshot(std::ostream& out, const Roots& roots);
+
+private:
+    struct Totals {
+        uint64_t allocations_;
+        uint64_t bytes_;
+        uint64_t live_;
+        uint64_t peak_;
+    };
+
+    struct Allocation {
+        Category category_;
+        int line_;
+        size_t bytes_;
+    };
+
+    std::string path_;
+    int line_;
+    Totals categories_[static_cast<size_t>(Category::COUNT)];
+    std::unordered_map<int, Totals> lines_;
+    std::unordered_map<const void*, Allocation> live_;
+    uint64_t liveBytes_;
+    uint64_t peakBytes_;
+    size_t snapshots_;
+    volatile std::sig_atomic_t snapshotRequested_;
+    struct sigaction previous_;
+    bool running_;
+
+    static void handle(int signal);
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// Int arithmetic that wraps around on overflow, as the JIT's machine code and the C backend's
+// unsigned casts do. Signed overflow is undefined in C++, so the interpreters go through uint64_t.
+namespace Runtime {
+
+inline int64_t wrappingAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+inline int64_t wrappingSubtract(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+inline int64_t wrappingMultiply(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+inline int64_t wrappingNegate(int64_t a) {
+    return static_cast<int64_t>(0 - static_cast<uint64_t>(a));
+}
+
+} // namespace Runtime
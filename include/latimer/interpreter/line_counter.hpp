@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+
+// Per-line execution counts for the AstInterpreter (`--line-counts`). Every statement bumps the
+// counter of its line_ as it starts, in a dense array indexed by the line itself and sized up front
+// from the statements of the program, so the hook is one increment and never a lookup or a bounds
+// check. A line counts as executable when a statement of the program as run starts on it, so code
+// the optimizer removed does not show up, as with gcov on an optimized build.
+class LineCounter {
+public:
+    explicit LineCounter(std::vector<AstStatPtr>& statements);
+
+    // Indexed by line; what the interpreter increments
+    uint64_t* counts() { return counts_.data(); }
+
+    // The hottest lines with their source text, then how many executable lines ran at all
+    void printReport(std::ostream& out, const std::string& source) const;
+
+    // An lcov tracefile for `path`, with a DA record per executable line
+    void writeLcov(std::ostream& out, const std::string& path) const;
+
+private:
+    std::vector<uint64_t> counts_;
+    std::vector<bool> executable_;
+};
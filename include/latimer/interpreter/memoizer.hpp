@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/interpreter/value.hpp>
+
+// Result caches for the AstInterpreter's pure functions (`--memoize`). Every closure of a function
+// the PurityAnalyzer found pure gets its own Table, since closures of one declaration can capture
+// different values, while hits and misses add up in one Entry per declaration. Only calls whose
+// arguments are all null, bool, int, double, char or string are looked up, and only such results
+// are stored. A full table is flushed rather than grown past TABLE_CAPACITY.
+class Memoizer {
+public:
+    static constexpr size_t TABLE_CAPACITY = 1 << 16;
+
+    struct Entry {
+        const AstStatFuncDecl* decl_;
+        size_t tables_;
+        size_t hits_;
+        size_t misses_;
+        size_t flushes_;
+    };
+
+    struct Table {
+        Entry* entry_;
+        std::unordered_map<std::string, Runtime::Value> results_; // By encoded arguments
+    };
+
+    // nullptr unless the function is pure
+    std::unique_ptr<Table> tableFor(const AstStatFuncDecl* decl);
+
+    // Writes the arguments' tags and contents to key; false when one of them can't be a key
+    static bool encode(Runtime::Arguments arguments, std::string& key);
+
+    bool lookup(Table& table, const std::string& key, Runtime::Value& result);
+    void store(Table& table, std::string key, const Runtime::Value& result);
+
+    // Entries whose functions were called, in declaration order
+    std::vector<const Entry*> entries() const;
+
+private:
+    std::unordered_map<const AstStatFuncDecl*, Entry> entries_;
+};
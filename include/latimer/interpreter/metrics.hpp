@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Runtime counters for --metrics, kept by the AstInterpreter and the frame arena. They are only
+// compiled in with LATIMER_METRICS defined (cmake -DLATIMER_METRICS=ON): otherwise METRIC_COUNT
+// and METRIC_NODE expand to nothing, and ordinary builds don't so much as touch a counter.
+#ifdef LATIMER_METRICS
+#define METRIC_COUNT(counter) (Metrics::counters_.counter++)
+#define METRIC_ADD(counter, amount) (Metrics::counters_.counter += (amount))
+#define METRIC_NODE(kind) (Metrics::counters_.nodes_[static_cast<size_t>(Metrics::Node::kind)]++)
+#else
+#define METRIC_COUNT(counter) ((void)0)
+#define METRIC_ADD(counter, amount) ((void)0)
+#define METRIC_NODE(kind) ((void)0)
+#endif
+
+class Metrics {
+public:
+#ifdef LATIMER_METRICS
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    // One per AstInterpreter visit
+    enum class Node {
+        GROUP_EXPR,
+        UNARY_EXPR,
+        BINARY_EXPR,
+        TYPED_UNARY_EXPR,
+        TYPED_BINARY_EXPR,
+        TERNARY_EXPR,
+        LITERAL_NULL_EXPR,
+        LITERAL_BOOL_EXPR,
+        LITERAL_INT_EXPR,
+        LITERAL_DOUBLE_EXPR,
+        LITERAL_STRING_EXPR,
+        LITERAL_CHAR_EXPR,
+        VARIABLE_EXPR,
+        ASSIGNMENT_EXPR,
+        CALL_EXPR,
+        VAR_DECL_STAT,
+        EXPRESSION_STAT,
+        IF_ELSE_STAT,
+        WHILE_STAT,
+        FOR_STAT,
+        BREAK_STAT,
+        CONTINUE_STAT,
+        BLOCK_STAT,
+        FUNC_DECL_STAT,
+        RETURN_STAT,
+        COUNT,
+    };
+
+    struct Counters {
+        uint64_t nodes_[static_cast<size_t>(Node::COUNT)];
+        uint64_t userCalls_; // Tail calls included, memoized hits not
+        uint64_t tailCalls_;
+        uint64_t nativeCalls_;
+        uint64_t memoHits_;
+        uint64_t framesPushed_;
+        uint64_t localLookups_;
+        uint64_t globalLookups_;
+        uint64_t captureLookups_;
+        uint64_t stringConcats_;
+        uint64_t stringConcatBytes_;
+        uint64_t breaks_; // break/continue/return unwind as Completions rather than exceptions
+        uint64_t continues_;
+        uint64_t returns_;
+        uint64_t runtimeErrors_;
+    };
+
+    static Counters counters_;
+
+    static void writeJson(std::ostream& out);
+};
@@ -2,19 +2,36 @@
 
 #include <chrono>
 #include <memory>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <latimer/interpreter/value.hpp>
 #include <latimer/utils/error_handler.hpp>
 #include <latimer/utils/macros.hpp>
 
-class NativePrint : public Runtime::Callable {
+// Natives never touch the engine that calls them, so both the AstInterpreter and the VM can use them.
+class NativeFunction : public Runtime::Callable {
+public:
+    virtual Runtime::Value invoke(int line, Runtime::Arguments arguments) = 0;
+
+    Runtime::Value call(int line, UNUSED AstInterpreter& interpreter, Runtime::Arguments arguments) override {
+        return invoke(line, arguments);
+    }
+
+    bool isNative() const override {
+        return true;
+    }
+};
+
+class NativePrint : public NativeFunction {
 public:
     size_t arity() const override {
         return 255;
     }
 
-    Runtime::Value call(UNUSED int line, UNUSED AstInterpreter& interpreter, const std::vector<Runtime::Value>& arguments) override {
+    Runtime::Value invoke(UNUSED int line, Runtime::Arguments arguments) override {
         for (size_t i = 0; i < arguments.size(); ++i) {
             std::cout << Runtime::toString(arguments[i]);
             if (i != arguments.size() - 1)
@@ -30,13 +47,13 @@ public:
     }
 };
 
-class NativeClock : public Runtime::Callable {
+class NativeClock : public NativeFunction {
 public:
     size_t arity() const override {
         return 0;
     }
 
-    Runtime::Value call(UNUSED int line, UNUSED AstInterpreter& interpreter, UNUSED const std::vector<Runtime::Value>& arguments) override {
+    Runtime::Value invoke(UNUSED int line, UNUSED Runtime::Arguments arguments) override {
         using namespace std::chrono;
         auto now = system_clock::now();
         auto ms = duration_cast<milliseconds>(now.time_since_epoch()).count();
@@ -49,21 +66,21 @@ public:
     }
 };
 
-class NativeSleep : public Runtime::Callable {
+class NativeSleep : public NativeFunction {
 public:
     size_t arity() const override {
         return 1;
     }
 
-    Runtime::Value call(int line, UNUSED AstInterpreter& interpreter, const std::vector<Runtime::Value>& arguments) override {
+    Runtime::Value invoke(int line, Runtime::Arguments arguments) override {
         using namespace std::chrono;
 
         const Runtime::Value& durationVal = arguments.at(0);
-        if (!std::holds_alternative<double>(durationVal)) {
+        if (!durationVal.is<double>()) {
             throw RuntimeError(line, "sleep() expects a double (number of seconds).");
         }
 
-        double seconds = std::get<double>(durationVal);
+        double seconds = durationVal.as<double>();
         if (seconds < 0.0) {
             throw RuntimeError(line, "sleep() duration must be non-negative.");
         }
@@ -80,3 +97,12 @@ public:
         return "<native fn sleep>";
     }
 };
+
+// Every native, in the order the engines bind them as globals
+inline std::vector<std::pair<std::string, Runtime::Value>> nativeFunctions() {
+    return {
+        {"print", Runtime::Value(new NativePrint())},
+        {"clock", Runtime::Value(new NativeClock())},
+        {"sleep", Runtime::Value(new NativeSleep())},
+    };
+}
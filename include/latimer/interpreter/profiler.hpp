@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/interpreter/value.hpp>
+
+// Call-tree profiler for the AstInterpreter (`--profile`). Every call of a user function or a native
+// enters a node under the caller's, keyed by the callee, and adds its wall time on the way out; a
+// tail call leaves its caller's node before entering its own, like the frame it replaces. Exclusive
+// time is a node's time minus its children's. Per-function totals count a recursive function's
+// inclusive time once, at its outermost call on each path.
+class Profiler {
+public:
+    Profiler();
+
+    void nameNative(const Runtime::Callable* native, std::string name);
+
+    void start();
+    void stop();
+
+    void enter(const AstStatFuncDecl* function);
+    void enter(const Runtime::Callable* native);
+    void exit();
+
+    // Per-function totals, most exclusive time first
+    void printTable(std::ostream& out) const;
+
+    // One `script;caller;callee microseconds` line per call path, the format flamegraph.pl and
+    // speedscope read
+    void writeCollapsed(std::ostream& out) const;
+
+    // Leaves a node when destroyed, so runtime errors unwinding through calls keep the tree intact
+    class Scope {
+    public:
+        template <typename Callee>
+        Scope(Profiler* profiler, const Callee* callee)
+            : profiler_(profiler) {
+            if (profiler_ != nullptr) profiler_->enter(callee);
+        }
+
+        ~Scope() {
+            if (profiler_ != nullptr) profiler_->exit();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Profiler* profiler_;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Node {
+        const AstStatFuncDecl* function_; // nullptr for natives and the script
+        const Runtime::Callable* native_;
+        size_t parent_;
+        std::vector<std::pair<const void*, size_t>> children_; // Callee -> node
+        uint64_t calls_;
+        Clock::duration inclusive_;
+        Clock::duration childTime_;
+    };
+
+    std::vector<Node> nodes_; // nodes_[0] is the script
+    std::vector<std::pair<size_t, Clock::time_point>> stack_; // Entered nodes and when
+    std::unordered_map<const Runtime::Callable*, std::string> natives_;
+
+    void enterNode(const void* key, const AstStatFuncDecl* function, const Runtime::Callable* native);
+    std::string label(const Node& node) const;
+    void writePath(std::ostream& out, size_t node) const;
+};
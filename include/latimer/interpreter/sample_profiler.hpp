@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <ostream>
+
+#include <latimer/ast/ast.hpp>
+
+// Statistical profiler for the AstInterpreter (`--sample-profile=hz`). The interpreter keeps a
+// shadow stack of the user functions it is running and the line of the statement it is on, and a
+// SIGPROF handler driven by a timer_create timer copies both into a preallocated buffer. Nothing is
+// timed on the interpreter's side, so a call costs a push and a pop instead of two clock reads.
+// Samples are taken in wall time: a `sleep` shows up, charged like every native to the line that
+// called it.
+class SampleProfiler {
+public:
+    static constexpr size_t MAX_DEPTH = 1024; // Deeper frames are kept count of but not sampled
+    static constexpr size_t BUFFER_WORDS = 1 << 22; // Samples that don't fit are dropped
+
+    explicit SampleProfiler(unsigned hz);
+    ~SampleProfiler();
+
+    SampleProfiler(const SampleProfiler&) = delete;
+    SampleProfiler& operator=(const SampleProfiler&) = delete;
+
+    // Only one profiler can sample at a time, as there is one SIGPROF handler
+    void start();
+    void stop();
+
+    void setLine(int line) { line_ = line; }
+
+    void enter(const AstStatFuncDecl* function) {
+        if (static_cast<size_t>(depth_) < MAX_DEPTH)
+            frames_[depth_] = {function, line_};
+        // The frame must be in place before the handler can see it
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        depth_ = depth_ + 1;
+    }
+
+    void exit() {
+        depth_ = depth_ - 1;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        if (static_cast<size_t>(depth_) < MAX_DEPTH)
+            line_ = frames_[depth_].callerLine_;
+    }
+
+    // Per-function self and total samples, then the lines with the most samples
+    void printReport(std::ostream& out) const;
+
+    // One `<script>;caller:line;callee:line samples` line per sampled stack
+    void writeCollapsed(std::ostream& out) const;
+
+    class Scope {
+    public:
+        Scope(SampleProfiler* profiler, const AstStatFuncDecl* function)
+            : profiler_(profiler) {
+            if (profiler_ != nullptr) profiler_->enter(function);
+        }
+
+        ~Scope() {
+            if (profiler_ != nullptr) profiler_->exit();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SampleProfiler* profiler_;
+    };
+
+private:
+    struct Frame {
+        const AstStatFuncDecl* function_;
+        int callerLine_; // Restored when the frame is left, as the caller's statement goes on
+    };
+
+    unsigned hz_;
+    Frame frames_[MAX_DEPTH];
+    volatile std::sig_atomic_t depth_;
+    volatile std::sig_atomic_t line_;
+
+    // Each sample is its line, its number of frames, then the frames' functions from the outermost
+    std::unique_ptr<uintptr_t[]> buffer_;
+    volatile size_t used_;
+    volatile size_t samples_;
+    volatile size_t dropped_;
+
+    struct sigaction previous_;
+    timer_t timer_;
+    bool running_;
+
+    static SampleProfiler* active_;
+    static void handle(int signal);
+    void record();
+
+    template <typename Visit>
+    void forEachSample(Visit visit) const;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/interpreter/value.hpp>
+
+// The tag the operands of a typed expression carry. The Checker lets null through as any type, so
+// both the AstInterpreter and the IrInterpreter still test it once and run anything else through
+// the generic operator, which gives the same result or error as without the lowering.
+namespace Runtime {
+
+inline Value::Type operandType(AstExprTypedUnary::Kind kind) {
+    switch (kind) {
+        case AstExprTypedUnary::INT_NEGATE:
+        case AstExprTypedUnary::INT_BIT_NOT: return Value::Type::INT;
+        case AstExprTypedUnary::DOUBLE_NEGATE: return Value::Type::DOUBLE;
+        case AstExprTypedUnary::BOOL_NOT: return Value::Type::BOOL;
+    }
+    return Value::Type::NIL;
+}
+
+inline Value::Type operandType(AstExprTypedBinary::Kind kind) {
+    if (kind <= AstExprTypedBinary::INT_NOT_EQUAL) return Value::Type::INT;
+    if (kind <= AstExprTypedBinary::DOUBLE_NOT_EQUAL) return Value::Type::DOUBLE;
+    if (kind <= AstExprTypedBinary::CHAR_NOT_EQUAL) return Value::Type::CHAR;
+    if (kind <= AstExprTypedBinary::BOOL_NOT_EQUAL) return Value::Type::BOOL;
+    return Value::Type::STRING;
+}
+
+} // namespace Runtime
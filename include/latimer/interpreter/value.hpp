@@ -1,45 +1,237 @@
 #pragma once
 
+#include <cstdint>
 #include <variant>
 #include <string>
 #include <memory>
-#include <regex>
+#include <type_traits>
+#include <vector>
 #include <sstream>
+#include <stdexcept>
 #include <iomanip>
 
 class AstInterpreter;
 
 namespace Runtime {
 
+class Value;
 class Callable;
+class CollectedCallable;
 
-// Represents all possible runtime values in Latimer
-using Value = std::variant<std::monostate, bool, int64_t, double, std::string, char, std::shared_ptr<Callable>>;
+// Base of everything a Value can point to. Values own their object through a plain (non-atomic)
+// reference count, the interpreter being single-threaded.
+class Object {
+public:
+    virtual ~Object() = default;
+
+private:
+    friend class Value;
+    friend class Collector; // Reads the counts to tell cycles apart from live references
+    uint32_t refCount_ = 0;
+};
+
+class String : public Object {
+public:
+    std::string value_;
+
+    // Out of line, in value.cpp, so that they can report to the HeapProfiler without every user of
+    // Value depending on it
+    explicit String(std::string value);
+    ~String() override;
+};
 
-class Callable {
+// Represents all possible runtime values in Latimer in 16 bytes: a tag and either an immediate
+// (bool, int, double, char) or a pointer to a reference-counted Object (string, callable).
+// is<T>() / as<T>() mirror std::holds_alternative<T> / std::get<T> for the types the old
+// std::variant held, with as<Callable>() returning a raw pointer.
+class Value {
 public:
-    virtual ~Callable() = default;
+    enum class Type : uint8_t {
+        NIL,
+        BOOL,
+        INT,
+        DOUBLE,
+        CHAR,
+        STRING,
+        CALLABLE,
+    };
+
+    Value()
+        : type_(Type::NIL)
+        , as_() {}
+    Value(std::monostate)
+        : Value() {}
+    Value(bool value)
+        : type_(Type::BOOL) { as_.bool_ = value; }
+    Value(int64_t value)
+        : type_(Type::INT) { as_.int_ = value; }
+    Value(double value)
+        : type_(Type::DOUBLE) { as_.double_ = value; }
+    Value(char value)
+        : type_(Type::CHAR) { as_.char_ = value; }
+    Value(std::string value)
+        : type_(Type::STRING) { as_.object_ = retain(new String(std::move(value))); }
+    Value(const char* value)
+        : Value(std::string(value)) {}
+    Value(Callable* value);
+
+    Value(const Value& other)
+        : type_(other.type_)
+        , as_(other.as_) {
+        if (isObject()) retain(as_.object_);
+    }
+
+    Value(Value&& other) noexcept
+        : type_(other.type_)
+        , as_(other.as_) {
+        other.type_ = Type::NIL;
+    }
+
+    Value& operator=(const Value& other) {
+        // Read other before releasing, since other may live inside the object this Value drops
+        Type type = other.type_;
+        Payload as = other.as_;
+        if (type >= Type::STRING) retain(as.object_);
+
+        release();
+        type_ = type;
+        as_ = as;
+        return *this;
+    }
+
+    Value& operator=(Value&& other) noexcept {
+        Type type = other.type_;
+        Payload as = other.as_;
+        other.type_ = Type::NIL;
+
+        release();
+        type_ = type;
+        as_ = as;
+        return *this;
+    }
+
+    ~Value() {
+        release();
+    }
+
+    Type type() const {
+        return type_;
+    }
+
+    template <typename T>
+    bool is() const {
+        if constexpr (std::is_same_v<T, std::monostate>) return type_ == Type::NIL;
+        else if constexpr (std::is_same_v<T, bool>) return type_ == Type::BOOL;
+        else if constexpr (std::is_same_v<T, int64_t>) return type_ == Type::INT;
+        else if constexpr (std::is_same_v<T, double>) return type_ == Type::DOUBLE;
+        else if constexpr (std::is_same_v<T, char>) return type_ == Type::CHAR;
+        else if constexpr (std::is_same_v<T, std::string>) return type_ == Type::STRING;
+        else if constexpr (std::is_same_v<T, Callable>) return type_ == Type::CALLABLE;
+        else static_assert(!std::is_same_v<T, T>, "Not a runtime value type.");
+    }
+
+    // Unchecked, like dereferencing std::get_if: callers test is<T>() first
+    template <typename T>
+    decltype(auto) as() const {
+        if constexpr (std::is_same_v<T, std::monostate>) return std::monostate();
+        else if constexpr (std::is_same_v<T, bool>) return as_.bool_;
+        else if constexpr (std::is_same_v<T, int64_t>) return as_.int_;
+        else if constexpr (std::is_same_v<T, double>) return as_.double_;
+        else if constexpr (std::is_same_v<T, char>) return as_.char_;
+        else if constexpr (std::is_same_v<T, std::string>) return (static_cast<const String*>(as_.object_)->value_);
+        else if constexpr (std::is_same_v<T, Callable>) return asCallable();
+        else static_assert(!std::is_same_v<T, T>, "Not a runtime value type.");
+    }
 
+private:
+    union Payload {
+        bool bool_;
+        int64_t int_;
+        double double_;
+        char char_;
+        Object* object_;
+    };
+
+    Type type_;
+    Payload as_;
+
+    bool isObject() const {
+        return type_ >= Type::STRING;
+    }
+
+    Callable* asCallable() const;
+
+    static Object* retain(Object* object) {
+        object->refCount_++;
+        return object;
+    }
+
+    void release() {
+        if (isObject() && --as_.object_->refCount_ == 0)
+            delete as_.object_;
+    }
+};
+
+static_assert(sizeof(Value) == 16, "Runtime::Value should stay a 16-byte tagged value.");
+
+// Read-only view of a call's arguments, which stay on the caller's value stack. Only valid until
+// the callee runs more Latimer code, so callees copy out what they keep.
+class Arguments {
+public:
+    Arguments(const Value* data, size_t size)
+        : data_(data)
+        , size_(size) {}
+
+    size_t size() const { return size_; }
+    const Value& operator[](size_t i) const { return data_[i]; }
+    const Value* begin() const { return data_; }
+    const Value* end() const { return data_ + size_; }
+
+    const Value& at(size_t i) const {
+        if (i >= size_) throw std::out_of_range("Runtime::Arguments::at");
+        return data_[i];
+    }
+
+private:
+    const Value* data_;
+    size_t size_;
+};
+
+class Callable : public Object {
+public:
     virtual size_t arity() const = 0;
-    virtual Runtime::Value call(int line, AstInterpreter& interpreter, const std::vector<Runtime::Value>& arguments) = 0;
+    virtual Runtime::Value call(int line, AstInterpreter& interpreter, Runtime::Arguments arguments) = 0;
     virtual std::string toString() const { return "<native fn>"; }
-};    
-
-inline std::string toString(Runtime::Value value) {
-    if (std::holds_alternative<std::monostate>(value)) return "null";
-    if (std::holds_alternative<bool>(value)) return std::get<bool>(value) ? "true" : "false";
-    if (std::holds_alternative<int64_t>(value)) return std::to_string(std::get<int64_t>(value));
-    if (std::holds_alternative<double>(value)) {
-        std::ostringstream ss;
-        ss << std::fixed << std::setprecision(6) << std::get<double>(value);
-        std::string str = ss.str();
-        str.erase(str.find_last_not_of('0') + 1);
-        if (str.back() == '.') str += '0';
-        return str;
-    }
-    if (std::holds_alternative<std::string>(value)) return std::get<std::string>(value);
-    if (std::holds_alternative<char>(value)) return std::string(1, std::get<char>(value));
-    if (std::holds_alternative<std::shared_ptr<Callable>>(value)) return "<function>";
+    virtual bool isNative() const { return false; }
+    virtual CollectedCallable* asCollected() { return nullptr; } // Closures the Collector tracks
+};
+
+inline Value::Value(Callable* value)
+    : type_(Type::CALLABLE) {
+    as_.object_ = retain(value);
+}
+
+inline Callable* Value::asCallable() const {
+    return static_cast<Callable*>(as_.object_);
+}
+
+inline std::string toString(const Runtime::Value& value) {
+    switch (value.type()) {
+        case Value::Type::NIL: return "null";
+        case Value::Type::BOOL: return value.as<bool>() ? "true" : "false";
+        case Value::Type::INT: return std::to_string(value.as<int64_t>());
+        case Value::Type::DOUBLE: {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(6) << value.as<double>();
+            std::string str = ss.str();
+            str.erase(str.find_last_not_of('0') + 1);
+            if (str.back() == '.') str += '0';
+            return str;
+        }
+        case Value::Type::STRING: return value.as<std::string>();
+        case Value::Type::CHAR: return std::string(1, value.as<char>());
+        case Value::Type::CALLABLE: return "<function>";
+    }
     return "<unknown>";
 }
 
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include <latimer/ir/ir.hpp>
+
+// Dominator tree of a function's reachable blocks, computed with the iterative algorithm of
+// Cooper, Harvey and Kennedy ("A Simple, Fast Dominance Algorithm").
+class DominatorTree {
+public:
+    explicit DominatorTree(const Ir::Function& function);
+
+    bool reachable(Ir::BlockId block) const;
+    const std::vector<Ir::BlockId>& reversePostorder() const { return order_; }
+    const std::vector<Ir::BlockId>& children(Ir::BlockId block) const { return children_[block]; }
+
+private:
+    static constexpr Ir::BlockId NONE = static_cast<Ir::BlockId>(-1);
+
+    std::vector<Ir::BlockId> order_;
+    std::vector<size_t> position_; // Index in order_
+    std::vector<Ir::BlockId> idom_;
+    std::vector<std::vector<Ir::BlockId>> children_;
+
+    Ir::BlockId intersect(Ir::BlockId a, Ir::BlockId b) const;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <latimer/interpreter/value.hpp>
+#include <latimer/lexical_analysis/token.hpp>
+
+// A typed SSA control flow graph, lowered from the checked AST by the IrBuilder, optimized by the
+// IrPassManager and run by the IrInterpreter (`--ir`, `--dump-ir`).
+//
+// Every instruction defines one value, named by its index in Function::values_. Blocks list their
+// instructions in order: phis first, a terminator last. A phi's operands line up with its block's
+// predecessors_. Passes never erase instructions or blocks, they mark them dead_, so ids stay
+// valid for the whole pipeline.
+namespace Ir {
+
+using ValueId = uint32_t;
+using BlockId = uint32_t;
+
+enum class Type : uint8_t {
+    VOID,
+    NIL,
+    BOOL,
+    INT,
+    DOUBLE,
+    CHAR,
+    STRING,
+    FUNCTION,
+};
+
+enum class Op : uint8_t {
+    CONSTANT,       // constant_
+    PARAMETER,      // index_: which argument
+    PHI,
+    COPY,
+    UNARY,          // index_: AstExprTypedUnary::Kind, operands of its type or null
+    BINARY,         // index_: AstExprTypedBinary::Kind
+    GENERIC_UNARY,  // Operand types tested at runtime, like the AstInterpreter's visitUnaryExpr
+    GENERIC_BINARY,
+    NATIVE,         // constant_: the native callable, text_: its name
+    SELF,           // The closure slot after the captures: the running function unless it reassigned its name
+    LOAD_CAPTURE,   // index_: capture slot
+    STORE_CAPTURE,  // index_: capture slot, operands_[0]: the value
+    CLOSURE,        // index_: function, operands_: the captured values
+    CALL,           // operands_[0]: callee, then the arguments
+    UNDEFINED,      // Fails on a name the interpreter cannot find: read, or assign operands_[0]
+
+    // Terminators
+    JUMP,           // targets_[0]
+    BRANCH,         // operands_[0] ? targets_[0] : targets_[1], text_: error if not a bool
+    RETURN,         // operands_[0] if any, null otherwise
+    TAIL_CALL,      // Like CALL, then returns its result without growing the stack
+};
+
+struct Instruction {
+    Op op_;
+    Type type_;
+    int line_;
+    BlockId block_;
+    bool dead_;
+    std::vector<ValueId> operands_;
+    std::vector<BlockId> targets_;
+    Runtime::Value constant_;
+    int index_;
+    TokenType token_; // The source operator of UNARY/BINARY and the generic ones
+    std::string text_; // Operator lexeme, variable name or error message
+
+    bool isTerminator() const;
+    bool isPure() const; // Can be removed when unused: no effect and cannot fail
+};
+
+struct Block {
+    std::vector<ValueId> instructions_;
+    std::vector<BlockId> predecessors_;
+    bool dead_;
+};
+
+struct Function {
+    std::string name_;
+    int line_;
+    std::vector<std::string> params_;
+    std::vector<std::string> captures_;
+    std::vector<Instruction> values_;
+    std::vector<Block> blocks_; // blocks_[0] is the entry
+
+    const Instruction& terminator(BlockId block) const;
+    Instruction& terminator(BlockId block);
+    std::vector<BlockId> successors(BlockId block) const;
+
+    // Drops one edge from pred into block, along with the phi operands for it
+    void removePredecessor(BlockId block, BlockId pred);
+    void replaceAllUses(ValueId from, ValueId to);
+    void kill(ValueId value);
+};
+
+struct Module {
+    std::vector<Function> functions_; // functions_[0] is the script itself
+};
+
+const char* typeName(Type type);
+
+} // namespace Ir
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/ir/ir.hpp>
+#include <latimer/optimizer/scope_tracker.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+// Lowers a checked (and usually type specialized) AST into the SSA IR, one Ir::Function per
+// function declaration plus one for the script.
+//
+// SSA form is built on the fly (Braun et al., "Simple and Efficient Construction of Static Single
+// Assignment Form"): every local is tracked per block, reads walk up the predecessors, and a block
+// whose predecessors are not all known yet (a loop header, a loop exit) gets placeholder phis that
+// are completed when the block is sealed. Names are scoped with a ScopeTracker, like the other
+// passes: locals become SSA values, captures live in the closure (LOAD/STORE_CAPTURE), and a name
+// the interpreter would fail to find lowers to UNDEFINED, which fails the same way at runtime.
+class IrBuilder : public AstVisitor {
+public:
+    explicit IrBuilder(Utils::ErrorHandler& errorHandler);
+
+    Ir::Module build(std::vector<AstStatPtr>& statements);
+
+private:
+    enum class Storage {
+        LOCAL,
+        CAPTURE,
+        SELF,
+    };
+
+    struct Binding {
+        Storage storage_;
+        int index_; // Capture slot
+        Ir::Type type_;
+    };
+
+    struct Loop {
+        Ir::BlockId continue_;
+        Ir::BlockId break_;
+    };
+
+    struct FunctionState {
+        size_t index_; // In module_.functions_, which grows while nested functions are lowered
+        Ir::BlockId block_; // Where instructions go
+        std::vector<std::unordered_map<const void*, Ir::ValueId>> definitions_; // Per block, each local's current value
+        std::vector<bool> sealed_;
+        std::vector<std::vector<std::pair<const void*, Ir::ValueId>>> incompletePhis_;
+        std::vector<Loop> loops_;
+    };
+
+    Utils::ErrorHandler& errorHandler_;
+    Ir::Module module_;
+    FunctionState* current_;
+    ScopeTracker scopes_;
+    std::unordered_map<const void*, Binding> bindings_;
+    std::unordered_map<std::string, Runtime::Value> natives_;
+    Ir::ValueId result_; // Value of the last lowered expression
+    Ir::Type type_; // Last converted AstType
+
+    Ir::Function& function();
+    Ir::ValueId lower(AstExpr& expr);
+    void lower(AstStat& stat);
+    Ir::Type convertType(AstType& type);
+    static Ir::Type irType(const TypePtr& type);
+
+    Ir::BlockId newBlock(bool sealed);
+    void sealBlock(Ir::BlockId block);
+    bool terminated() const;
+    void startUnreachable(); // After a jump, so dead statements still have somewhere to go
+
+    Ir::ValueId emit(Ir::Op op, Ir::Type type, int line, std::vector<Ir::ValueId> operands = {});
+    Ir::ValueId constant(const Runtime::Value& value, Ir::Type type, int line);
+    void jump(Ir::BlockId target, int line);
+    void branch(Ir::ValueId condition, Ir::BlockId then, Ir::BlockId otherwise, int line, const char* errorMsg);
+
+    void declare(const std::string& name, const void* key, Binding binding);
+    void writeVariable(const void* key, Ir::BlockId block, Ir::ValueId value);
+    Ir::ValueId readVariable(const void* key, Ir::BlockId block);
+    Ir::ValueId readVariableRecursive(const void* key, Ir::BlockId block);
+    Ir::ValueId newPhi(Ir::BlockId block, Ir::Type type, int line);
+    void addPhiOperands(const void* key, Ir::ValueId phi);
+    Ir::ValueId readName(const Token& name, Ir::Type type);
+
+    void visitPrimitiveType(AstTypePrimitive& type) override;
+    void visitFunctionType(AstTypeFunction& type) override;
+
+    void visitGroupExpr(AstExprGroup& expr) override;
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTypedUnaryExpr(AstExprTypedUnary& expr) override;
+    void visitTypedBinaryExpr(AstExprTypedBinary& expr) override;
+    void visitTernaryExpr(AstExprTernary& expr) override;
+    void visitLiteralNullExpr(AstExprLiteralNull& expr) override;
+    void visitLiteralBoolExpr(AstExprLiteralBool& expr) override;
+    void visitLiteralIntExpr(AstExprLiteralInt& expr) override;
+    void visitLiteralDoubleExpr(AstExprLiteralDouble& expr) override;
+    void visitLiteralStringExpr(AstExprLiteralString& expr) override;
+    void visitLiteralCharExpr(AstExprLiteralChar& expr) override;
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitHoistedExpr(AstExprHoisted& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitExpressionStat(AstStatExpression& stat) override;
+    void visitIfElseStat(AstStatIfElse& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitBreakStat(AstStatBreak& stat) override;
+    void visitContinueStat(AstStatContinue& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+    void visitReturnStat(AstStatReturn& stat) override;
+};
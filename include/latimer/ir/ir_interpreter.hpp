@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <latimer/interpreter/collector.hpp>
+#include <latimer/interpreter/value.hpp>
+#include <latimer/ir/ir.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+// A lowered function together with the values copied out of its capture list, then itself: the
+// same closure layout as the AstInterpreter's
+class IrClosure : public Runtime::CollectedCallable {
+public:
+    const Ir::Function* function_;
+    std::vector<Runtime::Value> captures_;
+
+    explicit IrClosure(Runtime::Collector& collector, const Ir::Function* function);
+
+    Runtime::Value* ownedValues(size_t& count) override;
+    size_t arity() const override;
+    Runtime::Value call(int line, AstInterpreter& interpreter, Runtime::Arguments arguments) override;
+    std::string toString() const override;
+};
+
+// Runs a module straight off its SSA form (`--ir`). Every frame gets one register per value of its
+// function, and phis are assigned on the edge into their block. Like the VM, calls push a frame
+// instead of recursing, and a tail call replaces the caller's.
+class IrInterpreter {
+public:
+    explicit IrInterpreter(Utils::ErrorHandler& errorHandler);
+
+    void interpret(const Ir::Module& module);
+
+    Runtime::Collector& collector();
+
+private:
+    struct Frame {
+        Runtime::Value closure_; // Keeps the function (and its module entry) alive while it runs
+        const Ir::Function* function_;
+        Ir::BlockId block_;
+        size_t pc_; // Next instruction in block_
+        size_t args_; // Index in registers_ of the first argument
+        size_t base_; // Index in registers_ of value 0
+        Ir::ValueId call_; // Register of the CALL waiting on the frame above
+    };
+
+    static constexpr size_t FRAMES_MAX = 1 << 16;
+
+    Runtime::Collector collector_; // First, so every closure is gone before it is
+    Utils::ErrorHandler& errorHandler_;
+    const Ir::Module* module_;
+    std::vector<Runtime::Value> registers_;
+    std::vector<Frame> frames_;
+    std::vector<Runtime::Value> arguments_; // Of the call being set up
+    std::vector<Runtime::Value> phis_; // Values of the phis being assigned on an edge
+
+    void run();
+    void enter(Frame& frame, Ir::BlockId target);
+    bool finish(Runtime::Value result); // Pops the running frame, true once the script's is gone
+    void pushFrame(Runtime::Value callee, int line);
+    Runtime::Callable* requireCallable(const Runtime::Value& callee, size_t argCount, int line);
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ostream>
+
+#include <latimer/ir/ir.hpp>
+
+// Prints a module for `--dump-ir`, skipping dead blocks and instructions:
+//
+//   function fib(n) [line 1]
+//   b0:
+//     %0: int = parameter 0 ; n
+//     %1: int = constant 2
+//     %2: bool = int_less %0, %1
+//     branch %2, b1, b2
+class IrPrinter {
+public:
+    void print(const Ir::Module& module, std::ostream& out) const;
+    void print(const Ir::Function& function, std::ostream& out) const;
+
+private:
+    void printInstruction(const Ir::Function& function, Ir::ValueId id, std::ostream& out) const;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <latimer/ir/ir.hpp>
+
+// One transformation over a function's IR. run() returns how many changes it made, which the
+// IrPassManager uses both to decide when the pipeline has converged and for `--dump-ir`.
+class IrPass {
+public:
+    virtual ~IrPass() = default;
+
+    virtual const char* name() const = 0;
+    virtual size_t run(Ir::Function& function) = 0;
+};
+
+// Runs its passes in order over every function of a module, and repeats the whole sequence until
+// a round changes nothing (one pass often exposes work for another: branch simplification merges
+// blocks that GVN can then share values across) or MAX_ROUNDS is reached.
+class IrPassManager {
+public:
+    static constexpr size_t MAX_ROUNDS = 8;
+
+    struct PassStats {
+        std::string name_;
+        size_t changes_;
+    };
+
+    // Copy propagation, GVN, DCE and branch simplification
+    static IrPassManager standardPipeline();
+
+    void add(std::unique_ptr<IrPass> pass);
+    void run(Ir::Module& module);
+
+    void printStats(std::ostream& out) const;
+
+private:
+    std::vector<std::unique_ptr<IrPass>> passes_;
+    std::vector<PassStats> stats_;
+    size_t rounds_ = 0;
+};
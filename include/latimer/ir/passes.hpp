@@ -0,0 +1,37 @@
+#pragma once
+
+#include <latimer/ir/pass_manager.hpp>
+
+// Replaces copies, and phis whose operands are all the same value (ignoring the phi itself),
+// with that value. The IrBuilder leaves such phis behind at loop headers for variables the loop
+// never assigns.
+class CopyPropagation : public IrPass {
+public:
+    const char* name() const override { return "copy-propagation"; }
+    size_t run(Ir::Function& function) override;
+};
+
+// Global value numbering over the dominator tree: a pure instruction that computes what an
+// instruction in a dominating block (or earlier in its own) already computed is replaced by it.
+// Operators over constants are folded on the way, with the ConstantFolder's rules.
+class GlobalValueNumbering : public IrPass {
+public:
+    const char* name() const override { return "gvn"; }
+    size_t run(Ir::Function& function) override;
+};
+
+// Removes pure instructions (see Instruction::isPure) whose value nothing live uses.
+class DeadCodeElimination : public IrPass {
+public:
+    const char* name() const override { return "dce"; }
+    size_t run(Ir::Function& function) override;
+};
+
+// Turns branches on a constant, or with both targets the same, into jumps, drops the blocks that
+// no longer have a path from the entry, merges a block into its only predecessor when that
+// predecessor only jumps to it, and skips over blocks that do nothing but jump.
+class BranchSimplification : public IrPass {
+public:
+    const char* name() const override { return "branch-simplification"; }
+    size_t run(Ir::Function& function) override;
+};
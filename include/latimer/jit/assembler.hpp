@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Emits the handful of x86-64 instructions the JitCompiler needs. Every value is 64 bits wide and
+// lives in rax (with rcx as the second operand) or in a frame slot addressed off rbp; doubles only
+// visit xmm0/xmm1 for the arithmetic itself. Jumps and calls go to labels, which finish() resolves.
+class Assembler {
+public:
+    enum Reg : uint8_t {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RSP = 4,
+        RBP = 5,
+        RDI = 7,
+    };
+
+    // Condition codes, as encoded in jcc/setcc
+    enum Condition : uint8_t {
+        ABOVE_EQUAL = 0x3,
+        EQUAL = 0x4,
+        NOT_EQUAL = 0x5,
+        ABOVE = 0x7,
+        PARITY = 0xA,
+        NO_PARITY = 0xB,
+        LESS = 0xC,
+        GREATER_EQUAL = 0xD,
+        LESS_EQUAL = 0xE,
+        GREATER = 0xF,
+    };
+
+    enum IntOp : uint8_t {
+        ADD = 0x01,
+        OR = 0x09,
+        AND = 0x21,
+        SUB = 0x29,
+        XOR = 0x31,
+        CMP = 0x39,
+    };
+
+    enum DoubleOp : uint8_t {
+        ADDSD = 0x58,
+        MULSD = 0x59,
+        SUBSD = 0x5C,
+        DIVSD = 0x5E,
+    };
+
+    using Label = size_t;
+
+    Label newLabel();
+    void bind(Label label);
+
+    // Resolves every jump and call, then hands back the machine code
+    const std::vector<uint8_t>& finish();
+
+    // push rbp; mov rbp, rsp; sub rsp, <frame size set later by setFrameSize>
+    void prologue();
+    void setFrameSize(int32_t bytes);
+    void epilogue(); // mov rsp, rbp; pop rbp; ret
+
+    void movImmediate(Reg dst, uint64_t value);
+    void mov(Reg dst, Reg src);
+    void load(Reg dst, Reg base, int32_t disp);
+    void store(Reg base, int32_t disp, Reg src);
+    void lea(Reg dst, Reg base, int32_t disp);
+
+    void intOp(IntOp op, Reg dst, Reg src);
+    void imul(Reg dst, Reg src);
+    void idivRcx(); // cqo; idiv rcx: rax = rax / rcx, rdx = rax % rcx
+    void shlCl(Reg dst);
+    void sarCl(Reg dst);
+    void neg(Reg dst);
+    void bitNot(Reg dst);
+    void xorImmediate8(Reg dst, int8_t value);
+    void test(Reg a, Reg b);
+    void flipSignBit(Reg dst); // btc dst, 63
+
+    void setcc(Condition condition, Reg dst); // dst's low byte only
+    void zeroExtendByte(Reg dst);             // movzx dst, dst's low byte
+    void andByte(Reg dst, Reg src);
+    void orByte(Reg dst, Reg src);
+
+    // The two operands are moved into xmm0/xmm1 from rax/rcx and the result back into rax
+    void doubleOp(DoubleOp op);
+    void ucomisd(bool swapped); // ucomisd xmm0, xmm1 (or xmm1, xmm0), from rax/rcx
+
+    void jmp(Label label);
+    void jcc(Condition condition, Label label);
+    void call(Label label);
+
+private:
+    struct Fixup {
+        size_t at_; // Offset of the rel32 to patch, which is relative to the end of the instruction
+        Label label_;
+    };
+
+    std::vector<uint8_t> code_;
+    std::vector<size_t> labels_; // Bound offset of each label, SIZE_MAX while unbound
+    std::vector<Fixup> fixups_;
+    size_t frameSizeAt_ = 0;
+
+    void byte(uint8_t value);
+    void int32(int32_t value);
+    void rex(); // REX.W
+    void modrmDisp32(Reg reg, Reg base, int32_t disp);
+    void modrmRegs(uint8_t reg, uint8_t rm);
+    void rel32(Label label);
+    void xmmFromGeneral(uint8_t xmm, Reg src);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/interpreter/value.hpp>
+
+// Second execution tier for the AstInterpreter (--jit). Every function declaration gets an Entry
+// counting its calls and the loop iterations run in its body; once the count reaches
+// HOT_THRESHOLD, the next call compiles the function with the JitCompiler into executable memory,
+// and calls whose arguments have the declared types run the machine code from then on. Functions
+// the JitCompiler rejects, and calls passing anything else (null, say), stay interpreted.
+class Jit {
+public:
+    static constexpr size_t HOT_THRESHOLD = 1000;
+
+    enum class State {
+        COUNTING,
+        COMPILED,
+        REJECTED,
+    };
+
+    struct Entry {
+        AstStatFuncDecl* decl_;
+        State state_;
+        size_t hotness_; // Calls plus loop iterations while counting
+        int64_t (*code_)(const int64_t* arguments);
+        size_t codeBytes_;
+        size_t nativeCalls_;
+        size_t fallbacks_; // Calls with arguments the code does not take
+        std::string reason_; // Why the JitCompiler rejected the function
+    };
+
+    Jit();
+    ~Jit();
+
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    Entry* entryFor(AstStatFuncDecl* decl);
+
+    // Runs the call natively if the function is (or just became) compiled and the arguments fit;
+    // false leaves the call to the interpreter
+    bool call(Entry& entry, Runtime::Arguments arguments, Runtime::Value& result);
+
+    // Entries that were compiled or rejected, in declaration order
+    std::vector<const Entry*> tiered() const;
+
+private:
+    struct Mapping {
+        void* address_;
+        size_t size_;
+    };
+
+    std::unordered_map<AstStatFuncDecl*, Entry> entries_;
+    std::vector<Mapping> mappings_;
+    std::vector<int64_t> arguments_; // Native code never re-enters the interpreter, so one buffer does
+
+    void compile(Entry& entry);
+};
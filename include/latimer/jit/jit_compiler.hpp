@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/jit/assembler.hpp>
+
+// Compiles one function to x86-64 machine code, for functions whose parameters, locals and return
+// value are all int, double or bool. The code follows the System V ABI and has the signature
+// `int64_t (const int64_t* arguments)`: arguments and the result are passed as raw 64-bit
+// patterns (doubles bit-cast, bools 0/1). Parameters and locals live in frame slots, and every
+// expression leaves its value in rax.
+//
+// The compiled code must behave exactly like the AstInterpreter running the same function on
+// arguments of the declared types, so anything with a runtime check or an effect is rejected:
+// generic (unspecialized) operators, strings, chars, null, captures, globals, natives and calls to
+// anything but the function itself. Integer division traps exactly like the interpreter's, and
+// `return f(...)` marked by the TailCallMarker jumps back to the top instead of calling. The body
+// must end in a `return` on every path, since falling off the end returns null.
+class JitCompiler : public AstVisitor {
+public:
+    // False, with the reason, when the function uses something the JIT does not compile
+    bool compile(AstStatFuncDecl& decl, std::vector<uint8_t>& code, std::string& reason);
+
+private:
+    // Thrown from anywhere in the walk to give up on the function
+    struct Unsupported {
+        std::string reason_;
+    };
+
+    Assembler as_;
+    AstStatFuncDecl* decl_;
+    std::vector<std::unordered_map<std::string, int>> scopes_; // Name -> frame slot
+    std::vector<Assembler::Label> loopExits_;
+    std::vector<int> temporaries_; // Slot holding a left operand, by nesting depth
+    int slots_;
+    int depth_;
+    Assembler::Label entry_;
+    Assembler::Label body_; // After the prologue, where tail calls jump
+    Assembler::Label return_;
+
+    static int32_t offset(int slot);
+    int newSlot();
+    int lookup(const Token& name) const;
+    void compileExpr(AstExpr& expr);
+    void compileStat(AstStat& stat);
+    void compileCall(AstExprCall& call, bool tail);
+    void requireValueType(const AstType* type, const std::string& what) const;
+
+    void visitPrimitiveType(AstTypePrimitive& type) override;
+    void visitFunctionType(AstTypeFunction& type) override;
+
+    void visitGroupExpr(AstExprGroup& expr) override;
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTypedUnaryExpr(AstExprTypedUnary& expr) override;
+    void visitTypedBinaryExpr(AstExprTypedBinary& expr) override;
+    void visitTernaryExpr(AstExprTernary& expr) override;
+    void visitLiteralNullExpr(AstExprLiteralNull& expr) override;
+    void visitLiteralBoolExpr(AstExprLiteralBool& expr) override;
+    void visitLiteralIntExpr(AstExprLiteralInt& expr) override;
+    void visitLiteralDoubleExpr(AstExprLiteralDouble& expr) override;
+    void visitLiteralStringExpr(AstExprLiteralString& expr) override;
+    void visitLiteralCharExpr(AstExprLiteralChar& expr) override;
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitHoistedExpr(AstExprHoisted& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitExpressionStat(AstStatExpression& stat) override;
+    void visitIfElseStat(AstStatIfElse& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBreakStat(AstStatBreak& stat) override;
+    void visitContinueStat(AstStatContinue& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+    void visitReturnStat(AstStatReturn& stat) override;
+};
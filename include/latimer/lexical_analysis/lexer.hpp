@@ -25,7 +25,7 @@ private:
     bool isAtEnd();
     char advance();
     void addToken(TokenType type);
-    void addToken(TokenType type, Runtime::Value literal);
+    void addToken(TokenType type, Literal literal);
     bool match(char expected);
     char peek();
     void character();
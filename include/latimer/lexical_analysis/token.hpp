@@ -1,10 +1,14 @@
 #pragma once
 
 #include <any>
+#include <cstdint>
 #include <string>
+#include <variant>
 
 #include <latimer/utils/macros.hpp>
-#include <latimer/interpreter/value.hpp> // TODO: Kind of weird that value.hpp refers to interpreter. it may be better to create two versions of Value (one for static time and the other for runtime) and in the parser, we could translate
+
+// Compile-time value of a literal token. The parser copies it into the AST, so it is kept separate from Runtime::Value
+using Literal = std::variant<std::monostate, bool, int64_t, double, std::string, char>;
 
 enum class TokenType : uint8_t {
     // Single-character tokens
@@ -81,10 +85,10 @@ enum class TokenType : uint8_t {
 struct Token {
     TokenType type_;
     std::string lexeme_;
-    Runtime::Value literal_;
+    Literal literal_;
     int line_;
 
-    Token(TokenType type, std::string lexeme, Runtime::Value literal, int line)
+    Token(TokenType type, std::string lexeme, Literal literal, int line)
         : type_(type)
         , lexeme_(lexeme)
         , literal_(literal)
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast_transformer.hpp>
+#include <latimer/interpreter/value.hpp>
+#include <latimer/optimizer/optimization_report.hpp>
+#include <latimer/optimizer/scope_tracker.hpp>
+
+// Folds unary, binary and ternary expressions over literals into a single literal, and replaces
+// reads of variables that are initialized with an int/double/bool/char literal and never assigned
+// with that literal. Runs after the Checker, whose types the new literals inherit.
+//
+// Folding only happens where the result is exactly what the interpreter would compute: integer
+// division or modulo by zero (and INT64_MIN / -1), shifts by a negative or >= 64 count, and
+// `&&`/`||` are left for the interpreter to run (and fail on) as before.
+//
+// Variables are scoped with a ScopeTracker, so a function body only sees its parameters, captures
+// and itself. A capture starts out as a copy of the captured variable and is constant when that
+// variable is and the function never assigns its copy.
+class ConstantFolder : public AstTransformer {
+public:
+    explicit ConstantFolder(OptimizationReport& report);
+
+    void fold(std::vector<AstStatPtr>& statements);
+
+    // The interpreter's result for `left op right` / `op right`, false when it must be left to run.
+    // Also used by the IR's GVN pass to fold instructions over constants.
+    static bool foldBinary(const Runtime::Value& left, TokenType op, const Runtime::Value& right, Runtime::Value& result);
+    static bool foldUnary(TokenType op, const Runtime::Value& right, Runtime::Value& result);
+
+private:
+    struct Binding {
+        bool assigned_;
+        const AstExpr* constant_; // The literal the variable holds, nullptr if it is not constant
+    };
+
+    OptimizationReport& report_;
+    bool collecting_; // First walk only records which variables are ever assigned
+    std::unordered_map<const void*, Binding> bindings_; // Keyed like the ScopeTracker's declarations
+    ScopeTracker scopes_;
+
+    void walk(std::vector<AstStatPtr>& statements);
+
+    Binding& declare(const std::string& name, const void* key);
+    Binding* lookup(const std::string& name);
+
+    void replace(AstExpr& expr, const Runtime::Value& value, const std::string& before, size_t firstNote);
+
+    void visitGroupExpr(AstExprGroup& expr) override;
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTernaryExpr(AstExprTernary& expr) override;
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <latimer/ast/ast_transformer.hpp>
+#include <latimer/optimizer/optimization_report.hpp>
+#include <latimer/optimizer/scope_tracker.hpp>
+
+// Removes statements that can never run or whose effect is never observed, after the ConstantFolder
+// has turned constant conditions into literals:
+//  - `if`s with a literal condition become the branch taken (or go entirely),
+//  - `while (false)` loops, and `for` loops whose condition is false, go (keeping the initializer),
+//  - statements after a `return`, `break` or `continue` in the same block go,
+//  - blocks that declare nothing are spliced into the enclosing block, so they no longer get an
+//    environment of their own,
+//  - local variables that are never read or assigned go when their initializer is a literal or a
+//    variable read, which can neither fail nor have an effect. Globals are always kept.
+//
+// Runs as three walks: the first simplifies control flow, the second counts the uses of every
+// declaration (scoped with a ScopeTracker, so captures count as uses of the captured variable) and
+// the third drops the unused locals, splicing the blocks this leaves without declarations.
+class DeadCodeEliminator : public AstTransformer {
+public:
+    explicit DeadCodeEliminator(OptimizationReport& report);
+
+    void eliminate(std::vector<AstStatPtr>& statements);
+
+private:
+    enum class Phase {
+        SIMPLIFY,
+        COUNT,
+        SWEEP,
+    };
+
+    OptimizationReport& report_;
+    Phase phase_;
+    std::unordered_map<const void*, size_t> uses_; // Keyed like the ScopeTracker's declarations
+    std::unordered_set<const AstStatVarDecl*> removable_; // Locals with an initializer that is safe to skip
+    ScopeTracker scopes_;
+
+    void simplify(std::vector<AstStatPtr>& statements);
+    void sweep(std::vector<AstStatPtr>& statements);
+    void use(const std::string& name);
+    bool isPure(const AstExpr* expr) const;
+
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitIfElseStat(AstStatIfElse& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <latimer/ast/ast_transformer.hpp>
+#include <latimer/optimizer/optimization_report.hpp>
+#include <latimer/optimizer/scope_tracker.hpp>
+
+// Replaces calls to small functions whose body is a single `return <expr>;` with a copy of that
+// expression, the parameters substituted by the arguments. Runs right after the Checker, so the
+// ConstantFolder then folds what the arguments made constant (`sq(3)` becomes `9`).
+//
+// A call is inlined when:
+//  - its callee is a variable that can only hold one function declaration: neither the function's
+//    name nor any capture copying it along the way is ever assigned,
+//  - the body has at most MAX_BODY_NODES nodes, assigns nothing and does not name the function
+//    itself, so inlining never recurses,
+//  - every other name the body reads means the same thing at the call site. Captures are copies
+//    made when the closure is built, so a captured variable must reach the call site through
+//    declarations and captures that are never assigned; natives must not be shadowed there,
+//  - each argument is a literal or a variable that nothing the body calls can change, or else it
+//    is used exactly once, not under a `?:` branch, in a body that calls nothing, and itself
+//    neither calls nor assigns anything. Evaluating it at its use rather than before the body
+//    then has no visible effect.
+//
+// Bodies are taken as they are once their own calls are inlined, so helpers built on helpers
+// inline all the way down. The first walk records which declarations are ever assigned.
+class Inliner : public AstTransformer {
+public:
+    static constexpr size_t MAX_BODY_NODES = 24;
+
+    explicit Inliner(OptimizationReport& report);
+
+    void inlineCalls(std::vector<AstStatPtr>& statements);
+
+private:
+    struct Candidate {
+        const AstStatFuncDecl* decl_;
+        const AstExpr* body_;
+        std::vector<size_t> uses_; // Per parameter
+        std::vector<bool> conditional_; // Per parameter, read under a `?:` branch
+        std::vector<std::pair<std::string, const void*>> names_; // Other names read, and what they mean in the body
+        size_t size_;
+        bool calls_;
+        bool inlinable_;
+    };
+
+    OptimizationReport& report_;
+    bool collecting_; // First walk only records which declarations are ever assigned
+    ScopeTracker scopes_;
+    std::unordered_map<const void*, Candidate> candidates_; // Keyed by declaration
+
+    void walk(std::vector<AstStatPtr>& statements);
+
+    void analyze(const AstStatFuncDecl& decl);
+    void scan(const AstExpr& expr, const AstStatFuncDecl& decl, Candidate& candidate, bool conditional);
+    bool simpleArgument(const AstExpr& arg, bool bodyCalls) const;
+    bool pureArgument(const AstExpr& arg) const;
+    AstExprPtr clone(const AstExpr& expr, const AstStatFuncDecl* callee, const std::vector<AstExprPtr>* args, int line) const;
+
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+};
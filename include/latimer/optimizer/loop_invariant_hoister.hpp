@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <latimer/ast/ast_transformer.hpp>
+#include <latimer/optimizer/optimization_report.hpp>
+#include <latimer/optimizer/scope_tracker.hpp>
+
+// Moves loop-invariant expressions out of `while` and `for` loops: each one is computed once into a
+// temporary declared just before the loop, and the loop reads the temporary instead. Wrapping the
+// loop in a block for the temporaries keeps them out of the enclosing scope.
+//
+// An expression is invariant when every variable it reads resolves to a declaration outside the
+// loop that nothing inside the loop assigns. Functions can only assign their own parameters,
+// locals and copies of their captures, so only assignments written inside the loop count.
+//
+// Only operators the TypeSpecializer lowered are moved, and neither string operators nor integer
+// `/` and `%`, which trap. The rest only fail on a null operand, so the temporary is computed
+// speculatively: a failure leaves it null, and the AstExprHoisted read in the loop then runs the
+// original expression, which fails at the point it would have, or not at all if the loop never gets
+// there. Calls are never moved: every native has an effect. Runs after the TypeSpecializer and
+// before the Resolver, on the AST path only.
+class LoopInvariantHoister : public AstTransformer {
+public:
+    explicit LoopInvariantHoister(OptimizationReport& report);
+
+    void hoist(std::vector<AstStatPtr>& statements);
+
+private:
+    OptimizationReport& report_;
+    ScopeTracker scopes_;
+    size_t temporaries_; // Temporaries created so far, used to name the next one
+
+    // Set while rewriting the loop being hoisted out of
+    bool extracting_;
+    int loopLine_;
+    std::unordered_set<std::string> variant_; // Names assigned or declared inside the loop
+    std::unordered_map<std::string, std::string> hoisted_; // Printed expression -> its temporary
+    std::vector<AstStatPtr> preheader_; // Declarations of the temporaries
+
+    std::vector<AstStatPtr> hoistOutOf(AstStat& loop, std::vector<AstExprPtr*> expressions, AstStatPtr& body);
+    void enterPreheader(const std::vector<AstStatPtr>& preheader);
+    void wrapInPreheader(std::vector<AstStatPtr> preheader, AstStatPtr loop);
+    bool isInvariant(const AstExpr* expr) const;
+    void extract(AstExprPtr expr);
+
+    void visitTypedUnaryExpr(AstExprTypedUnary& expr) override;
+    void visitTypedBinaryExpr(AstExprTypedBinary& expr) override;
+    void visitHoistedExpr(AstExprHoisted& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+};
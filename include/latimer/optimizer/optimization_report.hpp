@@ -0,0 +1,31 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// What the optimization passes changed, printed by --dump-opt. Passes only build messages when
+// the report is enabled, so an ordinary run pays nothing for it.
+class OptimizationReport {
+public:
+    struct Entry {
+        int line_;
+        std::string pass_;
+        std::string message_;
+    };
+
+    explicit OptimizationReport(bool enabled);
+
+    bool enabled() const;
+    void note(int line, const std::string& pass, std::string message);
+
+    // Lets a pass replace the notes for a subtree with one note for the whole subtree
+    size_t size() const;
+    void truncate(size_t size);
+
+    void print(std::ostream& out) const;
+
+private:
+    bool enabled_;
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast_transformer.hpp>
+#include <latimer/optimizer/scope_tracker.hpp>
+
+// Sets AstStatFuncDecl::pure_ on functions whose result depends only on their arguments and
+// closure, which is what lets the AstInterpreter memoize them (`--memoize`). A function is pure
+// when its body:
+//  - assigns none of its captures nor its own name, so every call sees the same closure,
+//  - calls only functions that are pure themselves, named by a variable that can only hold that
+//    one declaration (the same rule the Inliner uses). Every native prints, sleeps or reads the
+//    clock, so calling one, or calling through a parameter or a computed callee, is impure.
+// Locals and parameters are the call's own, so assigning them is fine. Recursion is too: calls
+// are collected in one walk and purity is then settled as a fixed point over the call graph.
+class PurityAnalyzer : public AstTransformer {
+public:
+    void analyze(std::vector<AstStatPtr>& statements);
+
+private:
+    struct Function {
+        AstStatFuncDecl* decl_;
+        bool pure_;
+        std::vector<const void*> callees_; // Keys the callee variables resolved to
+    };
+
+    ScopeTracker scopes_;
+    std::unordered_map<const void*, Function> functions_; // Keyed by declaration
+    std::vector<Function*> running_; // Functions whose bodies enclose the node being visited
+
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+};
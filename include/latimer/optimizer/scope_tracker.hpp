@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+
+// Tracks which declaration a name refers to while a pass walks the AST, scoping names exactly the
+// way the Resolver does: a function body only sees its parameters, captures and itself, and the
+// first declaration of a name in a scope wins. Declarations are identified by a key, usually the
+// address of the declaring node or token, which stays the same across walks of the same tree.
+//
+// Passes that open function bodies through beginFunction() can also follow a variable back through
+// the captures it was copied from (origin()), which is how the Inliner and the PurityAnalyzer tell
+// which function declaration a callee can only ever hold.
+class ScopeTracker {
+public:
+    void beginScope(bool isClosure);
+    void endScope();
+
+    // The global scope is the outermost one
+    bool atGlobalScope() const;
+
+    void declare(const std::string& name, const void* key);
+    const void* lookup(const std::string& name) const; // nullptr when the name is not visible
+
+    // Declares the function in the current scope, then opens its closure scope, holding the captures
+    // and the function's own name, and its parameter scope, which the body's statements share as in
+    // the Resolver. Captures are copied from the declaring scope before the function itself is
+    // defined there, and each capture and the own name are recorded as copies of what they were made
+    // from. Passes that keep their own bindings scope function bodies the same way.
+    void beginFunction(const AstStatFuncDecl& decl);
+    void endFunction();
+
+    // Keys as returned by lookup(); assignments are remembered across walks
+    void markAssigned(const void* key);
+    bool isAssigned(const void* key) const;
+    bool isCopy(const void* key) const; // A capture or a function's own name
+
+    // The declaration a key's value was copied from through captures, or nullptr if the key or any
+    // copy along the way may be assigned (or the copy was of nothing)
+    const void* origin(const void* key) const;
+
+private:
+    struct Scope {
+        std::unordered_map<std::string, const void*> names_;
+        bool isClosure_;
+    };
+
+    std::vector<Scope> scopes_;
+    std::unordered_set<const void*> assigned_;
+    std::unordered_map<const void*, const void*> copies_; // Capture (or function self) key -> key it was copied from
+};
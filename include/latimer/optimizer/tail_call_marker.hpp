@@ -0,0 +1,16 @@
+#pragma once
+
+#include <latimer/ast/ast_transformer.hpp>
+
+// Marks `return f(...);` statements as tail calls. The Checker only allows `return` inside a
+// function and nothing runs between the call and the return, so every such call is in tail
+// position; the AstInterpreter and the VM (TAIL_CALL) then reuse the returning function's frame
+// for the callee instead of nesting a call. Parentheses around the call are dropped so
+// `return (f(x));` counts too.
+class TailCallMarker : public AstTransformer {
+public:
+    void mark(std::vector<AstStatPtr>& statements);
+
+private:
+    void visitReturnStat(AstStatReturn& stat) override;
+};
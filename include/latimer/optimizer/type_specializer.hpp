@@ -0,0 +1,22 @@
+#pragma once
+
+#include <latimer/ast/ast_transformer.hpp>
+
+// Lowers unary and binary expressions whose operand types the Checker recorded into
+// AstExprTypedUnary / AstExprTypedBinary, which the AstInterpreter runs by testing each operand's
+// tag once against the recorded type. The Checker lets null through as any type, so a mismatch
+// goes to the generic operator and keeps its result or error. Runs after the Checker and before
+// the Resolver. Operators the interpreter has no case for (e.g. `&&` on ints) are left alone so
+// they keep failing at runtime as before.
+class TypeSpecializer : public AstTransformer {
+public:
+    void specialize(std::vector<AstStatPtr>& statements);
+
+    // The typed operator `op` runs as on operands of the given type, false if there is none
+    static bool unaryKind(TokenType op, PrimitiveType::PrimitiveKind operand, AstExprTypedUnary::Kind& kind);
+    static bool binaryKind(TokenType op, PrimitiveType::PrimitiveKind operands, AstExprTypedBinary::Kind& kind);
+
+private:
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+};
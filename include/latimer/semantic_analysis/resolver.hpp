@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+// Runs after the Checker and annotates every variable use with the environment slot the
+// AstInterpreter will find it in. Scopes mirror the runtime environments exactly: globals,
+// one per block and per for loop, and for each function a call environment (parameters, then
+// the body's locals) whose chain ends there. The function's captures, then the function itself,
+// resolve to CAPTURE slots indexing its flat closure. A function can't see past its closure
+// except for the natives, which resolve to their global slots.
+class Resolver : public AstVisitor {
+public:
+    explicit Resolver(Utils::ErrorHandler& errorHandler);
+
+    void resolve(const std::vector<AstStatPtr>& statements);
+
+private:
+    struct Scope {
+        std::unordered_map<std::string, int> slots_;
+        int slotCount_;
+        bool isClosure_;
+    };
+
+    Utils::ErrorHandler& errorHandler_;
+    std::vector<Scope> scopes_;
+    std::unordered_map<std::string, int> natives_;
+
+    void resolveStat(AstStat& stat);
+    void resolveExpr(AstExpr& expr);
+    void beginScope(bool isClosure);
+    size_t endScope();
+    int declare(const std::string& name);
+    VariableSlot lookup(const std::string& name);
+
+    void visitPrimitiveType(AstTypePrimitive& type) override;
+    void visitFunctionType(AstTypeFunction& type) override;
+
+    void visitGroupExpr(AstExprGroup& expr) override;
+    void visitUnaryExpr(AstExprUnary& expr) override;
+    void visitBinaryExpr(AstExprBinary& expr) override;
+    void visitTernaryExpr(AstExprTernary& expr) override;
+    void visitLiteralNullExpr(AstExprLiteralNull& expr) override;
+    void visitLiteralBoolExpr(AstExprLiteralBool& expr) override;
+    void visitLiteralIntExpr(AstExprLiteralInt& expr) override;
+    void visitLiteralDoubleExpr(AstExprLiteralDouble& expr) override;
+    void visitLiteralStringExpr(AstExprLiteralString& expr) override;
+    void visitLiteralCharExpr(AstExprLiteralChar& expr) override;
+    void visitVariableExpr(AstExprVariable& expr) override;
+    void visitHoistedExpr(AstExprHoisted& expr) override;
+    void visitAssignmentExpr(AstExprAssignment& expr) override;
+    void visitCallExpr(AstExprCall& expr) override;
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override;
+    void visitExpressionStat(AstStatExpression& stat) override;
+    void visitIfElseStat(AstStatIfElse& stat) override;
+    void visitWhileStat(AstStatWhile& stat) override;
+    void visitForStat(AstStatFor& stat) override;
+    void visitBreakStat(AstStatBreak& stat) override;
+    void visitContinueStat(AstStatContinue& stat) override;
+    void visitBlockStat(AstStatBlock& stat) override;
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override;
+    void visitReturnStat(AstStatReturn& stat) override;
+};
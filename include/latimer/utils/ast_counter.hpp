@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/ast/ast_transformer.hpp>
+
+// Counts the expression and statement nodes of a program and the bytes of the node objects
+// themselves, for --time-phases, --trace and --heap-profile
+class AstCounter : public AstTransformer {
+public:
+    size_t count(std::vector<AstStatPtr>& statements) {
+        count_ = 0;
+        bytes_ = 0;
+        transform(statements);
+        return count_;
+    }
+
+    size_t bytes() const { return bytes_; } // Of the last count()
+
+private:
+    size_t count_ = 0;
+    size_t bytes_ = 0;
+
+    void counted(size_t bytes) {
+        count_++;
+        bytes_ += bytes;
+    }
+
+    void visitGroupExpr(AstExprGroup& expr) override { counted(sizeof(expr)); AstTransformer::visitGroupExpr(expr); }
+    void visitUnaryExpr(AstExprUnary& expr) override { counted(sizeof(expr)); AstTransformer::visitUnaryExpr(expr); }
+    void visitBinaryExpr(AstExprBinary& expr) override { counted(sizeof(expr)); AstTransformer::visitBinaryExpr(expr); }
+    void visitTernaryExpr(AstExprTernary& expr) override { counted(sizeof(expr)); AstTransformer::visitTernaryExpr(expr); }
+    void visitLiteralNullExpr(AstExprLiteralNull& expr) override { counted(sizeof(expr)); }
+    void visitLiteralBoolExpr(AstExprLiteralBool& expr) override { counted(sizeof(expr)); }
+    void visitLiteralIntExpr(AstExprLiteralInt& expr) override { counted(sizeof(expr)); }
+    void visitLiteralDoubleExpr(AstExprLiteralDouble& expr) override { counted(sizeof(expr)); }
+    void visitLiteralStringExpr(AstExprLiteralString& expr) override { counted(sizeof(expr)); }
+    void visitLiteralCharExpr(AstExprLiteralChar& expr) override { counted(sizeof(expr)); }
+    void visitVariableExpr(AstExprVariable& expr) override { counted(sizeof(expr)); }
+    void visitHoistedExpr(AstExprHoisted& expr) override { counted(sizeof(expr)); AstTransformer::visitHoistedExpr(expr); }
+    void visitAssignmentExpr(AstExprAssignment& expr) override { counted(sizeof(expr)); AstTransformer::visitAssignmentExpr(expr); }
+    void visitCallExpr(AstExprCall& expr) override { counted(sizeof(expr)); AstTransformer::visitCallExpr(expr); }
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override { counted(sizeof(stat)); AstTransformer::visitVarDeclStat(stat); }
+    void visitExpressionStat(AstStatExpression& stat) override { counted(sizeof(stat)); AstTransformer::visitExpressionStat(stat); }
+    void visitIfElseStat(AstStatIfElse& stat) override { counted(sizeof(stat)); AstTransformer::visitIfElseStat(stat); }
+    void visitWhileStat(AstStatWhile& stat) override { counted(sizeof(stat)); AstTransformer::visitWhileStat(stat); }
+    void visitForStat(AstStatFor& stat) override { counted(sizeof(stat)); AstTransformer::visitForStat(stat); }
+    void visitBreakStat(AstStatBreak& stat) override { counted(sizeof(stat)); }
+    void visitContinueStat(AstStatContinue& stat) override { counted(sizeof(stat)); }
+    void visitBlockStat(AstStatBlock& stat) override { counted(sizeof(stat)); AstTransformer::visitBlockStat(stat); }
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override { counted(sizeof(stat)); AstTransformer::visitFuncDeclStat(stat); }
+    void visitReturnStat(AstStatReturn& stat) override { counted(sizeof(stat)); AstTransformer::visitReturnStat(stat); }
+};
@@ -57,4 +57,33 @@ private:
     void visitLiteralCharExpr(AstExprLiteralChar& expr) override {
         result_ = "'" + std::string(1, expr.value_) + "'";
     }
+
+    void visitVariableExpr(AstExprVariable& expr) override {
+        result_ = expr.name_.lexeme_;
+    }
+
+    void visitAssignmentExpr(AstExprAssignment& expr) override {
+        result_ = "(= " + expr.name_.lexeme_ + " " + print(*expr.value_) + ")";
+    }
+
+    void visitCallExpr(AstExprCall& expr) override {
+        std::string call = "(call " + print(*expr.callee_);
+        for (const AstExprPtr& arg : expr.args_)
+            call += " " + print(*arg);
+        result_ = call + ")";
+    }
+
+    // Only expressions are printed
+    void visitPrimitiveType(AstTypePrimitive& type) override {}
+    void visitFunctionType(AstTypeFunction& type) override {}
+    void visitVarDeclStat(AstStatVarDecl& stat) override {}
+    void visitExpressionStat(AstStatExpression& stat) override {}
+    void visitIfElseStat(AstStatIfElse& stat) override {}
+    void visitForStat(AstStatFor& stat) override {}
+    void visitWhileStat(AstStatWhile& stat) override {}
+    void visitBreakStat(AstStatBreak& stat) override {}
+    void visitContinueStat(AstStatContinue& stat) override {}
+    void visitBlockStat(AstStatBlock& stat) override {}
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override {}
+    void visitReturnStat(AstStatReturn& stat) override {}
 };
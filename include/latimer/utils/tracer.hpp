@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <latimer/ast/ast.hpp>
+
+// Timeline of a run for --trace and --time-phases: a span per pipeline phase, with counts such as
+// tokens or AST nodes attached, and with --trace-calls a span per user function call. Like the
+// OptimizationReport, a disabled tracer records nothing. The trace is Chrome's trace-event JSON,
+// which chrome://tracing, Perfetto and speedscope open.
+class Tracer {
+public:
+    static constexpr size_t MAX_CALL_SPANS = 1 << 20; // Calls past this are counted, not recorded
+
+    Tracer(bool enabled, bool traceCalls);
+
+    bool enabled() const;
+    bool tracesCalls() const;
+
+    // Phases follow each other; beginning one ends the one before
+    void beginPhase(std::string name);
+    void endPhase();
+    void count(std::string name, size_t value); // Attached to the phase running or last ended
+
+    void enterCall(const AstStatFuncDecl* function);
+    void exitCall();
+
+    // Duration and share of each phase, with its counts
+    void printPhases(std::ostream& out) const;
+    void writeTrace(std::ostream& out) const;
+
+    // Follows UserFunction::run like the profilers' scopes, so a tail call ends its caller's span
+    class Scope {
+    public:
+        Scope(Tracer* tracer, const AstStatFuncDecl* function)
+            : tracer_(tracer) {
+            if (tracer_ != nullptr) tracer_->enterCall(function);
+        }
+
+        ~Scope() {
+            if (tracer_ != nullptr) tracer_->exitCall();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Tracer* tracer_;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        std::string name_;
+        Clock::duration start_; // Since the tracer was made
+        Clock::duration duration_;
+        std::vector<std::pair<std::string, size_t>> counts_;
+    };
+
+    struct Call {
+        const AstStatFuncDecl* function_;
+        Clock::duration start_;
+        Clock::duration duration_;
+    };
+
+    bool enabled_;
+    bool traceCalls_;
+    Clock::time_point origin_;
+    std::vector<Phase> phases_;
+    bool inPhase_;
+    std::vector<Call> calls_;
+    std::vector<size_t> open_; // Index in calls_ of every call being run, or SIZE_MAX if dropped
+    size_t droppedCalls_;
+};
@@ -20,6 +20,14 @@ void AstExprBinary::accept(AstVisitor& visitor) {
     visitor.visitBinaryExpr(*this);
 }
 
+void AstExprTypedUnary::accept(AstVisitor& visitor) {
+    visitor.visitTypedUnaryExpr(*this);
+}
+
+void AstExprTypedBinary::accept(AstVisitor& visitor) {
+    visitor.visitTypedBinaryExpr(*this);
+}
+
 void AstExprTernary::accept(AstVisitor& visitor) {
     visitor.visitTernaryExpr(*this);
 }
@@ -52,6 +60,10 @@ void AstExprVariable::accept(AstVisitor& visitor) {
     visitor.visitVariableExpr(*this);
 }
 
+void AstExprHoisted::accept(AstVisitor& visitor) {
+    visitor.visitHoistedExpr(*this);
+}
+
 void AstExprAssignment::accept(AstVisitor& visitor) {
     visitor.visitAssignmentExpr(*this);
 }
@@ -0,0 +1,140 @@
+#include <latimer/ast/ast_transformer.hpp>
+
+void AstTransformer::transform(std::vector<AstStatPtr>& statements) {
+    for (AstStatPtr& stat : statements)
+        transformStat(stat);
+}
+
+void AstTransformer::transformExpr(AstExprPtr& expr) {
+    if (expr == nullptr)
+        return;
+
+    expr->accept(*this);
+    if (exprReplacement_ != nullptr)
+        expr = std::move(exprReplacement_);
+}
+
+void AstTransformer::transformStat(AstStatPtr& stat) {
+    if (stat == nullptr)
+        return;
+
+    stat->accept(*this);
+    if (statReplacement_ != nullptr)
+        stat = std::move(statReplacement_);
+}
+
+void AstTransformer::visitPrimitiveType(AstTypePrimitive& type) {
+
+}
+
+void AstTransformer::visitFunctionType(AstTypeFunction& type) {
+
+}
+
+void AstTransformer::visitGroupExpr(AstExprGroup& expr) {
+    transformExpr(expr.expr_);
+}
+
+void AstTransformer::visitUnaryExpr(AstExprUnary& expr) {
+    transformExpr(expr.right_);
+}
+
+void AstTransformer::visitBinaryExpr(AstExprBinary& expr) {
+    transformExpr(expr.left_);
+    transformExpr(expr.right_);
+}
+
+void AstTransformer::visitTernaryExpr(AstExprTernary& expr) {
+    transformExpr(expr.condition_);
+    transformExpr(expr.thenBranch_);
+    transformExpr(expr.elseBranch_);
+}
+
+void AstTransformer::visitLiteralNullExpr(AstExprLiteralNull& expr) {
+
+}
+
+void AstTransformer::visitLiteralBoolExpr(AstExprLiteralBool& expr) {
+
+}
+
+void AstTransformer::visitLiteralIntExpr(AstExprLiteralInt& expr) {
+
+}
+
+void AstTransformer::visitLiteralDoubleExpr(AstExprLiteralDouble& expr) {
+
+}
+
+void AstTransformer::visitLiteralStringExpr(AstExprLiteralString& expr) {
+
+}
+
+void AstTransformer::visitLiteralCharExpr(AstExprLiteralChar& expr) {
+
+}
+
+void AstTransformer::visitVariableExpr(AstExprVariable& expr) {
+
+}
+
+void AstTransformer::visitHoistedExpr(AstExprHoisted& expr) {
+    transformExpr(expr.expr_);
+}
+
+void AstTransformer::visitAssignmentExpr(AstExprAssignment& expr) {
+    transformExpr(expr.value_);
+}
+
+void AstTransformer::visitCallExpr(AstExprCall& expr) {
+    transformExpr(expr.callee_);
+    for (AstExprPtr& arg : expr.args_)
+        transformExpr(arg);
+}
+
+void AstTransformer::visitVarDeclStat(AstStatVarDecl& stat) {
+    transformExpr(stat.initializer_);
+}
+
+void AstTransformer::visitExpressionStat(AstStatExpression& stat) {
+    transformExpr(stat.expr_);
+}
+
+void AstTransformer::visitIfElseStat(AstStatIfElse& stat) {
+    transformExpr(stat.condition_);
+    transformStat(stat.thenBranch_);
+    transformStat(stat.elseBranch_);
+}
+
+void AstTransformer::visitWhileStat(AstStatWhile& stat) {
+    transformExpr(stat.condition_);
+    transformStat(stat.body_);
+}
+
+void AstTransformer::visitForStat(AstStatFor& stat) {
+    transformStat(stat.initializer_);
+    transformExpr(stat.condition_);
+    transformExpr(stat.increment_);
+    transformStat(stat.body_);
+}
+
+void AstTransformer::visitBreakStat(AstStatBreak& stat) {
+
+}
+
+void AstTransformer::visitContinueStat(AstStatContinue& stat) {
+
+}
+
+void AstTransformer::visitBlockStat(AstStatBlock& stat) {
+    for (AstStatPtr& inner : stat.body_)
+        transformStat(inner);
+}
+
+void AstTransformer::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    transformStat(stat.body_);
+}
+
+void AstTransformer::visitReturnStat(AstStatReturn& stat) {
+    transformExpr(stat.value_);
+}
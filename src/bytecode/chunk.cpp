@@ -0,0 +1,16 @@
+#include <latimer/bytecode/chunk.hpp>
+
+void Chunk::write(uint8_t byte, int line) {
+    code_.push_back(byte);
+    lines_.push_back(line);
+}
+
+void Chunk::writeShort(uint16_t value, int line) {
+    write(static_cast<uint8_t>((value >> 8) & 0xff), line);
+    write(static_cast<uint8_t>(value & 0xff), line);
+}
+
+size_t Chunk::addConstant(Runtime::Value value) {
+    constants_.push_back(value);
+    return constants_.size() - 1;
+}
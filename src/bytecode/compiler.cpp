@@ -0,0 +1,514 @@
+#include <latimer/bytecode/compiler.hpp>
+
+#include <iostream>
+
+#include <latimer/interpreter/native_functions.hpp>
+
+BytecodeCompiler::BytecodeCompiler(Utils::ErrorHandler& errorHandler)
+    : errorHandler_(errorHandler)
+    , program_()
+    , current_(nullptr)
+    , globals_()
+    , natives_()
+    , line_(0) {}
+
+Program BytecodeCompiler::compile(const std::vector<AstStatPtr>& statements) {
+    program_ = Program();
+    globals_.clear();
+    natives_.clear();
+
+    // Natives occupy the first global slots, in the order the VM binds them
+    for (auto& native : nativeFunctions()) {
+        addGlobal(native.first);
+        natives_.insert(native.first);
+    }
+
+    program_.functions_.push_back(std::make_unique<FunctionProto>("<script>", 0));
+    FunctionState script{program_.functions_.front().get(), nullptr, "", {}, {}, {}, 0, true};
+    script.locals_.push_back({"", 0}); // slot 0 holds the running closure
+    current_ = &script;
+
+    try {
+        for (const AstStatPtr& stat : statements) {
+            if (!stat) throw InternalCompilerError("[Internal Compiler Error]: nullptr statement in AST list.");
+
+            compileStat(*stat);
+        }
+
+        emit(OpCode::NIL);
+        emit(OpCode::RETURN);
+    } catch (InternalCompilerError error) {
+        std::cerr << error.what() << std::endl;
+        errorHandler_.hadError_ = true;
+    }
+
+    current_ = nullptr;
+    return std::move(program_);
+}
+
+void BytecodeCompiler::compileStat(AstStat& stat) {
+    line_ = stat.line_;
+    stat.accept(*this);
+}
+
+void BytecodeCompiler::compileExpr(AstExpr& expr) {
+    line_ = expr.line_;
+    expr.accept(*this);
+}
+
+Chunk& BytecodeCompiler::chunk() {
+    return current_->proto_->chunk_;
+}
+
+void BytecodeCompiler::emit(OpCode op) {
+    chunk().write(static_cast<uint8_t>(op), line_);
+}
+
+void BytecodeCompiler::emitByte(uint8_t byte) {
+    chunk().write(byte, line_);
+}
+
+void BytecodeCompiler::emitShort(uint16_t value) {
+    chunk().writeShort(value, line_);
+}
+
+void BytecodeCompiler::emitOp(OpCode op, uint16_t operand) {
+    emit(op);
+    emitShort(operand);
+}
+
+uint16_t BytecodeCompiler::makeConstant(Runtime::Value value) {
+    size_t index = chunk().addConstant(value);
+    if (index > UINT16_MAX)
+        throw InternalCompilerError("[Internal Compiler Error]: Too many constants in function '" + current_->proto_->name_ + "'.");
+
+    return static_cast<uint16_t>(index);
+}
+
+size_t BytecodeCompiler::emitJump(OpCode op) {
+    emit(op);
+    emitShort(UINT16_MAX);
+    return chunk().code_.size() - 2;
+}
+
+size_t BytecodeCompiler::emitConditionalJump(ConditionKind kind) {
+    emit(OpCode::JUMP_IF_FALSE);
+    emitByte(static_cast<uint8_t>(kind));
+    emitShort(UINT16_MAX);
+    return chunk().code_.size() - 2;
+}
+
+void BytecodeCompiler::patchJump(size_t offset) {
+    size_t jump = chunk().code_.size() - offset - 2;
+    if (jump > UINT16_MAX)
+        throw InternalCompilerError("[Internal Compiler Error]: Too much code to jump over.");
+
+    chunk().code_[offset] = static_cast<uint8_t>((jump >> 8) & 0xff);
+    chunk().code_[offset + 1] = static_cast<uint8_t>(jump & 0xff);
+}
+
+void BytecodeCompiler::emitLoop(size_t loopStart) {
+    emit(OpCode::LOOP);
+
+    size_t offset = chunk().code_.size() - loopStart + 2;
+    if (offset > UINT16_MAX)
+        throw InternalCompilerError("[Internal Compiler Error]: Loop body too large.");
+
+    emitShort(static_cast<uint16_t>(offset));
+}
+
+void BytecodeCompiler::emitPops(size_t count) {
+    if (count == 1)
+        emit(OpCode::POP);
+    else if (count > 1)
+        emitOp(OpCode::POP_N, static_cast<uint16_t>(count));
+}
+
+void BytecodeCompiler::beginScope() {
+    current_->scopeDepth_++;
+}
+
+void BytecodeCompiler::endScope() {
+    current_->scopeDepth_--;
+
+    size_t count = localsAbove(current_->scopeDepth_);
+    emitPops(count);
+    current_->locals_.resize(current_->locals_.size() - count);
+}
+
+size_t BytecodeCompiler::localsAbove(int depth) {
+    size_t count = 0;
+    for (auto it = current_->locals_.rbegin(); it != current_->locals_.rend() && it->depth_ > depth; ++it)
+        count++;
+    return count;
+}
+
+void BytecodeCompiler::declareVariable(const std::string& name) {
+    // The value is already on the stack: top-level declarations move it into a global
+    // slot, everything else leaves it where it is as a new local.
+    if (current_->isScript_ && current_->scopeDepth_ == 0) {
+        emitOp(OpCode::SET_GLOBAL, addGlobal(name));
+        emit(OpCode::POP);
+        return;
+    }
+
+    if (current_->locals_.size() > UINT16_MAX)
+        throw InternalCompilerError("[Internal Compiler Error]: Too many local variables in function '" + current_->proto_->name_ + "'.");
+
+    current_->locals_.push_back({name, current_->scopeDepth_});
+}
+
+BytecodeCompiler::VarRef BytecodeCompiler::resolve(FunctionState& state, const std::string& name) {
+    for (size_t i = state.locals_.size(); i-- > 0;) {
+        if (state.locals_[i].name_ == name)
+            return {VarKind::LOCAL, static_cast<uint16_t>(i)};
+    }
+
+    if (state.isScript_) {
+        auto global = globals_.find(name);
+        if (global != globals_.end())
+            return {VarKind::GLOBAL, global->second};
+
+        return {VarKind::UNDEFINED, makeConstant(name)};
+    }
+
+    // A function's closure holds its captures, then itself, then the natives
+    for (size_t i = 0; i < state.captures_.size(); i++) {
+        if (state.captures_[i] == name)
+            return {VarKind::CAPTURE, static_cast<uint16_t>(i)};
+    }
+
+    if (state.selfName_ == name)
+        return {VarKind::LOCAL, 0};
+
+    if (natives_.count(name))
+        return {VarKind::GLOBAL, globals_.at(name)};
+
+    return {VarKind::UNDEFINED, makeConstant(name)};
+}
+
+uint16_t BytecodeCompiler::addGlobal(const std::string& name) {
+    auto global = globals_.find(name);
+    if (global != globals_.end())
+        return global->second;
+
+    if (program_.globalNames_.size() > UINT16_MAX)
+        throw InternalCompilerError("[Internal Compiler Error]: Too many global variables.");
+
+    uint16_t index = static_cast<uint16_t>(program_.globalNames_.size());
+    program_.globalNames_.push_back(name);
+    globals_.insert({name, index});
+    return index;
+}
+
+void BytecodeCompiler::visitPrimitiveType(AstTypePrimitive& type) {
+
+}
+
+void BytecodeCompiler::visitFunctionType(AstTypeFunction& type) {
+
+}
+
+void BytecodeCompiler::visitGroupExpr(AstExprGroup& expr) {
+    compileExpr(*expr.expr_);
+}
+
+void BytecodeCompiler::visitUnaryExpr(AstExprUnary& expr) {
+    compileExpr(*expr.right_);
+
+    line_ = expr.op_.line_;
+    switch (expr.op_.type_) {
+        case TokenType::BANG: emit(OpCode::NOT); break;
+        case TokenType::TILDE: emit(OpCode::BIT_NOT); break;
+        case TokenType::MINUS: emit(OpCode::NEGATE); break;
+        default:
+            throw InternalCompilerError("[Internal Compiler Error]: Unexpected Unary Operator: " + expr.op_.stringifyTokenType() + ".");
+    }
+}
+
+void BytecodeCompiler::visitBinaryExpr(AstExprBinary& expr) {
+    compileExpr(*expr.left_);
+    compileExpr(*expr.right_);
+
+    line_ = expr.op_.line_;
+    switch (expr.op_.type_) {
+        case TokenType::SLASH: emit(OpCode::DIVIDE); break;
+        case TokenType::STAR: emit(OpCode::MULTIPLY); break;
+        case TokenType::PERECENT: emit(OpCode::MODULO); break;
+        case TokenType::MINUS: emit(OpCode::SUBTRACT); break;
+        case TokenType::PLUS: emit(OpCode::ADD); break;
+        case TokenType::GREATER_GREATER: emit(OpCode::SHIFT_RIGHT); break;
+        case TokenType::LESS_LESS: emit(OpCode::SHIFT_LEFT); break;
+        case TokenType::GREATER: emit(OpCode::GREATER); break;
+        case TokenType::GREATER_EQUAL: emit(OpCode::GREATER_EQUAL); break;
+        case TokenType::LESS: emit(OpCode::LESS); break;
+        case TokenType::LESS_EQUAL: emit(OpCode::LESS_EQUAL); break;
+        case TokenType::EQUAL_EQUAL: emit(OpCode::EQUAL); break;
+        case TokenType::BANG_EQUAL: emit(OpCode::NOT_EQUAL); break;
+        case TokenType::PIPE: emit(OpCode::BIT_OR); break;
+        case TokenType::AMPERSAND: emit(OpCode::BIT_AND); break;
+        case TokenType::CARET: emit(OpCode::BIT_XOR); break;
+        case TokenType::PIPE_PIPE: emit(OpCode::LOGICAL_OR); break;
+        case TokenType::AMPERSAND_AMPERSAND: emit(OpCode::LOGICAL_AND); break;
+        default:
+            throw InternalCompilerError("[Internal Compiler Error]: Unexpected Binary Operator: " + expr.op_.stringifyTokenType() + ".");
+    }
+}
+
+void BytecodeCompiler::visitTernaryExpr(AstExprTernary& expr) {
+    compileExpr(*expr.condition_);
+
+    line_ = expr.line_;
+    size_t elseJump = emitConditionalJump(ConditionKind::TERNARY);
+    compileExpr(*expr.thenBranch_);
+    size_t endJump = emitJump(OpCode::JUMP);
+    patchJump(elseJump);
+    compileExpr(*expr.elseBranch_);
+    patchJump(endJump);
+}
+
+void BytecodeCompiler::visitLiteralNullExpr(AstExprLiteralNull& expr) {
+    emit(OpCode::NIL);
+}
+
+void BytecodeCompiler::visitLiteralBoolExpr(AstExprLiteralBool& expr) {
+    emit(expr.value_ ? OpCode::TRUE : OpCode::FALSE);
+}
+
+void BytecodeCompiler::visitLiteralIntExpr(AstExprLiteralInt& expr) {
+    emitOp(OpCode::CONSTANT, makeConstant(expr.value_));
+}
+
+void BytecodeCompiler::visitLiteralDoubleExpr(AstExprLiteralDouble& expr) {
+    emitOp(OpCode::CONSTANT, makeConstant(expr.value_));
+}
+
+void BytecodeCompiler::visitLiteralStringExpr(AstExprLiteralString& expr) {
+    emitOp(OpCode::CONSTANT, makeConstant(expr.value_));
+}
+
+void BytecodeCompiler::visitLiteralCharExpr(AstExprLiteralChar& expr) {
+    emitOp(OpCode::CONSTANT, makeConstant(expr.value_));
+}
+
+void BytecodeCompiler::visitVariableExpr(AstExprVariable& expr) {
+    VarRef ref = resolve(*current_, expr.name_.lexeme_);
+
+    line_ = expr.name_.line_;
+    switch (ref.kind_) {
+        case VarKind::LOCAL: emitOp(OpCode::GET_LOCAL, ref.index_); break;
+        case VarKind::GLOBAL: emitOp(OpCode::GET_GLOBAL, ref.index_); break;
+        case VarKind::CAPTURE: emitOp(OpCode::GET_CAPTURE, ref.index_); break;
+        case VarKind::UNDEFINED: emitOp(OpCode::GET_UNDEFINED, ref.index_); break;
+    }
+}
+
+void BytecodeCompiler::visitAssignmentExpr(AstExprAssignment& expr) {
+    compileExpr(*expr.value_);
+    VarRef ref = resolve(*current_, expr.name_.lexeme_);
+
+    line_ = expr.name_.line_;
+    switch (ref.kind_) {
+        case VarKind::LOCAL: emitOp(OpCode::SET_LOCAL, ref.index_); break;
+        case VarKind::GLOBAL: emitOp(OpCode::SET_GLOBAL, ref.index_); break;
+        case VarKind::CAPTURE: emitOp(OpCode::SET_CAPTURE, ref.index_); break;
+        case VarKind::UNDEFINED: emitOp(OpCode::SET_UNDEFINED, ref.index_); break;
+    }
+}
+
+void BytecodeCompiler::visitCallExpr(AstExprCall& expr) {
+    compileExpr(*expr.callee_);
+    for (const auto& arg : expr.args_)
+        compileExpr(*arg);
+
+    line_ = expr.line_;
+    emit(OpCode::CALL);
+    emitByte(static_cast<uint8_t>(expr.args_.size()));
+}
+
+void BytecodeCompiler::visitVarDeclStat(AstStatVarDecl& stat) {
+    if (stat.initializer_ != nullptr)
+        compileExpr(*stat.initializer_);
+    else
+        emit(OpCode::NIL);
+
+    line_ = stat.line_;
+    declareVariable(stat.name_.lexeme_);
+}
+
+void BytecodeCompiler::visitExpressionStat(AstStatExpression& stat) {
+    compileExpr(*stat.expr_);
+    emit(OpCode::POP);
+}
+
+void BytecodeCompiler::visitIfElseStat(AstStatIfElse& stat) {
+    compileExpr(*stat.condition_);
+
+    line_ = stat.line_;
+    size_t elseJump = emitConditionalJump(ConditionKind::IF);
+    compileStat(*stat.thenBranch_);
+
+    if (stat.elseBranch_ == nullptr) {
+        patchJump(elseJump);
+        return;
+    }
+
+    size_t endJump = emitJump(OpCode::JUMP);
+    patchJump(elseJump);
+    compileStat(*stat.elseBranch_);
+    patchJump(endJump);
+}
+
+void BytecodeCompiler::visitWhileStat(AstStatWhile& stat) {
+    size_t loopStart = chunk().code_.size();
+    compileExpr(*stat.condition_);
+
+    line_ = stat.line_;
+    size_t exitJump = emitConditionalJump(ConditionKind::WHILE);
+
+    current_->loops_.push_back({loopStart, current_->scopeDepth_, {}, {}});
+    compileStat(*stat.body_);
+    Loop loop = std::move(current_->loops_.back());
+    current_->loops_.pop_back();
+
+    for (size_t jump : loop.continueJumps_)
+        patchJump(jump);
+
+    line_ = stat.line_;
+    emitLoop(loopStart);
+    patchJump(exitJump);
+
+    for (size_t jump : loop.breakJumps_)
+        patchJump(jump);
+}
+
+void BytecodeCompiler::visitForStat(AstStatFor& stat) {
+    beginScope();
+
+    if (stat.initializer_ != nullptr)
+        compileStat(*stat.initializer_);
+
+    size_t loopStart = chunk().code_.size();
+    bool hasExit = stat.condition_ != nullptr;
+    size_t exitJump = 0;
+    if (hasExit) {
+        compileExpr(*stat.condition_);
+        line_ = stat.line_;
+        exitJump = emitConditionalJump(ConditionKind::FOR);
+    }
+
+    current_->loops_.push_back({loopStart, current_->scopeDepth_, {}, {}});
+    compileStat(*stat.body_);
+    Loop loop = std::move(current_->loops_.back());
+    current_->loops_.pop_back();
+
+    for (size_t jump : loop.continueJumps_)
+        patchJump(jump);
+
+    if (stat.increment_ != nullptr) {
+        compileExpr(*stat.increment_);
+        emit(OpCode::POP);
+    }
+
+    line_ = stat.line_;
+    emitLoop(loopStart);
+    if (hasExit)
+        patchJump(exitJump);
+
+    for (size_t jump : loop.breakJumps_)
+        patchJump(jump);
+
+    endScope();
+}
+
+void BytecodeCompiler::visitBreakStat(AstStatBreak& stat) {
+    if (current_->loops_.empty())
+        throw InternalCompilerError("[Internal Compiler Error]: 'break' outside of a loop.");
+
+    Loop& loop = current_->loops_.back();
+    emitPops(localsAbove(loop.scopeDepth_));
+    loop.breakJumps_.push_back(emitJump(OpCode::JUMP));
+}
+
+void BytecodeCompiler::visitContinueStat(AstStatContinue& stat) {
+    if (current_->loops_.empty())
+        throw InternalCompilerError("[Internal Compiler Error]: 'continue' outside of a loop.");
+
+    Loop& loop = current_->loops_.back();
+    emitPops(localsAbove(loop.scopeDepth_));
+    loop.continueJumps_.push_back(emitJump(OpCode::JUMP));
+}
+
+void BytecodeCompiler::visitBlockStat(AstStatBlock& stat) {
+    beginScope();
+    for (const AstStatPtr& inner : stat.body_)
+        compileStat(*inner);
+    endScope();
+}
+
+void BytecodeCompiler::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    if (program_.functions_.size() > UINT16_MAX)
+        throw InternalCompilerError("[Internal Compiler Error]: Too many functions.");
+
+    uint16_t index = static_cast<uint16_t>(program_.functions_.size());
+    program_.functions_.push_back(std::make_unique<FunctionProto>(stat.name_.lexeme_, stat.paramNames_.size()));
+    FunctionProto* proto = program_.functions_.back().get();
+    proto->captureCount_ = stat.captures_.size();
+
+    // Captures are copied out of the declaring scope when the CLOSURE instruction runs
+    line_ = stat.line_;
+    emitOp(OpCode::CLOSURE, index);
+    for (const Token& capture : stat.captures_) {
+        VarRef ref = resolve(*current_, capture.lexeme_);
+        switch (ref.kind_) {
+            case VarKind::LOCAL: emitByte(static_cast<uint8_t>(CaptureKind::LOCAL)); break;
+            case VarKind::GLOBAL: emitByte(static_cast<uint8_t>(CaptureKind::GLOBAL)); break;
+            case VarKind::CAPTURE: emitByte(static_cast<uint8_t>(CaptureKind::CAPTURE)); break;
+            case VarKind::UNDEFINED: emitByte(static_cast<uint8_t>(CaptureKind::UNDEFINED)); break;
+        }
+        emitShort(ref.index_);
+    }
+
+    FunctionState function{proto, current_, stat.name_.lexeme_, {}, {}, {}, 1, false};
+    for (const Token& capture : stat.captures_)
+        function.captures_.push_back(capture.lexeme_);
+    function.locals_.push_back({"", 0}); // slot 0 holds the callee
+    for (const Token& param : stat.paramNames_)
+        function.locals_.push_back({param.lexeme_, 1});
+
+    // Like UserFunction::call, the body shares its scope with the parameters
+    current_ = &function;
+    for (const AstStatPtr& inner : body->body_)
+        compileStat(*inner);
+    emit(OpCode::NIL);
+    emit(OpCode::RETURN);
+    current_ = function.enclosing_;
+
+    line_ = stat.line_;
+    declareVariable(stat.name_.lexeme_);
+}
+
+void BytecodeCompiler::visitReturnStat(AstStatReturn& stat) {
+    if (stat.tailCall_) {
+        // The RETURN after it only runs when the callee was native
+        AstExprCall& call = static_cast<AstExprCall&>(*stat.value_);
+        compileExpr(*call.callee_);
+        for (const auto& arg : call.args_)
+            compileExpr(*arg);
+
+        line_ = call.line_;
+        emit(OpCode::TAIL_CALL);
+        emitByte(static_cast<uint8_t>(call.args_.size()));
+    } else if (stat.value_ != nullptr) {
+        compileExpr(*stat.value_);
+    } else {
+        emit(OpCode::NIL);
+    }
+
+    line_ = stat.line_;
+    emit(OpCode::RETURN);
+}
@@ -0,0 +1,367 @@
+#include <latimer/bytecode/vm.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include <latimer/interpreter/int_arithmetic.hpp>
+#include <latimer/interpreter/native_functions.hpp>
+
+Closure::Closure(Runtime::Collector& collector, const FunctionProto* proto)
+    : Runtime::CollectedCallable(collector)
+    , proto_(proto)
+    , captures_() {}
+
+Runtime::Value* Closure::ownedValues(size_t& count) {
+    count = captures_.size();
+    return captures_.data();
+}
+
+size_t Closure::arity() const {
+    return proto_->arity_;
+}
+
+Runtime::Value Closure::call(UNUSED int line, UNUSED AstInterpreter& interpreter, UNUSED Runtime::Arguments arguments) {
+    throw InternalCompilerError("[Internal Compiler Error]: Bytecode closure '" + proto_->name_ + "' called outside of the VM.");
+}
+
+std::string Closure::toString() const {
+    return "<fn " + proto_->name_ + ">";
+}
+
+VM::VM(Utils::ErrorHandler& errorHandler)
+    : collector_()
+    , errorHandler_(errorHandler)
+    , program_(nullptr)
+    , stack_()
+    , frames_()
+    , globals_() {}
+
+void VM::interpret(const Program& program) {
+    program_ = &program;
+    globals_.assign(program.globalNames_.size(), std::monostate());
+
+    size_t nativeIndex = 0;
+    for (auto& native : nativeFunctions())
+        globals_.at(nativeIndex++) = native.second;
+
+    try {
+        Closure* script = new Closure(collector_, program.functions_.front().get());
+        stack_.emplace_back(script);
+        frames_.push_back({script, script->proto_->chunk_.code_.data(), 0});
+
+        run();
+    } catch (RuntimeError error) {
+        errorHandler_.runtimeError(error);
+    } catch (InternalCompilerError error) {
+        std::cerr << error.what() << std::endl;
+    }
+
+    frames_.clear();
+    stack_.clear();
+}
+
+Runtime::Collector& VM::collector() {
+    return collector_;
+}
+
+int VM::currentLine() {
+    const CallFrame& frame = frames_.back();
+    const Chunk& chunk = frame.closure_->proto_->chunk_;
+    return chunk.lines_.at(frame.ip_ - chunk.code_.data() - 1);
+}
+
+void VM::callValue(const Runtime::Value& callee, uint8_t argCount, int line) {
+    if (!callee.is<Runtime::Callable>())
+        throw RuntimeError(line, "Attempted to call a non-callable value.");
+
+    Runtime::Callable* callable = callee.as<Runtime::Callable>();
+    if (callable->arity() != 255 && argCount != callable->arity())
+        throw RuntimeError(line, "Expected " + std::to_string(callable->arity()) + " arguments but got " + std::to_string(argCount) + ".");
+
+    if (callable->isNative()) {
+        Runtime::Arguments arguments(stack_.data() + stack_.size() - argCount, argCount);
+        Runtime::Value result = static_cast<NativeFunction*>(callable)->invoke(line, arguments);
+        stack_.resize(stack_.size() - argCount - 1);
+        stack_.push_back(std::move(result));
+        return;
+    }
+
+    if (frames_.size() >= FRAMES_MAX)
+        throw RuntimeError(line, "Stack overflow.");
+
+    // Only the VM creates non-native callables while it is running
+    Closure* closure = static_cast<Closure*>(callable);
+    frames_.push_back({closure, closure->proto_->chunk_.code_.data(), stack_.size() - argCount - 1});
+}
+
+void VM::run() {
+    CallFrame* frame = &frames_.back();
+    const uint8_t* ip = frame->ip_;
+    const Runtime::Value* constants = frame->closure_->proto_->chunk_.constants_.data();
+
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() (ip += 2, static_cast<uint16_t>((ip[-2] << 8) | ip[-1]))
+#define LOAD_FRAME()                                                 \
+    do {                                                             \
+        frame = &frames_.back();                                     \
+        ip = frame->ip_;                                             \
+        constants = frame->closure_->proto_->chunk_.constants_.data(); \
+    } while (false)
+#define RUNTIME_ERROR(msg)                          \
+    do {                                            \
+        frame->ip_ = ip;                            \
+        throw RuntimeError(currentLine(), (msg));   \
+    } while (false)
+#define IS(type, value) (value).is<type>()
+#define AS(type, value) (value).as<type>()
+#define UNSUPPORTED(symbol) RUNTIME_ERROR("Unsupported operands for '" + Runtime::toString(left) + "' " symbol " '" + Runtime::toString(right) + "'.")
+
+// Each operator accepts the same operand pairs, in the same order, as AstInterpreter::visitBinaryExpr
+#define BINARY_OP(body)                                        \
+    do {                                                       \
+        Runtime::Value& right = stack_.back();                 \
+        Runtime::Value& left = stack_[stack_.size() - 2];      \
+        body                                                   \
+        stack_.pop_back();                                     \
+    } while (false)
+#define CASE_PAIR(type, op)                                    \
+    if (IS(type, left) && IS(type, right)) {                   \
+        left = AS(type, left) op AS(type, right);              \
+    } else
+#define CASE_INT(wrapping)                                     \
+    if (IS(int64_t, left) && IS(int64_t, right)) {             \
+        left = Runtime::wrapping(AS(int64_t, left), AS(int64_t, right)); \
+    } else
+
+    while (true) {
+        switch (static_cast<OpCode>(READ_BYTE())) {
+            case OpCode::CONSTANT:
+                stack_.push_back(constants[READ_SHORT()]);
+                break;
+            case OpCode::NIL:
+                stack_.emplace_back(std::monostate());
+                break;
+            case OpCode::TRUE:
+                stack_.emplace_back(true);
+                break;
+            case OpCode::FALSE:
+                stack_.emplace_back(false);
+                break;
+            case OpCode::POP:
+                stack_.pop_back();
+                break;
+            case OpCode::POP_N:
+                stack_.resize(stack_.size() - READ_SHORT());
+                break;
+
+            case OpCode::GET_LOCAL:
+                stack_.push_back(stack_[frame->base_ + READ_SHORT()]);
+                break;
+            case OpCode::SET_LOCAL:
+                stack_[frame->base_ + READ_SHORT()] = stack_.back();
+                break;
+            case OpCode::GET_GLOBAL:
+                stack_.push_back(globals_[READ_SHORT()]);
+                break;
+            case OpCode::SET_GLOBAL:
+                globals_[READ_SHORT()] = stack_.back();
+                break;
+            case OpCode::GET_CAPTURE:
+                stack_.push_back(frame->closure_->captures_[READ_SHORT()]);
+                break;
+            case OpCode::SET_CAPTURE:
+                frame->closure_->captures_[READ_SHORT()] = stack_.back();
+                break;
+            case OpCode::GET_UNDEFINED: {
+                const std::string& name = AS(std::string, constants[READ_SHORT()]);
+                RUNTIME_ERROR("Variable '" + name + "' has not been declared or initialized.");
+            }
+            case OpCode::SET_UNDEFINED: {
+                const std::string& name = AS(std::string, constants[READ_SHORT()]);
+                RUNTIME_ERROR("Cannot assign value " + Runtime::toString(stack_.back()) + " to undefined variable '" + name + "'.");
+            }
+
+            case OpCode::ADD:
+                BINARY_OP(CASE_INT(wrappingAdd) CASE_PAIR(double, +) CASE_PAIR(std::string, +) UNSUPPORTED("+"););
+                break;
+            case OpCode::SUBTRACT:
+                BINARY_OP(CASE_INT(wrappingSubtract) CASE_PAIR(double, -) UNSUPPORTED("-"););
+                break;
+            case OpCode::MULTIPLY:
+                BINARY_OP(CASE_INT(wrappingMultiply) CASE_PAIR(double, *) UNSUPPORTED("*"););
+                break;
+            case OpCode::DIVIDE:
+                BINARY_OP(CASE_PAIR(int64_t, /) CASE_PAIR(double, /) UNSUPPORTED("/"););
+                break;
+            case OpCode::MODULO:
+                BINARY_OP(CASE_PAIR(int64_t, %) UNSUPPORTED("%"););
+                break;
+            case OpCode::SHIFT_LEFT:
+                BINARY_OP(CASE_PAIR(int64_t, <<) UNSUPPORTED("<<"););
+                break;
+            case OpCode::SHIFT_RIGHT:
+                BINARY_OP(CASE_PAIR(int64_t, >>) UNSUPPORTED(">>"););
+                break;
+            case OpCode::BIT_AND:
+                BINARY_OP(CASE_PAIR(int64_t, &) UNSUPPORTED("&"););
+                break;
+            case OpCode::BIT_OR:
+                BINARY_OP(CASE_PAIR(int64_t, |) UNSUPPORTED("|"););
+                break;
+            case OpCode::BIT_XOR:
+                BINARY_OP(CASE_PAIR(int64_t, ^) UNSUPPORTED("^"););
+                break;
+            case OpCode::LOGICAL_AND:
+                BINARY_OP(CASE_PAIR(bool, &&) UNSUPPORTED("&&"););
+                break;
+            case OpCode::LOGICAL_OR:
+                BINARY_OP(CASE_PAIR(bool, ||) UNSUPPORTED("||"););
+                break;
+            case OpCode::EQUAL:
+                BINARY_OP(CASE_PAIR(int64_t, ==) CASE_PAIR(double, ==) CASE_PAIR(std::string, ==) CASE_PAIR(char, ==) CASE_PAIR(bool, ==) CASE_PAIR(std::monostate, ==) UNSUPPORTED("=="););
+                break;
+            case OpCode::NOT_EQUAL:
+                BINARY_OP(CASE_PAIR(int64_t, !=) CASE_PAIR(double, !=) CASE_PAIR(std::string, !=) CASE_PAIR(char, !=) CASE_PAIR(bool, !=) CASE_PAIR(std::monostate, !=) UNSUPPORTED("!="););
+                break;
+            case OpCode::LESS:
+                BINARY_OP(CASE_PAIR(int64_t, <) CASE_PAIR(double, <) CASE_PAIR(std::string, <) CASE_PAIR(char, <) UNSUPPORTED("<"););
+                break;
+            case OpCode::LESS_EQUAL:
+                BINARY_OP(CASE_PAIR(int64_t, <=) CASE_PAIR(double, <=) CASE_PAIR(std::string, <=) CASE_PAIR(char, <=) UNSUPPORTED("<="););
+                break;
+            case OpCode::GREATER:
+                BINARY_OP(CASE_PAIR(int64_t, >) CASE_PAIR(double, >) CASE_PAIR(std::string, >) CASE_PAIR(char, >) UNSUPPORTED(">"););
+                break;
+            case OpCode::GREATER_EQUAL:
+                BINARY_OP(CASE_PAIR(int64_t, >=) CASE_PAIR(double, >=) CASE_PAIR(std::string, >=) CASE_PAIR(char, >=) UNSUPPORTED(">="););
+                break;
+            case OpCode::NOT: {
+                Runtime::Value& right = stack_.back();
+                if (!IS(bool, right)) RUNTIME_ERROR("Unary '!' expects 'bool'.");
+                right = !AS(bool, right);
+                break;
+            }
+            case OpCode::BIT_NOT: {
+                Runtime::Value& right = stack_.back();
+                if (!IS(int64_t, right)) RUNTIME_ERROR("Unary '~' expects 'int'.");
+                right = ~AS(int64_t, right);
+                break;
+            }
+            case OpCode::NEGATE: {
+                Runtime::Value& right = stack_.back();
+                if (IS(int64_t, right))
+                    right = Runtime::wrappingNegate(AS(int64_t, right));
+                else if (IS(double, right))
+                    right = -AS(double, right);
+                else
+                    RUNTIME_ERROR("Unary '-' expects 'int' or 'double'.");
+                break;
+            }
+
+            case OpCode::JUMP: {
+                uint16_t offset = READ_SHORT();
+                ip += offset;
+                break;
+            }
+            case OpCode::JUMP_IF_FALSE: {
+                ConditionKind kind = static_cast<ConditionKind>(READ_BYTE());
+                uint16_t offset = READ_SHORT();
+
+                const Runtime::Value& condition = stack_.back();
+                if (!IS(bool, condition)) {
+                    switch (kind) {
+                        case ConditionKind::IF: RUNTIME_ERROR("Condition of if statement must evaluate to a boolean value.");
+                        case ConditionKind::WHILE: RUNTIME_ERROR("Condition of while loop must evaluate to a boolean value.");
+                        case ConditionKind::FOR: RUNTIME_ERROR("For loop condition must evaluate to a boolean.");
+                        case ConditionKind::TERNARY: RUNTIME_ERROR("Ternary condition must be a boolean.");
+                    }
+                }
+
+                bool truthy = AS(bool, condition);
+                stack_.pop_back();
+                if (!truthy) ip += offset;
+                break;
+            }
+            case OpCode::LOOP: {
+                uint16_t offset = READ_SHORT();
+                ip -= offset;
+                break;
+            }
+
+            case OpCode::CALL: {
+                uint8_t argCount = READ_BYTE();
+                frame->ip_ = ip;
+                callValue(stack_[stack_.size() - 1 - argCount], argCount, currentLine());
+                LOAD_FRAME();
+                break;
+            }
+            case OpCode::TAIL_CALL: {
+                uint8_t argCount = READ_BYTE();
+                size_t callee = stack_.size() - 1 - argCount;
+                const Runtime::Value& value = stack_[callee];
+                if (!value.is<Runtime::Callable>() || value.as<Runtime::Callable>()->isNative() || value.as<Runtime::Callable>()->arity() != argCount) {
+                    // Natives return right away and errors are reported as for a CALL
+                    frame->ip_ = ip;
+                    callValue(value, argCount, currentLine());
+                    LOAD_FRAME();
+                    break;
+                }
+
+                // The callee and its arguments replace this frame's closure and locals
+                std::move(stack_.begin() + callee, stack_.end(), stack_.begin() + frame->base_);
+                stack_.resize(frame->base_ + 1 + argCount);
+                frame->closure_ = static_cast<Closure*>(stack_[frame->base_].as<Runtime::Callable>());
+                frame->ip_ = frame->closure_->proto_->chunk_.code_.data();
+                LOAD_FRAME();
+                break;
+            }
+            case OpCode::CLOSURE: {
+                const FunctionProto* proto = program_->functions_.at(READ_SHORT()).get();
+                // Pushed before the captures are read so the stack owns it if one of them is undefined
+                collector_.maybeCollect();
+                Closure* closure = new Closure(collector_, proto);
+                stack_.emplace_back(closure);
+                closure->captures_.reserve(proto->captureCount_);
+
+                for (size_t i = 0; i < proto->captureCount_; i++) {
+                    CaptureKind kind = static_cast<CaptureKind>(READ_BYTE());
+                    uint16_t index = READ_SHORT();
+                    switch (kind) {
+                        case CaptureKind::LOCAL: closure->captures_.push_back(stack_[frame->base_ + index]); break;
+                        case CaptureKind::GLOBAL: closure->captures_.push_back(globals_[index]); break;
+                        case CaptureKind::CAPTURE: closure->captures_.push_back(frame->closure_->captures_[index]); break;
+                        case CaptureKind::UNDEFINED:
+                            RUNTIME_ERROR("Variable '" + AS(std::string, constants[index]) + "' has not been declared or initialized.");
+                    }
+                }
+                break;
+            }
+            case OpCode::RETURN: {
+                Runtime::Value result = std::move(stack_.back());
+                size_t base = frame->base_;
+                frames_.pop_back();
+                stack_.resize(base);
+
+                if (frames_.empty()) return;
+
+                stack_.push_back(std::move(result));
+                LOAD_FRAME();
+                break;
+            }
+
+            default:
+                throw InternalCompilerError("[Internal Compiler Error]: Unknown opcode.");
+        }
+    }
+
+#undef READ_BYTE
+#undef READ_SHORT
+#undef LOAD_FRAME
+#undef RUNTIME_ERROR
+#undef IS
+#undef AS
+#undef UNSUPPORTED
+#undef BINARY_OP
+#undef CASE_PAIR
+#undef CASE_INT
+}
@@ -0,0 +1,745 @@
+#include <latimer/c_backend/c_emitter.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include <latimer/c_backend/c_runtime.hpp>
+
+namespace {
+
+bool isNative(const std::string& name) {
+    return name == "print" || name == "clock" || name == "sleep";
+}
+
+std::string quote(const std::string& name) {
+    return "\"" + name + "\"";
+}
+
+} // namespace
+
+CEmitter::CEmitter(Utils::ErrorHandler& errorHandler)
+    : errorHandler_(errorHandler)
+    , scopes_()
+    , bindings_()
+    , current_(nullptr)
+    , functions_(0)
+    , labels_(0)
+    , literals_()
+    , literalInits_()
+    , declarations_()
+    , definitions_()
+    , result_()
+    , type_() {}
+
+std::string CEmitter::emit(const std::vector<AstStatPtr>& statements) {
+    Function script{0, nullptr, nullptr, "", 1, 0, false, {}, {}, {}};
+    current_ = &script;
+
+    try {
+        scopes_.beginScope(false);
+        script.managed_.emplace_back();
+        script.scalars_.emplace_back();
+        for (const AstStatPtr& stat : statements) {
+            if (!stat) throw InternalCompilerError("[Internal Compiler Error]: nullptr statement in AST list.");
+
+            emitStat(*stat);
+        }
+        endScope();
+    } catch (Unsupported unsupported) {
+        errorHandler_.report(unsupported.line_, "", "The C backend does not support " + unsupported.what_ + ".");
+        return "";
+    } catch (InternalCompilerError error) {
+        std::cerr << error.what() << std::endl;
+        errorHandler_.hadError_ = true;
+        return "";
+    }
+
+    return std::string("/* Generated by latimer --emit-c. Build with: cc -O2 -o program program.c */\n\n")
+        + cRuntimeSource() + "\n"
+        + declarations_ + "\n"
+        + definitions_
+        + "int main(void) {\n" + literalInits_ + script.body_ + "    return 0;\n}\n";
+}
+
+void CEmitter::emitStat(AstStat& stat) {
+    stat.accept(*this);
+}
+
+std::string CEmitter::emitExpr(AstExpr& expr) {
+    expr.accept(*this);
+    return std::move(result_);
+}
+
+TypePtr CEmitter::convertType(AstType& type) {
+    type.accept(*this);
+    return std::move(type_);
+}
+
+void CEmitter::line(const std::string& code) {
+    current_->body_ += std::string(4 * current_->indent_, ' ') + code + "\n";
+}
+
+std::string CEmitter::temp(const Type& type, const std::string& init) {
+    std::string name = "t" + std::to_string(current_->temps_++);
+    line(cType(type) + " " + name + " = " + init + ";");
+    return name;
+}
+
+void CEmitter::declare(const std::string& name, const void* key, Binding binding) {
+    bindings_[key] = std::move(binding);
+    scopes_.declare(name, key);
+}
+
+const CEmitter::Binding* CEmitter::lookup(const std::string& name) const {
+    const void* key = scopes_.lookup(name);
+    return key != nullptr ? &bindings_.at(key) : nullptr;
+}
+
+const CEmitter::Binding* CEmitter::read(const std::string& name) {
+    const void* key = scopes_.lookup(name);
+    if (key == nullptr)
+        return nullptr;
+
+    Binding& binding = bindings_.at(key);
+    binding.read_ = true;
+    return &binding;
+}
+
+void CEmitter::beginScope() {
+    scopes_.beginScope(false);
+    current_->managed_.emplace_back();
+    current_->scalars_.emplace_back();
+}
+
+void CEmitter::endScope() {
+    markUnreadLocals();
+    releaseLocals(current_->managed_.size() - 1);
+    current_->managed_.pop_back();
+    scopes_.endScope();
+}
+
+// Folding can leave a local with every read replaced by its value
+void CEmitter::markUnreadLocals() {
+    for (const void* key : current_->scalars_.back()) {
+        const Binding& binding = bindings_.at(key);
+        if (!binding.read_)
+            line("(void)" + binding.lvalue_ + ";");
+    }
+    current_->scalars_.pop_back();
+}
+
+void CEmitter::emitScoped(AstStat& stat) {
+    beginScope();
+    if (AstStatBlock* block = dynamic_cast<AstStatBlock*>(&stat)) {
+        for (AstStatPtr& inner : block->body_)
+            emitStat(*inner);
+    } else {
+        emitStat(stat);
+    }
+    endScope();
+}
+
+void CEmitter::releaseLocals(size_t fromScope) {
+    for (size_t scope = current_->managed_.size(); scope-- > fromScope;) {
+        const std::vector<std::string>& locals = current_->managed_[scope];
+        for (auto it = locals.rbegin(); it != locals.rend(); ++it)
+            line("lt_release(" + *it + ");");
+    }
+}
+
+// while and for both become `for (;;)`, so the condition can take several statements to compute
+void CEmitter::emitLoop(AstStat& body, AstExpr* condition, AstExpr* increment) {
+    line("for (;;) {");
+    current_->indent_++;
+
+    if (condition != nullptr)
+        line("if (!" + emitExpr(*condition) + ") break;");
+
+    current_->loops_.push_back({current_->managed_.size(), labels_++, false});
+    emitScoped(body);
+    Loop loop = current_->loops_.back();
+    current_->loops_.pop_back();
+
+    if (loop.continued_)
+        line("lt_continue_" + std::to_string(loop.label_) + ":;");
+
+    if (increment != nullptr) {
+        std::string value = emitExpr(*increment);
+        if (managed(*increment->type_))
+            line("lt_release(" + value + ");");
+    }
+
+    current_->indent_--;
+    line("}");
+}
+
+void CEmitter::emitArguments(AstExprCall& expr, std::vector<std::string>& arguments) {
+    for (AstExprPtr& arg : expr.args_)
+        arguments.push_back(emitExpr(*arg));
+}
+
+// Natives are only ever called directly, so they compile to the runtime's helpers
+bool CEmitter::emitNativeCall(AstExprCall& expr) {
+    AstExprVariable* callee = dynamic_cast<AstExprVariable*>(expr.callee_.get());
+    if (callee == nullptr || lookup(callee->name_.lexeme_) != nullptr || !isNative(callee->name_.lexeme_))
+        return false;
+
+    const std::string& name = callee->name_.lexeme_;
+    std::vector<std::string> arguments;
+    emitArguments(expr, arguments);
+
+    if (name == "print") {
+        const PrimitiveType& argType = std::get<PrimitiveType>(expr.args_[0]->type_->type_);
+        switch (argType.type_) {
+            case PrimitiveType::Integer: line("lt_print_int(" + arguments[0] + ");"); break;
+            case PrimitiveType::Double: line("lt_print_double(" + arguments[0] + ");"); break;
+            case PrimitiveType::Boolean: line("lt_print_bool(" + arguments[0] + ");"); break;
+            case PrimitiveType::Character: line("lt_print_char(" + arguments[0] + ");"); break;
+            case PrimitiveType::String:
+                line("lt_print_string(" + arguments[0] + ");");
+                line("lt_release(" + arguments[0] + ");");
+                break;
+            default:
+                throw Unsupported{expr.line_, "printing values of type '" + argType.toString() + "'"};
+        }
+        result_ = "";
+    } else if (name == "clock") {
+        result_ = temp(*expr.type_, "lt_clock()");
+    } else {
+        line("lt_sleep(" + std::to_string(expr.line_) + ", " + arguments[0] + ");");
+        result_ = "";
+    }
+    return true;
+}
+
+std::string CEmitter::cType(const Type& type) const {
+    if (std::holds_alternative<FunctionType>(type.type_))
+        return "lt_closure*";
+    if (!std::holds_alternative<PrimitiveType>(type.type_))
+        throw Unsupported{0, "values of type '" + type.toString() + "'"};
+
+    switch (std::get<PrimitiveType>(type.type_).type_) {
+        case PrimitiveType::Integer: return "int64_t";
+        case PrimitiveType::Double: return "double";
+        case PrimitiveType::Boolean: return "bool";
+        case PrimitiveType::Character: return "char";
+        case PrimitiveType::String: return "lt_string*";
+        case PrimitiveType::Void: return "void";
+        default: throw Unsupported{0, "values of type '" + type.toString() + "'"};
+    }
+}
+
+// The C function pointer type a closure's code is cast to before it is called
+std::string CEmitter::signature(const FunctionType& type) const {
+    std::string params = "lt_closure*";
+    for (const TypePtr& param : type.paramTypes_)
+        params += ", " + cType(*param);
+    return cType(*type.returnType_) + " (*)(" + params + ")";
+}
+
+bool CEmitter::managed(const Type& type) const {
+    if (std::holds_alternative<FunctionType>(type.type_))
+        return true;
+    return std::holds_alternative<PrimitiveType>(type.type_) && std::get<PrimitiveType>(type.type_).type_ == PrimitiveType::String;
+}
+
+// A C expression for the text Runtime::toString gives the value, for runtime error messages
+std::string CEmitter::show(const Type& type, const std::string& value) const {
+    if (std::holds_alternative<FunctionType>(type.type_))
+        return "lt_show_function(" + value + ")";
+
+    switch (std::get<PrimitiveType>(type.type_).type_) {
+        case PrimitiveType::Integer: return "lt_show_int(" + value + ")";
+        case PrimitiveType::Double: return "lt_show_double(" + value + ")";
+        case PrimitiveType::Boolean: return "lt_show_bool(" + value + ")";
+        case PrimitiveType::Character: return "lt_show_char(" + value + ")";
+        case PrimitiveType::String: return "lt_show_string(" + value + ")";
+        default: throw InternalCompilerError("[Internal Compiler Error]: No C representation for type '" + type.toString() + "'.");
+    }
+}
+
+// String literals are created once at startup and kept alive by a global
+std::string CEmitter::stringLiteral(const std::string& value) {
+    auto it = literals_.find(value);
+    if (it != literals_.end())
+        return it->second;
+
+    std::string name = "lt_literal_" + std::to_string(literals_.size());
+    std::string chars;
+    for (unsigned char c : value) {
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\' && c != '?') {
+            chars += static_cast<char>(c);
+        } else {
+            char escape[8];
+            std::snprintf(escape, sizeof escape, "\\%03o", c);
+            chars += escape;
+        }
+    }
+
+    declarations_ += "static lt_string* " + name + ";\n";
+    literalInits_ += "    " + name + " = lt_string_new(\"" + chars + "\", " + std::to_string(value.size()) + ");\n";
+    literals_.emplace(value, name);
+    return name;
+}
+
+void CEmitter::visitPrimitiveType(AstTypePrimitive& type) {
+    switch (type.kind_) {
+        case AstTypePrimitive::BOOL: type_ = std::make_shared<Type>(PrimitiveType(PrimitiveType::Boolean)); break;
+        case AstTypePrimitive::INT: type_ = std::make_shared<Type>(PrimitiveType(PrimitiveType::Integer)); break;
+        case AstTypePrimitive::DOUBLE: type_ = std::make_shared<Type>(PrimitiveType(PrimitiveType::Double)); break;
+        case AstTypePrimitive::STRING: type_ = std::make_shared<Type>(PrimitiveType(PrimitiveType::String)); break;
+        case AstTypePrimitive::CHAR: type_ = std::make_shared<Type>(PrimitiveType(PrimitiveType::Character)); break;
+        case AstTypePrimitive::VOID: type_ = std::make_shared<Type>(PrimitiveType(PrimitiveType::Void)); break;
+        default: throw InternalCompilerError("[Internal Compiler Error]: Unexpected Primitive Type.");
+    }
+}
+
+void CEmitter::visitFunctionType(AstTypeFunction& type) {
+    TypePtr returnType = convertType(*type.returnType);
+    std::vector<TypePtr> paramTypes;
+    for (AstTypePtr& param : type.paramTypes)
+        paramTypes.push_back(convertType(*param));
+
+    type_ = std::make_shared<Type>(FunctionType(std::move(returnType), std::move(paramTypes)));
+}
+
+void CEmitter::visitGroupExpr(AstExprGroup& expr) {
+    result_ = emitExpr(*expr.expr_);
+}
+
+void CEmitter::visitUnaryExpr(AstExprUnary& expr) {
+    std::string right = emitExpr(*expr.right_);
+    const PrimitiveType& type = std::get<PrimitiveType>(expr.type_->type_);
+
+    switch (expr.op_.type_) {
+        case TokenType::BANG: result_ = temp(*expr.type_, "!" + right); break;
+        case TokenType::TILDE: result_ = temp(*expr.type_, "~" + right); break;
+        case TokenType::MINUS:
+            // Negation wraps like the interpreter's instead of overflowing
+            if (type.type_ == PrimitiveType::Integer)
+                result_ = temp(*expr.type_, "(int64_t)(0 - (uint64_t)" + right + ")");
+            else
+                result_ = temp(*expr.type_, "-" + right);
+            break;
+        default:
+            throw InternalCompilerError("[Internal Compiler Error]: Unexpected Unary Operator: " + expr.op_.stringifyTokenType() + ".");
+    }
+}
+
+void CEmitter::visitBinaryExpr(AstExprBinary& expr) {
+    std::string left = emitExpr(*expr.left_);
+    std::string right = emitExpr(*expr.right_);
+    const PrimitiveType::PrimitiveKind operand = std::get<PrimitiveType>(expr.left_->type_->type_).type_;
+    std::string op = expr.op_.lexeme_;
+
+    switch (expr.op_.type_) {
+        case TokenType::AMPERSAND_AMPERSAND:
+        case TokenType::PIPE_PIPE:
+            // The interpreter has no logical operators on ints yet and always fails on these
+            line("lt_error(" + std::to_string(expr.op_.line_) + ", \"Unsupported operands for '%s' " + op + " '%s'.\", "
+                + show(*expr.left_->type_, left) + ", " + show(*expr.right_->type_, right) + ");");
+            result_ = temp(*expr.type_, "0");
+            return;
+        default:
+            break;
+    }
+
+    if (operand == PrimitiveType::String) {
+        if (expr.op_.type_ == TokenType::PLUS)
+            result_ = temp(*expr.type_, "lt_concat(" + left + ", " + right + ")");
+        else if (expr.op_.type_ == TokenType::EQUAL_EQUAL)
+            result_ = temp(*expr.type_, "lt_equal(" + left + ", " + right + ")");
+        else if (expr.op_.type_ == TokenType::BANG_EQUAL)
+            result_ = temp(*expr.type_, "!lt_equal(" + left + ", " + right + ")");
+        else
+            result_ = temp(*expr.type_, "lt_compare(" + left + ", " + right + ") " + op + " 0");
+        line("lt_release(" + left + ");");
+        line("lt_release(" + right + ");");
+        return;
+    }
+
+    if (operand != PrimitiveType::Integer) {
+        result_ = temp(*expr.type_, left + " " + op + " " + right);
+        return;
+    }
+
+    // Signed overflow and oversized shifts wrap the way the interpreter's x86-64 instructions do
+    switch (expr.op_.type_) {
+        case TokenType::PLUS:
+        case TokenType::MINUS:
+        case TokenType::STAR:
+            result_ = temp(*expr.type_, "(int64_t)((uint64_t)" + left + " " + op + " (uint64_t)" + right + ")");
+            break;
+        case TokenType::SLASH:
+            result_ = temp(*expr.type_, "lt_divide(" + left + ", " + right + ")");
+            break;
+        case TokenType::PERECENT:
+            result_ = temp(*expr.type_, "lt_modulo(" + left + ", " + right + ")");
+            break;
+        case TokenType::LESS_LESS:
+            result_ = temp(*expr.type_, "(int64_t)((uint64_t)" + left + " << (" + right + " & 63))");
+            break;
+        case TokenType::GREATER_GREATER:
+            result_ = temp(*expr.type_, left + " >> (" + right + " & 63)");
+            break;
+        default:
+            result_ = temp(*expr.type_, left + " " + op + " " + right);
+            break;
+    }
+}
+
+void CEmitter::visitTernaryExpr(AstExprTernary& expr) {
+    std::string condition = emitExpr(*expr.condition_);
+    bool isVoid = cType(*expr.type_) == "void";
+
+    std::string result;
+    if (!isVoid) {
+        result = "t" + std::to_string(current_->temps_++);
+        line(cType(*expr.type_) + " " + result + ";");
+    }
+
+    // Each branch's temporary hands its reference over to the result
+    line("if (" + condition + ") {");
+    current_->indent_++;
+    std::string thenValue = emitExpr(*expr.thenBranch_);
+    if (!isVoid) line(result + " = " + thenValue + ";");
+    current_->indent_--;
+    line("} else {");
+    current_->indent_++;
+    std::string elseValue = emitExpr(*expr.elseBranch_);
+    if (!isVoid) line(result + " = " + elseValue + ";");
+    current_->indent_--;
+    line("}");
+
+    result_ = result;
+}
+
+void CEmitter::visitLiteralNullExpr(AstExprLiteralNull& expr) {
+    throw Unsupported{expr.line_, "'null' values"};
+}
+
+void CEmitter::visitLiteralBoolExpr(AstExprLiteralBool& expr) {
+    result_ = expr.value_ ? "true" : "false";
+}
+
+void CEmitter::visitLiteralIntExpr(AstExprLiteralInt& expr) {
+    // A folded INT64_MIN has no literal: the minus sign would apply to an out of range constant
+    if (expr.value_ == std::numeric_limits<int64_t>::min())
+        result_ = "INT64_MIN";
+    else
+        result_ = "INT64_C(" + std::to_string(expr.value_) + ")";
+}
+
+void CEmitter::visitLiteralDoubleExpr(AstExprLiteralDouble& expr) {
+    double value = expr.value_;
+    if (std::isnan(value)) {
+        result_ = std::signbit(value) ? "(-NAN)" : "NAN";
+    } else if (std::isinf(value)) {
+        result_ = value < 0 ? "(-HUGE_VAL)" : "HUGE_VAL";
+    } else {
+        // Hexadecimal floating point round-trips exactly
+        char buffer[64];
+        std::snprintf(buffer, sizeof buffer, "%a", value);
+        result_ = std::string("(") + buffer + ")";
+    }
+}
+
+void CEmitter::visitLiteralStringExpr(AstExprLiteralString& expr) {
+    result_ = temp(*expr.type_, "lt_retain(" + stringLiteral(expr.value_) + ")");
+}
+
+void CEmitter::visitLiteralCharExpr(AstExprLiteralChar& expr) {
+    result_ = "((char)" + std::to_string(static_cast<int>(expr.value_)) + ")";
+}
+
+void CEmitter::visitVariableExpr(AstExprVariable& expr) {
+    const std::string& name = expr.name_.lexeme_;
+    const Binding* binding = read(name);
+
+    if (binding == nullptr) {
+        if (isNative(name))
+            throw Unsupported{expr.line_, "native functions as values"};
+
+        line("lt_undefined(" + std::to_string(expr.name_.line_) + ", " + quote(name) + ");");
+        result_ = temp(*expr.type_, "0");
+        return;
+    }
+
+    // Copied into a temporary so that operands evaluated later cannot change it under us
+    if (managed(*binding->type_))
+        result_ = temp(*binding->type_, "lt_retain(" + binding->lvalue_ + ")");
+    else
+        result_ = temp(*binding->type_, binding->lvalue_);
+}
+
+void CEmitter::visitAssignmentExpr(AstExprAssignment& expr) {
+    std::string value = emitExpr(*expr.value_);
+    const Binding* binding = lookup(expr.name_.lexeme_);
+
+    if (binding == nullptr) {
+        line("lt_error(" + std::to_string(expr.name_.line_) + ", \"Cannot assign value %s to undefined variable '%s'.\", "
+            + show(*expr.value_->type_, value) + ", " + quote(expr.name_.lexeme_) + ");");
+        result_ = value;
+        return;
+    }
+
+    if (binding->self_)
+        throw Unsupported{expr.line_, "assigning to a function's own name inside its body"};
+
+    // The variable takes the temporary's reference and the assignment's value gets one of its own
+    if (managed(*binding->type_)) {
+        line("lt_retain(" + value + ");");
+        line("lt_release(" + binding->lvalue_ + ");");
+    }
+    line(binding->lvalue_ + " = " + value + ";");
+    result_ = value;
+}
+
+void CEmitter::visitCallExpr(AstExprCall& expr) {
+    if (emitNativeCall(expr))
+        return;
+
+    const FunctionType& type = std::get<FunctionType>(expr.callee_->type_->type_);
+    bool isVoid = cType(*type.returnType_) == "void";
+
+    // The function calling itself is the closure it was given, so it is called directly
+    AstExprVariable* variable = dynamic_cast<AstExprVariable*>(expr.callee_.get());
+    const Binding* binding = variable != nullptr ? lookup(variable->name_.lexeme_) : nullptr;
+    bool self = binding != nullptr && binding->self_;
+
+    std::string callee = self ? "self_" : emitExpr(*expr.callee_);
+    std::vector<std::string> arguments;
+    emitArguments(expr, arguments);
+
+    std::string call = self ? "lt_fn_" + std::to_string(current_->id_) : "((" + signature(type) + ")" + callee + "->code_)";
+    call += "(" + callee;
+    for (const std::string& argument : arguments)
+        call += ", " + argument;
+    call += ")";
+
+    if (isVoid) {
+        line(call + ";");
+        result_ = "";
+    } else {
+        result_ = temp(*type.returnType_, call);
+    }
+
+    if (!self)
+        line("lt_release(" + callee + ");");
+}
+
+void CEmitter::visitVarDeclStat(AstStatVarDecl& stat) {
+    TypePtr type = convertType(*stat.type_);
+    if (cType(*type) == "void")
+        throw Unsupported{stat.line_, "variables of type 'void'"};
+
+    std::string value = emitExpr(*stat.initializer_);
+    std::string name = "l_" + stat.name_.lexeme_;
+    line(cType(*type) + " " + name + " = " + value + ";");
+
+    if (managed(*type))
+        current_->managed_.back().push_back(name);
+    else
+        current_->scalars_.back().push_back(&stat);
+    declare(stat.name_.lexeme_, &stat, {name, type, false, false});
+}
+
+void CEmitter::visitExpressionStat(AstStatExpression& stat) {
+    std::string value = emitExpr(*stat.expr_);
+    if (managed(*stat.expr_->type_))
+        line("lt_release(" + value + ");");
+    else if (!value.empty() && dynamic_cast<AstExprAssignment*>(stat.expr_.get()) == nullptr)
+        line("(void)" + value + ";"); // A discarded result, which -Wall would flag
+}
+
+void CEmitter::visitIfElseStat(AstStatIfElse& stat) {
+    line("if (" + emitExpr(*stat.condition_) + ") {");
+    current_->indent_++;
+    emitScoped(*stat.thenBranch_);
+    current_->indent_--;
+
+    if (stat.elseBranch_ != nullptr) {
+        line("} else {");
+        current_->indent_++;
+        emitScoped(*stat.elseBranch_);
+        current_->indent_--;
+    }
+    line("}");
+}
+
+void CEmitter::visitForStat(AstStatFor& stat) {
+    line("{");
+    current_->indent_++;
+    beginScope();
+
+    if (stat.initializer_ != nullptr)
+        emitStat(*stat.initializer_);
+    emitLoop(*stat.body_, stat.condition_.get(), stat.increment_.get());
+
+    endScope();
+    current_->indent_--;
+    line("}");
+}
+
+void CEmitter::visitWhileStat(AstStatWhile& stat) {
+    emitLoop(*stat.body_, stat.condition_.get(), nullptr);
+}
+
+void CEmitter::visitBreakStat(AstStatBreak& stat) {
+    if (current_->loops_.empty())
+        throw InternalCompilerError("[Internal Compiler Error]: 'break' outside of a loop.");
+
+    releaseLocals(current_->loops_.back().scopeDepth_);
+    line("break;");
+}
+
+void CEmitter::visitContinueStat(AstStatContinue& stat) {
+    if (current_->loops_.empty())
+        throw InternalCompilerError("[Internal Compiler Error]: 'continue' outside of a loop.");
+
+    Loop& loop = current_->loops_.back();
+    loop.continued_ = true;
+    releaseLocals(loop.scopeDepth_);
+    line("goto lt_continue_" + std::to_string(loop.label_) + ";");
+}
+
+void CEmitter::visitBlockStat(AstStatBlock& stat) {
+    line("{");
+    current_->indent_++;
+    emitScoped(stat);
+    current_->indent_--;
+    line("}");
+}
+
+void CEmitter::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    std::vector<TypePtr> paramTypes;
+    for (AstTypePtr& param : stat.paramTypes_)
+        paramTypes.push_back(convertType(*param));
+    TypePtr returnType = convertType(*stat.returnType_);
+    TypePtr type = std::make_shared<Type>(FunctionType(returnType, paramTypes));
+
+    int id = ++functions_;
+    std::string suffix = std::to_string(id);
+    std::string env = "struct lt_env_" + suffix;
+
+    // Build the closure where the declaration runs, copying the captures in order. A capture the
+    // interpreter cannot find fails here, and is left out of the closure.
+    std::string closure = "t" + std::to_string(current_->temps_++);
+    line(env + "* " + closure + " = lt_alloc(sizeof(" + env + "), lt_free_env_" + suffix + ");");
+    line(closure + "->closure_.code_ = (lt_code)lt_fn_" + suffix + ";");
+
+    std::vector<const Binding*> captured;
+    std::string fields;
+    std::string releases;
+    for (size_t i = 0; i < stat.captures_.size(); i++) {
+        const std::string& name = stat.captures_[i].lexeme_;
+        const Binding* binding = read(name);
+        captured.push_back(binding);
+        if (binding == nullptr) {
+            if (!isNative(name))
+                line("lt_undefined(" + std::to_string(stat.captures_[i].line_) + ", " + quote(name) + ");");
+            continue;
+        }
+
+        std::string field = "c" + std::to_string(i) + "_" + name;
+        fields += "    " + cType(*binding->type_) + " " + field + ";\n";
+        if (managed(*binding->type_)) {
+            releases += "    lt_release(env_->" + field + ");\n";
+            line(closure + "->" + field + " = lt_retain(" + binding->lvalue_ + ");");
+        } else {
+            line(closure + "->" + field + " = " + binding->lvalue_ + ";");
+        }
+    }
+
+    std::string name = "l_" + stat.name_.lexeme_;
+    line("lt_closure* " + name + " = &" + closure + "->closure_;");
+    current_->managed_.back().push_back(name);
+    declare(stat.name_.lexeme_, &stat, {name, type, false, false});
+
+    declarations_ += env + " {\n    lt_closure closure_;\n" + fields + "};\n";
+    declarations_ += "static void lt_free_env_" + suffix + "(lt_object* object) {\n";
+    if (!releases.empty())
+        declarations_ += "    " + env + "* env_ = (" + env + "*)object;\n" + releases;
+    declarations_ += "    free(object);\n}\n";
+
+    std::string params = "lt_closure* self_";
+    for (size_t i = 0; i < stat.paramNames_.size(); i++)
+        params += ", " + cType(*paramTypes[i]) + " l_" + stat.paramNames_[i].lexeme_;
+    std::string prototype = "static " + cType(*returnType) + " lt_fn_" + suffix + "(" + params + ")";
+    declarations_ += prototype + ";\n";
+
+    // The body goes into its own C function, seeing only its closure, itself and its parameters
+    Function function{id, &stat, returnType, "", 1, 0, false, {}, {}, {}};
+    Function* enclosing = current_;
+    current_ = &function;
+
+    scopes_.beginScope(true);
+    for (size_t i = 0; i < stat.captures_.size(); i++) {
+        if (captured[i] != nullptr)
+            declare(stat.captures_[i].lexeme_, &stat.captures_[i], {"env_->c" + std::to_string(i) + "_" + stat.captures_[i].lexeme_, captured[i]->type_, false, false});
+    }
+    declare(stat.name_.lexeme_, &stat.name_, {"self_", type, true, false});
+
+    beginScope();
+    for (size_t i = 0; i < stat.paramNames_.size(); i++) {
+        std::string param = "l_" + stat.paramNames_[i].lexeme_;
+        if (managed(*paramTypes[i]))
+            function.managed_.back().push_back(param);
+        declare(stat.paramNames_[i].lexeme_, &stat.paramNames_[i], {param, paramTypes[i], false, false});
+    }
+    for (AstStatPtr& inner : body->body_)
+        emitStat(*inner);
+
+    if (cType(*returnType) == "void")
+        endScope();
+    else {
+        markUnreadLocals();
+        line("lt_no_value(" + std::to_string(stat.line_) + ", " + quote(stat.name_.lexeme_) + ");");
+        line("return 0;");
+        function.managed_.pop_back();
+        scopes_.endScope();
+    }
+    scopes_.endScope();
+    current_ = enclosing;
+
+    definitions_ += "/* " + stat.name_.lexeme_ + ", line " + std::to_string(stat.line_) + " */\n" + prototype + " {\n";
+    if (function.body_.find("env_->") != std::string::npos)
+        definitions_ += "    " + env + "* env_ = (" + env + "*)self_;\n";
+    if (function.tailCalled_)
+        definitions_ += "lt_entry:;\n";
+    definitions_ += function.body_ + "}\n\n";
+}
+
+void CEmitter::visitReturnStat(AstStatReturn& stat) {
+    bool isVoid = cType(*current_->returnType_) == "void";
+
+    // A self call in tail position rebinds the parameters and jumps back to the top
+    AstExprCall* call = dynamic_cast<AstExprCall*>(stat.value_.get());
+    AstExprVariable* callee = call != nullptr ? dynamic_cast<AstExprVariable*>(call->callee_.get()) : nullptr;
+    const Binding* binding = callee != nullptr ? lookup(callee->name_.lexeme_) : nullptr;
+    if (binding != nullptr && binding->self_) {
+        std::vector<std::string> arguments;
+        emitArguments(*call, arguments);
+        releaseLocals(0);
+        for (size_t i = 0; i < arguments.size(); i++)
+            line("l_" + current_->decl_->paramNames_[i].lexeme_ + " = " + arguments[i] + ";");
+        line("goto lt_entry;");
+        current_->tailCalled_ = true;
+        return;
+    }
+
+    if (stat.value_ == nullptr && !isVoid) {
+        line("lt_no_value(" + std::to_string(stat.line_) + ", " + quote(current_->decl_->name_.lexeme_) + ");");
+        line("return 0;");
+        return;
+    }
+
+    std::string value = stat.value_ != nullptr ? emitExpr(*stat.value_) : "";
+    releaseLocals(0);
+    line(isVoid ? "return;" : "return " + value + ";");
+}
@@ -0,0 +1,226 @@
+#include <latimer/c_backend/c_runtime.hpp>
+
+// Everything here is emitted verbatim at the top of the generated file, so it is plain C99 plus
+// POSIX for clock() and sleep(). Each helper reproduces what the AstInterpreter does for the same
+// operation, down to the error messages and the SIGFPE of an integer division by zero.
+const char* cRuntimeSource() {
+    return R"RUNTIME(#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <math.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Strings and closures are reference counted, like the interpreter's values. Every value of
+ * either kind that the generated code holds in a variable or a temporary owns one reference. */
+typedef struct lt_object {
+    size_t refs_;
+    void (*free_)(struct lt_object* object);
+} lt_object;
+
+typedef struct lt_string {
+    lt_object object_;
+    size_t length_;
+    char chars_[];
+} lt_string;
+
+typedef void (*lt_code)(void);
+
+/* A closure is a record whose first member is this header, followed by its captures. The code
+ * pointer is cast back to the function's real signature at every call. */
+typedef struct lt_closure {
+    lt_object object_;
+    lt_code code_;
+} lt_closure;
+
+static inline void* lt_alloc(size_t size, void (*free_)(lt_object* object)) {
+    lt_object* object = malloc(size);
+    if (object == NULL) {
+        fputs("Out of memory.\n", stderr);
+        exit(70);
+    }
+    object->refs_ = 1;
+    object->free_ = free_;
+    return object;
+}
+
+static inline void* lt_retain(void* object) {
+    ((lt_object*)object)->refs_++;
+    return object;
+}
+
+static inline void lt_release(void* object) {
+    lt_object* header = object;
+    if (--header->refs_ == 0)
+        header->free_(header);
+}
+
+static inline void lt_free_string(lt_object* object) {
+    free(object);
+}
+
+static inline lt_string* lt_string_new(const char* chars, size_t length) {
+    lt_string* string = lt_alloc(sizeof(lt_string) + length + 1, lt_free_string);
+    string->length_ = length;
+    memcpy(string->chars_, chars, length);
+    string->chars_[length] = '\0';
+    return string;
+}
+
+static inline lt_string* lt_concat(const lt_string* a, const lt_string* b) {
+    lt_string* string = lt_alloc(sizeof(lt_string) + a->length_ + b->length_ + 1, lt_free_string);
+    string->length_ = a->length_ + b->length_;
+    memcpy(string->chars_, a->chars_, a->length_);
+    memcpy(string->chars_ + a->length_, b->chars_, b->length_);
+    string->chars_[string->length_] = '\0';
+    return string;
+}
+
+/* Orders like std::string::compare: bytes as unsigned char, then the shorter string first */
+static inline int lt_compare(const lt_string* a, const lt_string* b) {
+    size_t length = a->length_ < b->length_ ? a->length_ : b->length_;
+    int order = memcmp(a->chars_, b->chars_, length);
+    if (order != 0)
+        return order;
+    return a->length_ < b->length_ ? -1 : a->length_ > b->length_ ? 1 : 0;
+}
+
+static inline bool lt_equal(const lt_string* a, const lt_string* b) {
+    return a->length_ == b->length_ && memcmp(a->chars_, b->chars_, a->length_) == 0;
+}
+
+/* Fixed notation with at most six decimals, keeping at least one: 2.5, 3.0, 0.333333 */
+static inline void lt_format_double(char* buffer, size_t size, double value) {
+    snprintf(buffer, size, "%.6f", value);
+    size_t length = strlen(buffer);
+    while (length > 0 && buffer[length - 1] == '0')
+        length--;
+    buffer[length] = '\0';
+    if (length > 0 && buffer[length - 1] == '.') {
+        buffer[length] = '0';
+        buffer[length + 1] = '\0';
+    }
+}
+
+static inline void lt_print_int(int64_t value) {
+    printf("%" PRId64 "\n", value);
+}
+
+static inline void lt_print_double(double value) {
+    char buffer[400];
+    lt_format_double(buffer, sizeof buffer, value);
+    puts(buffer);
+}
+
+static inline void lt_print_bool(bool value) {
+    puts(value ? "true" : "false");
+}
+
+static inline void lt_print_char(char value) {
+    putchar(value);
+    putchar('\n');
+}
+
+static inline void lt_print_string(const lt_string* value) {
+    fwrite(value->chars_, 1, value->length_, stdout);
+    putchar('\n');
+}
+
+/* Runtime errors end the program the way the interpreter reports them. The strings these build
+ * are never freed, since the program exits right after. */
+static inline void lt_error(int line, const char* format, ...) {
+    va_list args;
+    fflush(stdout);
+    fprintf(stderr, "[line %d] Runtime Error: ", line);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    exit(70);
+}
+
+static inline const char* lt_show_int(int64_t value) {
+    char* buffer = malloc(32);
+    snprintf(buffer, 32, "%" PRId64, value);
+    return buffer;
+}
+
+static inline const char* lt_show_double(double value) {
+    char* buffer = malloc(400);
+    lt_format_double(buffer, 400, value);
+    return buffer;
+}
+
+static inline const char* lt_show_bool(bool value) {
+    return value ? "true" : "false";
+}
+
+static inline const char* lt_show_char(char value) {
+    char* buffer = malloc(2);
+    buffer[0] = value;
+    buffer[1] = '\0';
+    return buffer;
+}
+
+static inline const char* lt_show_string(const lt_string* value) {
+    return value->chars_;
+}
+
+static inline const char* lt_show_function(const lt_closure* value) {
+    (void)value;
+    return "<function>";
+}
+
+static inline void lt_undefined(int line, const char* name) {
+    lt_error(line, "Variable '%s' has not been declared or initialized.", name);
+}
+
+/* A function that ends without returning a value returns null, which has no C representation */
+static inline void lt_no_value(int line, const char* name) {
+    lt_error(line, "Function '%s' returned null, which compiled code cannot represent.", name);
+}
+
+/* Integer division by zero (and INT64_MIN / -1) kills the interpreter with SIGFPE, so it does the
+ * same here, after writing out what the program printed so far */
+static inline void lt_trap(void) {
+    fflush(stdout);
+    raise(SIGFPE);
+    abort();
+}
+
+static inline int64_t lt_divide(int64_t a, int64_t b) {
+    if (b == 0 || (b == -1 && a == INT64_MIN))
+        lt_trap();
+    return a / b;
+}
+
+static inline int64_t lt_modulo(int64_t a, int64_t b) {
+    if (b == 0 || (b == -1 && a == INT64_MIN))
+        lt_trap();
+    return a % b;
+}
+
+static inline double lt_clock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (double)((int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000) / 1000.0;
+}
+
+static inline void lt_sleep(int line, double seconds) {
+    if (seconds < 0.0)
+        lt_error(line, "sleep() duration must be non-negative.");
+
+    int64_t milliseconds = (int64_t)(seconds * 1000.0);
+    struct timespec duration;
+    duration.tv_sec = milliseconds / 1000;
+    duration.tv_nsec = (long)(milliseconds % 1000) * 1000000;
+    while (nanosleep(&duration, &duration) != 0) {}
+}
+)RUNTIME";
+}
@@ -1,6 +1,9 @@
 #include "latimer/ast/ast.hpp"
 #include <latimer/interpreter/ast_interpreter.hpp>
+#include <latimer/interpreter/metrics.hpp>
 
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
 
@@ -8,92 +11,145 @@
 #include <latimer/interpreter/value.hpp>
 #include <latimer/utils/error_handler.hpp>
 #include <latimer/interpreter/native_functions.hpp>
-
-Environment::Environment()
-    : values_()
-    , declared_()
-    , enclosing_() {
-    
-    // Native functions
-    define("print", std::make_shared<NativePrint>());
-    define("clock", std::make_shared<NativeClock>());
-    define("sleep", std::make_shared<NativeSleep>());
-}
-
-Environment::Environment(EnvironmentPtr enclosing)
-    : values_()
-    , declared_()
-    , enclosing_(enclosing) {}
-
-void Environment::declare(std::string name) {
-    declared_.insert({name});
-}
-
-bool Environment::isDeclared(std::string name) {
-    return declared_.find(name) != declared_.end();
-}
-
-void Environment::define(std::string name, Runtime::Value value) {
-    values_.insert({name, value});
+#include <latimer/interpreter/int_arithmetic.hpp>
+#include <latimer/interpreter/typed_operands.hpp>
+
+AstInterpreter::AstInterpreter(Utils::ErrorHandler& errorHandler, bool jit, bool memoize, Instrumentation instrumentation)
+    : collector_()
+    , result_()
+    , completion_(Completion::NORMAL)
+    , returnValue_()
+    , errorHandler_(errorHandler)
+    , globals_(0)
+    , env_(&globals_)
+    , closure_(nullptr)
+    , stack_()
+    , tailCallee_()
+    , tailArguments_()
+    , tailCallLine_(0)
+    , frames_()
+    , closures_(0)
+    , capturedValues_(0)
+    , jit_(jit ? std::make_unique<Jit>() : nullptr)
+    , running_(nullptr)
+    , memoizer_(memoize ? std::make_unique<Memoizer>() : nullptr)
+    , profiler_(instrumentation.profiler_)
+    , sampler_(instrumentation.sampler_)
+    , tracer_(instrumentation.tracer_ != nullptr && instrumentation.tracer_->tracesCalls() ? instrumentation.tracer_ : nullptr)
+    , heap_(instrumentation.heap_)
+    , lineCounts_(instrumentation.lines_ != nullptr ? instrumentation.lines_->counts() : nullptr)
+    , tracksLines_(sampler_ != nullptr || heap_ != nullptr)
+    , globalNames_() {
+
+    // Native functions take the first global slots, matching the Resolver
+    size_t slot = 0;
+    for (auto& native : nativeFunctions()) {
+        if (profiler_ != nullptr)
+            profiler_->nameNative(native.second.as<Runtime::Callable>(), native.first);
+        globalNames_.push_back(native.first);
+        globals_.define(slot++, native.second);
+    }
 }
 
-void Environment::assign(Token name, Runtime::Value value) {
-    std::string lexeme = name.lexeme_;
-
-    if (values_.find(lexeme) != values_.end()) {
-        values_[lexeme] = value;
-        return;
+void AstInterpreter::interpret(const std::vector<AstStatPtr>& statements) {
+    if (profiler_ != nullptr)
+        profiler_->start();
+    if (sampler_ != nullptr)
+        sampler_->start();
+    if (heap_ != nullptr) {
+        // Script-level declarations are the globals after the natives
+        for (const AstStatPtr& stat : statements) {
+            size_t slot;
+            std::string name;
+            if (auto* var = dynamic_cast<const AstStatVarDecl*>(stat.get())) {
+                slot = var->slot_;
+                name = var->name_.lexeme_;
+            } else if (auto* func = dynamic_cast<const AstStatFuncDecl*>(stat.get())) {
+                slot = func->slot_;
+                name = func->name_.lexeme_;
+            } else {
+                continue;
+            }
+
+            if (globalNames_.size() <= slot)
+                globalNames_.resize(slot + 1);
+            globalNames_[slot] = name;
+        }
+        heap_->start();
     }
 
-    if (enclosing_ != nullptr) {
-        enclosing_->assign(name, value);
-        return;
-    }
+    try {
+        for (const AstStatPtr& stat : statements) {
+            if (!stat) throw InternalCompilerError("[Internal Compiler Error]: nullptr statement in AST list.");
 
-    if (isDeclared(lexeme)) {
-        define(lexeme, value);
-        return;
+            execute(*stat);
+        }
+    } catch (RuntimeError error) {
+        METRIC_COUNT(runtimeErrors_);
+        errorHandler_.runtimeError(error);
+    } catch (InternalCompilerError error) {
+        std::cerr << error.what() << std::endl;
     }
 
-    throw RuntimeError(name.line_, "Cannot assign value " + Runtime::toString(value) + " to undefined variable '" + name.lexeme_ + "'.");
+    // Calls that were unwinding leave their arguments behind
+    stack_.clear();
+
+    if (heap_ != nullptr)
+        heap_->stop();
+    if (sampler_ != nullptr)
+        sampler_->stop();
+    if (profiler_ != nullptr)
+        profiler_->stop();
 }
 
-Runtime::Value Environment::get(Token name) {
-    if (values_.find(name.lexeme_) != values_.end())
-        return values_.at(name.lexeme_);
+AstInterpreter::AllocationStats AstInterpreter::allocationStats() const {
+    return {frames_.framesPushed(), frames_.chunksAllocated(), frames_.bytesReserved(), closures_, capturedValues_};
+}
 
-    if (enclosing_ != nullptr)
-        return enclosing_->get(name);
+const Jit* AstInterpreter::jit() const {
+    return jit_.get();
+}
 
-    throw RuntimeError(name.line_, "Variable '" + name.lexeme_ + "' has not been declared or initialized.");
+const Memoizer* AstInterpreter::memoizer() const {
+    return memoizer_.get();
 }
 
-AstInterpreter::AstInterpreter(Utils::ErrorHandler& errorHandler)
-    : errorHandler_(errorHandler)
-    , globals_(std::make_shared<Environment>())
-    , env_(globals_) {}
+Runtime::Collector& AstInterpreter::collector() {
+    return collector_;
+}
 
-void AstInterpreter::interpret(const std::vector<AstStatPtr>& statements) {
-    try {
-        for (const AstStatPtr& stat : statements) {
-            if (!stat) throw InternalCompilerError("[Internal Compiler Error]: nullptr statement in AST list.");
+HeapProfiler::Roots AstInterpreter::heapRoots() const {
+    HeapProfiler::Roots roots;
+    for (size_t slot = 0; slot < globals_.size_; slot++) {
+        std::string name = slot < globalNames_.size() && !globalNames_[slot].empty() ? globalNames_[slot] : "global " + std::to_string(slot);
+        roots.push_back({name, &globals_.values_[slot]});
+    }
 
-            execute(*stat);
-        }
-    } catch (RuntimeError error) {
-        errorHandler_.runtimeError(error);
-    } catch (InternalCompilerError error) {
-        std::cerr << error.what() << std::endl;
+    // Call frames don't link to their caller's, so only the innermost call's frames are reachable
+    size_t depth = 0;
+    for (const Environment* env = env_; env != nullptr && env != &globals_; env = env->enclosing_, depth++) {
+        for (size_t slot = 0; slot < env->size_; slot++)
+            roots.push_back({"frame " + std::to_string(depth) + " slot " + std::to_string(slot), &env->values_[slot]});
     }
+
+    for (size_t i = 0; i < stack_.size(); i++)
+        roots.push_back({"stack " + std::to_string(i), &stack_[i]});
+    return roots;
 }
 
-void AstInterpreter::execute(AstStat& stat) {
+AstInterpreter::Completion AstInterpreter::execute(AstStat& stat) {
+    if (lineCounts_ != nullptr)
+        lineCounts_[stat.line_]++;
+    if (tracksLines_)
+        trackLine(stat.line_);
+    completion_ = Completion::NORMAL;
     stat.accept(*this);
+    return completion_;
 }
 
 Runtime::Value AstInterpreter::evaluate(AstExpr& expr) {
     expr.accept(*this);
-    return result_;
+    return std::move(result_);
 }
 
 void AstInterpreter::visitPrimitiveType(AstTypePrimitive& type) {
@@ -105,32 +161,38 @@ void AstInterpreter::visitFunctionType(AstTypeFunction& type) {
 }
 
 void AstInterpreter::visitGroupExpr(AstExprGroup& expr) {
+    METRIC_NODE(GROUP_EXPR);
     result_ = evaluate(*expr.expr_);
 }
 
 void AstInterpreter::visitUnaryExpr(AstExprUnary& expr) {
+    METRIC_NODE(UNARY_EXPR);
     Runtime::Value right = evaluate(*expr.right_);
+    applyUnary(expr, right);
+}
 
+void AstInterpreter::applyUnary(AstExprUnary& expr, const Runtime::Value& right) {
     switch (expr.op_.type_) {
         case TokenType::BANG:
-            if (std::holds_alternative<bool>(right))
-                result_ = !std::get<bool>(right);
+            if (right.is<bool>())
+                result_ = !right.as<bool>();
             else
                 throw RuntimeError(expr.op_.line_, "Unary '!' expects 'bool'.");
             break;
         case TokenType::TILDE:
-            if (std::holds_alternative<int64_t>(right))
-                result_ = ~std::get<int64_t>(right);
+            if (right.is<int64_t>())
+                result_ = ~right.as<int64_t>();
             else
                 throw RuntimeError(expr.op_.line_, "Unary '~' expects 'int'.");
             break;
         case TokenType::MINUS:
-            if (std::holds_alternative<int64_t>(right))
-                result_ = -std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(right))
-                result_ = -std::get<double>(right);
+            if (right.is<int64_t>())
+                result_ = Runtime::wrappingNegate(right.as<int64_t>());
+            else if (right.is<double>())
+                result_ = -right.as<double>();
             else
                 throw RuntimeError(expr.op_.line_, "Unary '-' expects 'int' or 'double'.");
+            break;
         default:
             throw InternalCompilerError("[Internal Compiler Error]: Unexpected Unary Operator: " + expr.op_.stringifyTokenType() + ".");
             break;
@@ -138,169 +200,176 @@ void AstInterpreter::visitUnaryExpr(AstExprUnary& expr) {
 }
 
 void AstInterpreter::visitBinaryExpr(AstExprBinary& expr) {
+    METRIC_NODE(BINARY_EXPR);
     Runtime::Value left = evaluate(*expr.left_);
     Runtime::Value right = evaluate(*expr.right_);
+    applyBinary(expr, left, right);
+}
 
+void AstInterpreter::applyBinary(AstExprBinary& expr, const Runtime::Value& left, const Runtime::Value& right) {
     switch (expr.op_.type_) {
         case TokenType::SLASH: // TODO: Division by Zero error
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) / std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) / std::get<double>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() / right.as<int64_t>();
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() / right.as<double>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' / '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::STAR:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) * std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) * std::get<double>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = Runtime::wrappingMultiply(left.as<int64_t>(), right.as<int64_t>());
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() * right.as<double>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' * '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::PERECENT:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) % std::get<int64_t>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() % right.as<int64_t>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' % '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::MINUS:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) - std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) - std::get<double>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = Runtime::wrappingSubtract(left.as<int64_t>(), right.as<int64_t>());
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() - right.as<double>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' - '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::PLUS:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) + std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) + std::get<double>(right);
-            else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
-                result_ = std::get<std::string>(left) + std::get<std::string>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = Runtime::wrappingAdd(left.as<int64_t>(), right.as<int64_t>());
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() + right.as<double>();
+            else if (left.is<std::string>() && right.is<std::string>()) {
+                METRIC_COUNT(stringConcats_);
+                METRIC_ADD(stringConcatBytes_, left.as<std::string>().size() + right.as<std::string>().size());
+                result_ = left.as<std::string>() + right.as<std::string>();
+            }
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' + '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::GREATER_GREATER:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) >> std::get<int64_t>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() >> right.as<int64_t>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' >> '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::LESS_LESS:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) << std::get<int64_t>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() << right.as<int64_t>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' << '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::GREATER: // TODO: Allow comparison between int and double?
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) > std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) > std::get<double>(right);
-            else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
-                result_ = std::get<std::string>(left) > std::get<std::string>(right);
-            else if (std::holds_alternative<char>(left) && std::holds_alternative<char>(right))
-                result_ = std::get<char>(left) > std::get<char>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() > right.as<int64_t>();
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() > right.as<double>();
+            else if (left.is<std::string>() && right.is<std::string>())
+                result_ = left.as<std::string>() > right.as<std::string>();
+            else if (left.is<char>() && right.is<char>())
+                result_ = left.as<char>() > right.as<char>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' > '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::GREATER_EQUAL: // TODO: Allow comparison between int and double?
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) >= std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) >= std::get<double>(right);
-            else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
-                result_ = std::get<std::string>(left) >= std::get<std::string>(right);
-            else if (std::holds_alternative<char>(left) && std::holds_alternative<char>(right))
-                result_ = std::get<char>(left) >= std::get<char>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() >= right.as<int64_t>();
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() >= right.as<double>();
+            else if (left.is<std::string>() && right.is<std::string>())
+                result_ = left.as<std::string>() >= right.as<std::string>();
+            else if (left.is<char>() && right.is<char>())
+                result_ = left.as<char>() >= right.as<char>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' >= '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::LESS: // TODO: Allow comparison between int and double?
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) < std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) < std::get<double>(right);
-            else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
-                result_ = std::get<std::string>(left) < std::get<std::string>(right);
-            else if (std::holds_alternative<char>(left) && std::holds_alternative<char>(right))
-                result_ = std::get<char>(left) < std::get<char>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() < right.as<int64_t>();
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() < right.as<double>();
+            else if (left.is<std::string>() && right.is<std::string>())
+                result_ = left.as<std::string>() < right.as<std::string>();
+            else if (left.is<char>() && right.is<char>())
+                result_ = left.as<char>() < right.as<char>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' < '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::LESS_EQUAL: // TODO: Allow comparison between int and double?
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) <= std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) <= std::get<double>(right);
-            else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
-                result_ = std::get<std::string>(left) <= std::get<std::string>(right);
-            else if (std::holds_alternative<char>(left) && std::holds_alternative<char>(right))
-                result_ = std::get<char>(left) <= std::get<char>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() <= right.as<int64_t>();
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() <= right.as<double>();
+            else if (left.is<std::string>() && right.is<std::string>())
+                result_ = left.as<std::string>() <= right.as<std::string>();
+            else if (left.is<char>() && right.is<char>())
+                result_ = left.as<char>() <= right.as<char>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' <= '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::EQUAL_EQUAL:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) == std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) == std::get<double>(right);
-            else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
-                result_ = std::get<std::string>(left) == std::get<std::string>(right);
-            else if (std::holds_alternative<char>(left) && std::holds_alternative<char>(right))
-                result_ = std::get<char>(left) == std::get<char>(right);
-            else if (std::holds_alternative<bool>(left) && std::holds_alternative<bool>(right))
-                result_ = std::get<bool>(left) == std::get<bool>(right);
-            else if (std::holds_alternative<std::monostate>(left) && std::holds_alternative<std::monostate>(right))
-                result_ = std::get<std::monostate>(left) == std::get<std::monostate>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() == right.as<int64_t>();
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() == right.as<double>();
+            else if (left.is<std::string>() && right.is<std::string>())
+                result_ = left.as<std::string>() == right.as<std::string>();
+            else if (left.is<char>() && right.is<char>())
+                result_ = left.as<char>() == right.as<char>();
+            else if (left.is<bool>() && right.is<bool>())
+                result_ = left.as<bool>() == right.as<bool>();
+            else if (left.is<std::monostate>() && right.is<std::monostate>())
+                result_ = left.as<std::monostate>() == right.as<std::monostate>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' == '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::BANG_EQUAL:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) != std::get<int64_t>(right);
-            else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
-                result_ = std::get<double>(left) != std::get<double>(right);
-            else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
-                result_ = std::get<std::string>(left) != std::get<std::string>(right);
-            else if (std::holds_alternative<char>(left) && std::holds_alternative<char>(right))
-                result_ = std::get<char>(left) != std::get<char>(right);
-            else if (std::holds_alternative<bool>(left) && std::holds_alternative<bool>(right))
-                result_ = std::get<bool>(left) != std::get<bool>(right);
-            else if (std::holds_alternative<std::monostate>(left) && std::holds_alternative<std::monostate>(right))
-                result_ = std::get<std::monostate>(left) != std::get<std::monostate>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() != right.as<int64_t>();
+            else if (left.is<double>() && right.is<double>())
+                result_ = left.as<double>() != right.as<double>();
+            else if (left.is<std::string>() && right.is<std::string>())
+                result_ = left.as<std::string>() != right.as<std::string>();
+            else if (left.is<char>() && right.is<char>())
+                result_ = left.as<char>() != right.as<char>();
+            else if (left.is<bool>() && right.is<bool>())
+                result_ = left.as<bool>() != right.as<bool>();
+            else if (left.is<std::monostate>() && right.is<std::monostate>())
+                result_ = left.as<std::monostate>() != right.as<std::monostate>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' != '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::PIPE:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) | std::get<int64_t>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() | right.as<int64_t>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' | '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::AMPERSAND:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) & std::get<int64_t>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() & right.as<int64_t>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' & '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::CARET:
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right))
-                result_ = std::get<int64_t>(left) ^ std::get<int64_t>(right);
+            if (left.is<int64_t>() && right.is<int64_t>())
+                result_ = left.as<int64_t>() ^ right.as<int64_t>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' ^ '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::PIPE_PIPE: // TODO: implement short circuiting
-            if (std::holds_alternative<bool>(left) && std::holds_alternative<bool>(right))
-                result_ = std::get<bool>(left) || std::get<bool>(right);
+            if (left.is<bool>() && right.is<bool>())
+                result_ = left.as<bool>() || right.as<bool>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' || '" + Runtime::toString(right) + "'.");
             break;
         case TokenType::AMPERSAND_AMPERSAND: // TODO: implement short circuiting
-            if (std::holds_alternative<bool>(left) && std::holds_alternative<bool>(right))
-                result_ = std::get<bool>(left) && std::get<bool>(right);
+            if (left.is<bool>() && right.is<bool>())
+                result_ = left.as<bool>() && right.as<bool>();
             else
                 throw RuntimeError(expr.op_.line_, "Unsupported operands for '" + Runtime::toString(left) + "' && '" + Runtime::toString(right) + "'.");
             break;
@@ -309,109 +378,262 @@ void AstInterpreter::visitBinaryExpr(AstExprBinary& expr) {
     }
 }
 
+// A null operand (see typed_operands.hpp) goes to the generic operator
+void AstInterpreter::visitTypedUnaryExpr(AstExprTypedUnary& expr) {
+    METRIC_NODE(TYPED_UNARY_EXPR);
+    Runtime::Value right = evaluate(*expr.right_);
+
+    if (right.type() != Runtime::operandType(expr.kind_)) {
+        applyUnary(expr, right);
+        return;
+    }
+
+    switch (expr.kind_) {
+        case AstExprTypedUnary::INT_NEGATE: result_ = Runtime::wrappingNegate(right.as<int64_t>()); break;
+        case AstExprTypedUnary::INT_BIT_NOT: result_ = ~right.as<int64_t>(); break;
+        case AstExprTypedUnary::DOUBLE_NEGATE: result_ = -right.as<double>(); break;
+        case AstExprTypedUnary::BOOL_NOT: result_ = !right.as<bool>(); break;
+    }
+}
+
+// As for unary, so `n == null` or null passed for an int keeps the generic result or error
+void AstInterpreter::visitTypedBinaryExpr(AstExprTypedBinary& expr) {
+    METRIC_NODE(TYPED_BINARY_EXPR);
+    Runtime::Value left = evaluate(*expr.left_);
+    Runtime::Value right = evaluate(*expr.right_);
+
+    Runtime::Value::Type type = Runtime::operandType(expr.kind_);
+    if (left.type() != type || right.type() != type) {
+        applyBinary(expr, left, right);
+        return;
+    }
+
+    if (expr.kind_ <= AstExprTypedBinary::INT_NOT_EQUAL) {
+        int64_t a = left.as<int64_t>();
+        int64_t b = right.as<int64_t>();
+        switch (expr.kind_) {
+            case AstExprTypedBinary::INT_ADD: result_ = Runtime::wrappingAdd(a, b); return;
+            case AstExprTypedBinary::INT_SUBTRACT: result_ = Runtime::wrappingSubtract(a, b); return;
+            case AstExprTypedBinary::INT_MULTIPLY: result_ = Runtime::wrappingMultiply(a, b); return;
+            case AstExprTypedBinary::INT_DIVIDE: result_ = a / b; return;
+            case AstExprTypedBinary::INT_MODULO: result_ = a % b; return;
+            case AstExprTypedBinary::INT_SHIFT_LEFT: result_ = a << b; return;
+            case AstExprTypedBinary::INT_SHIFT_RIGHT: result_ = a >> b; return;
+            case AstExprTypedBinary::INT_BIT_AND: result_ = a & b; return;
+            case AstExprTypedBinary::INT_BIT_OR: result_ = a | b; return;
+            case AstExprTypedBinary::INT_BIT_XOR: result_ = a ^ b; return;
+            case AstExprTypedBinary::INT_LESS: result_ = a < b; return;
+            case AstExprTypedBinary::INT_LESS_EQUAL: result_ = a <= b; return;
+            case AstExprTypedBinary::INT_GREATER: result_ = a > b; return;
+            case AstExprTypedBinary::INT_GREATER_EQUAL: result_ = a >= b; return;
+            case AstExprTypedBinary::INT_EQUAL: result_ = a == b; return;
+            case AstExprTypedBinary::INT_NOT_EQUAL: result_ = a != b; return;
+            default: break;
+        }
+    }
+
+    if (expr.kind_ <= AstExprTypedBinary::DOUBLE_NOT_EQUAL) {
+        double a = left.as<double>();
+        double b = right.as<double>();
+        switch (expr.kind_) {
+            case AstExprTypedBinary::DOUBLE_ADD: result_ = a + b; return;
+            case AstExprTypedBinary::DOUBLE_SUBTRACT: result_ = a - b; return;
+            case AstExprTypedBinary::DOUBLE_MULTIPLY: result_ = a * b; return;
+            case AstExprTypedBinary::DOUBLE_DIVIDE: result_ = a / b; return;
+            case AstExprTypedBinary::DOUBLE_LESS: result_ = a < b; return;
+            case AstExprTypedBinary::DOUBLE_LESS_EQUAL: result_ = a <= b; return;
+            case AstExprTypedBinary::DOUBLE_GREATER: result_ = a > b; return;
+            case AstExprTypedBinary::DOUBLE_GREATER_EQUAL: result_ = a >= b; return;
+            case AstExprTypedBinary::DOUBLE_EQUAL: result_ = a == b; return;
+            case AstExprTypedBinary::DOUBLE_NOT_EQUAL: result_ = a != b; return;
+            default: break;
+        }
+    }
+
+    if (expr.kind_ <= AstExprTypedBinary::CHAR_NOT_EQUAL) {
+        char a = left.as<char>();
+        char b = right.as<char>();
+        switch (expr.kind_) {
+            case AstExprTypedBinary::CHAR_LESS: result_ = a < b; return;
+            case AstExprTypedBinary::CHAR_LESS_EQUAL: result_ = a <= b; return;
+            case AstExprTypedBinary::CHAR_GREATER: result_ = a > b; return;
+            case AstExprTypedBinary::CHAR_GREATER_EQUAL: result_ = a >= b; return;
+            case AstExprTypedBinary::CHAR_EQUAL: result_ = a == b; return;
+            case AstExprTypedBinary::CHAR_NOT_EQUAL: result_ = a != b; return;
+            default: break;
+        }
+    }
+
+    if (expr.kind_ <= AstExprTypedBinary::BOOL_NOT_EQUAL) {
+        bool equal = left.as<bool>() == right.as<bool>();
+        result_ = expr.kind_ == AstExprTypedBinary::BOOL_EQUAL ? equal : !equal;
+        return;
+    }
+
+    const std::string& a = left.as<std::string>();
+    const std::string& b = right.as<std::string>();
+    switch (expr.kind_) {
+        case AstExprTypedBinary::STRING_CONCAT:
+            METRIC_COUNT(stringConcats_);
+            METRIC_ADD(stringConcatBytes_, a.size() + b.size());
+            result_ = a + b;
+            break;
+        case AstExprTypedBinary::STRING_LESS: result_ = a < b; break;
+        case AstExprTypedBinary::STRING_LESS_EQUAL: result_ = a <= b; break;
+        case AstExprTypedBinary::STRING_GREATER: result_ = a > b; break;
+        case AstExprTypedBinary::STRING_GREATER_EQUAL: result_ = a >= b; break;
+        case AstExprTypedBinary::STRING_EQUAL: result_ = a == b; break;
+        case AstExprTypedBinary::STRING_NOT_EQUAL: result_ = a != b; break;
+        default: throw InternalCompilerError("[Internal Compiler Error]: Unexpected typed binary kind.");
+    }
+}
+
 void AstInterpreter::visitTernaryExpr(AstExprTernary& expr) {
+    METRIC_NODE(TERNARY_EXPR);
     Runtime::Value cond = evaluate(*expr.condition_);
 
-    if (!std::holds_alternative<bool>(cond))
+    if (!cond.is<bool>())
         throw RuntimeError(expr.line_, "Ternary condition must be a boolean.");
 
-    result_ = std::get<bool>(cond) ? evaluate(*expr.thenBranch_) : evaluate(*expr.elseBranch_);
+    result_ = cond.as<bool>() ? evaluate(*expr.thenBranch_) : evaluate(*expr.elseBranch_);
 }
 
 void AstInterpreter::visitLiteralNullExpr(AstExprLiteralNull& expr) {
+    METRIC_NODE(LITERAL_NULL_EXPR);
     result_ = std::monostate{};
 }
 
 void AstInterpreter::visitLiteralBoolExpr(AstExprLiteralBool& expr) {
+    METRIC_NODE(LITERAL_BOOL_EXPR);
     result_ = expr.value_;
 }
 
 void AstInterpreter::visitLiteralIntExpr(AstExprLiteralInt& expr) {
+    METRIC_NODE(LITERAL_INT_EXPR);
     result_ = expr.value_;
 }
 
 void AstInterpreter::visitLiteralDoubleExpr(AstExprLiteralDouble& expr) {
+    METRIC_NODE(LITERAL_DOUBLE_EXPR);
     result_ = expr.value_;
 }
 
 void AstInterpreter::visitLiteralStringExpr(AstExprLiteralString& expr) {
+    METRIC_NODE(LITERAL_STRING_EXPR);
     result_ = expr.value_;
 }
 
 void AstInterpreter::visitLiteralCharExpr(AstExprLiteralChar& expr) {
+    METRIC_NODE(LITERAL_CHAR_EXPR);
     result_ = expr.value_;
 }
 
 void AstInterpreter::visitVariableExpr(AstExprVariable& expr) {
-    result_ = env_->get(expr.name_);
+    METRIC_NODE(VARIABLE_EXPR);
+    if (expr.slot_.depth_ == VariableSlot::UNRESOLVED)
+        throw RuntimeError(expr.name_.line_, "Variable '" + expr.name_.lexeme_ + "' has not been declared or initialized.");
+
+    result_ = lookup(expr.slot_);
+}
+
+// The temporary is only null when computing it before the loop failed
+void AstInterpreter::visitHoistedExpr(AstExprHoisted& expr) {
+    METRIC_NODE(VARIABLE_EXPR);
+    const Runtime::Value& value = lookup(expr.slot_);
+    if (value.is<std::monostate>())
+        result_ = evaluate(*expr.expr_);
+    else
+        result_ = value;
 }
 
 void AstInterpreter::visitAssignmentExpr(AstExprAssignment& expr) {
+    METRIC_NODE(ASSIGNMENT_EXPR);
     Runtime::Value value = evaluate(*expr.value_);
-    env_->assign(expr.name_, value);
+    if (expr.slot_.depth_ == VariableSlot::UNRESOLVED)
+        throw RuntimeError(expr.name_.line_, "Cannot assign value " + Runtime::toString(value) + " to undefined variable '" + expr.name_.lexeme_ + "'.");
+
+    lookup(expr.slot_) = value;
     result_ = value;
 }
 
 void AstInterpreter::visitCallExpr(AstExprCall& expr) {
+    METRIC_NODE(CALL_EXPR);
     Runtime::Value callee = evaluate(*expr.callee_);
 
-    std::vector<Runtime::Value> arguments;
+    // Arguments go on the interpreter's value stack, which keeps its capacity between calls
+    size_t base = stack_.size();
     for (const auto& argExpr : expr.args_)
-        arguments.push_back(evaluate(*argExpr));
-
-    if (!std::holds_alternative<std::shared_ptr<Runtime::Callable>>(callee))
-        throw RuntimeError(expr.line_, "Attempted to call a non-callable value.");
-
-    auto callable = std::get<std::shared_ptr<Runtime::Callable>>(callee);
-    if (callable->arity() != 255 && arguments.size() != callable->arity()) {
-        throw RuntimeError(expr.line_, "Expected " + std::to_string(callable->arity()) + " arguments but got " + std::to_string(arguments.size()) + ".");
+        stack_.push_back(evaluate(*argExpr));
+    Runtime::Arguments arguments(stack_.data() + base, expr.args_.size());
+
+    Runtime::Callable* callable = requireCallable(callee, arguments, expr.line_);
+    if (Metrics::ENABLED && callable->isNative())
+        METRIC_COUNT(nativeCalls_);
+    {
+        // User functions profile themselves in UserFunction::run, where tail calls are followed
+        Profiler::Scope profiled(profiler_ != nullptr && callable->isNative() ? profiler_ : nullptr, callable);
+        result_ = callable->call(expr.line_, *this, arguments);
     }
-
-    result_ = callable->call(expr.line_, *this, arguments);
+    stack_.resize(base);
 }
 
 void AstInterpreter::visitVarDeclStat(AstStatVarDecl& stat) {
-    std::string lexeme = stat.name_.lexeme_;
-    if (env_->isDeclared(lexeme))
-        throw RuntimeError(stat.line_, "Variable '" + lexeme + "' is already declared in this scope.");
-
-    env_->declare(lexeme);
-
+    METRIC_NODE(VAR_DECL_STAT);
     if (stat.initializer_ == nullptr)
         return;
 
+    if (stat.speculative_) {
+        // Hoisted operators have no effects, so all a failure loses is the value
+        Runtime::Value value;
+        try {
+            value = evaluate(*stat.initializer_);
+        } catch (RuntimeError) {
+        }
+        env_->define(stat.slot_, value);
+        return;
+    }
+
     Runtime::Value value = evaluate(*stat.initializer_);
-    env_->define(lexeme, value);
+    env_->define(stat.slot_, value);
 }
 
 void AstInterpreter::visitExpressionStat(AstStatExpression& stat) {
+    METRIC_NODE(EXPRESSION_STAT);
     evaluate(*stat.expr_);
 }
 
 void AstInterpreter::visitIfElseStat(AstStatIfElse& stat) {
+    METRIC_NODE(IF_ELSE_STAT);
     if (requireBool(evaluate(*stat.condition_), stat.line_, "Condition of if statement must evaluate to a boolean value.")) {
-        execute(*stat.thenBranch_);
+        completion_ = execute(*stat.thenBranch_);
         return;
     }
 
     if (stat.elseBranch_ != nullptr)
-        execute(*stat.elseBranch_);
+        completion_ = execute(*stat.elseBranch_);
 }
 
 void AstInterpreter::visitWhileStat(AstStatWhile &stat) {
+    METRIC_NODE(WHILE_STAT);
     while (requireBool(evaluate(*stat.condition_), stat.line_, "Condition of while loop must evaluate to a boolean value.")) {
-        try {
-            execute(*stat.body_);
-        } catch (const ContinueSignal&) {
-            // Skip to increment
-        } catch (const BreakSignal&) {
+        if (running_ != nullptr)
+            running_->hotness_++;
+
+        Completion completion = execute(*stat.body_);
+        if (completion == Completion::BREAK)
             break;
+        if (completion == Completion::RETURN) {
+            completion_ = completion;
+            return;
         }
     }
+
+    completion_ = Completion::NORMAL;
 }
 
 void AstInterpreter::visitForStat(AstStatFor& stat) {
-    EnvironmentGuard guard(env_, std::make_shared<Environment>(env_));
+    METRIC_NODE(FOR_STAT);
+    EnvironmentGuard guard(env_, frames_, env_, stat.localCount_);
 
     if (stat.initializer_ != nullptr)
         execute(*stat.initializer_);
@@ -423,94 +645,287 @@ void AstInterpreter::visitForStat(AstStatFor& stat) {
                 break;
         }
 
-        try {
-            execute(*stat.body_);
-        } catch (const ContinueSignal&) {
-            // Skip to increment
-        } catch (const BreakSignal&) {
+        if (running_ != nullptr)
+            running_->hotness_++;
+
+        Completion completion = execute(*stat.body_);
+        if (completion == Completion::BREAK)
             break;
+        if (completion == Completion::RETURN) {
+            completion_ = completion;
+            return;
         }
 
+        // CONTINUE falls through to the increment
         if (stat.increment_ != nullptr)
             evaluate(*stat.increment_);
     }
+
+    completion_ = Completion::NORMAL;
 }
 
 void AstInterpreter::visitBreakStat(AstStatBreak& stat) {
-    throw BreakSignal();
+    METRIC_NODE(BREAK_STAT);
+    METRIC_COUNT(breaks_);
+    completion_ = Completion::BREAK;
 }
 
 void AstInterpreter::visitContinueStat(AstStatContinue& stat) {
-    throw ContinueSignal();
+    METRIC_NODE(CONTINUE_STAT);
+    METRIC_COUNT(continues_);
+    completion_ = Completion::CONTINUE;
 }
 
 void AstInterpreter::visitBlockStat(AstStatBlock& stat) {
-    executeBlocK(stat.body_, std::make_shared<Environment>(env_));
+    METRIC_NODE(BLOCK_STAT);
+    EnvironmentGuard guard(env_, frames_, env_, stat.localCount_);
+    completion_ = executeBlocK(stat.body_);
 }
 
 void AstInterpreter::visitFuncDeclStat(AstStatFuncDecl& stat) {
-    EnvironmentPtr closure = std::make_shared<Environment>();
-    for (auto capture : stat.captures_)
-        closure->define(capture.lexeme_, env_->get(capture));
+    METRIC_NODE(FUNC_DECL_STAT);
+    // Closure layout (see AstStatFuncDecl): the captures in order, then the function itself
+    // Resolved once here rather than on every call
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    Jit::Entry* jit = jit_ != nullptr ? jit_->entryFor(&stat) : nullptr;
+    std::unique_ptr<Memoizer::Table> memo = memoizer_ != nullptr ? memoizer_->tableFor(&stat) : nullptr;
+    collector_.maybeCollect();
+    UserFunction* function = new AstInterpreter::UserFunction(collector_, &stat, body, jit, std::move(memo));
+    Runtime::Value fn(function);
+    closures_++;
+    capturedValues_ += stat.captures_.size();
+
+    for (size_t i = 0; i < stat.captures_.size(); i++) {
+        const VariableSlot& slot = stat.captureSlots_.at(i);
+        if (slot.depth_ == VariableSlot::UNRESOLVED)
+            throw RuntimeError(stat.captures_[i].line_, "Variable '" + stat.captures_[i].lexeme_ + "' has not been declared or initialized.");
+
+        function->captures_[i] = lookup(slot);
+    }
 
-    std::shared_ptr<AstInterpreter::UserFunction> fn = std::make_shared<AstInterpreter::UserFunction>(&stat, closure);
-    
-    closure->define(stat.name_.lexeme_, fn);
-    env_->define(stat.name_.lexeme_, fn);
+    function->captures_[stat.captures_.size()] = fn;
+    env_->define(stat.slot_, fn);
 }
 
 void AstInterpreter::visitReturnStat(AstStatReturn& stat) {
-    throw ReturnSignal(evaluate(*stat.value_));
+    METRIC_NODE(RETURN_STAT);
+    METRIC_COUNT(returns_);
+    if (!stat.tailCall_) {
+        returnValue_ = stat.value_ != nullptr ? evaluate(*stat.value_) : std::monostate();
+        completion_ = Completion::RETURN;
+        return;
+    }
+
+    AstExprCall& call = static_cast<AstExprCall&>(*stat.value_);
+    Runtime::Value callee = evaluate(*call.callee_);
+
+    size_t base = stack_.size();
+    for (const auto& argExpr : call.args_)
+        stack_.push_back(evaluate(*argExpr));
+    Runtime::Arguments arguments(stack_.data() + base, call.args_.size());
+
+    Runtime::Callable* callable = requireCallable(callee, arguments, call.line_);
+    if (callable->isNative()) {
+        METRIC_COUNT(nativeCalls_);
+        Profiler::Scope profiled(profiler_, callable);
+        returnValue_ = callable->call(call.line_, *this, arguments);
+        stack_.resize(base);
+        completion_ = Completion::RETURN;
+        return;
+    }
+
+    // Hand the callee back to UserFunction::call, which runs it after popping our frame
+    tailArguments_.assign(std::make_move_iterator(stack_.begin() + base), std::make_move_iterator(stack_.end()));
+    stack_.resize(base);
+    tailCallee_ = std::move(callee);
+    tailCallLine_ = call.line_;
+    completion_ = Completion::RETURN;
 }
 
-bool AstInterpreter::requireBool(const Runtime::Value& value, int line, const std::string& errorMsg) {
-    if (!std::holds_alternative<bool>(value))
+Runtime::Callable* AstInterpreter::requireCallable(const Runtime::Value& callee, Runtime::Arguments arguments, int line) {
+    if (!callee.is<Runtime::Callable>())
+        throw RuntimeError(line, "Attempted to call a non-callable value.");
+
+    Runtime::Callable* callable = callee.as<Runtime::Callable>();
+    if (callable->arity() != 255 && arguments.size() != callable->arity()) {
+        throw RuntimeError(line, "Expected " + std::to_string(callable->arity()) + " arguments but got " + std::to_string(arguments.size()) + ".");
+    }
+
+    return callable;
+}
+
+bool AstInterpreter::requireBool(const Runtime::Value& value, int line, const char* errorMsg) {
+    if (!value.is<bool>())
         throw RuntimeError(line, errorMsg);
-    return std::get<bool>(value);
+    return value.as<bool>();
 }
 
-void AstInterpreter::executeBlocK(const std::vector<AstStatPtr>& body, EnvironmentPtr localEnv) {
-    // Very Important to have this guard bc it guarantees that our environment is properly restored when execute(...) throws an error
-    // Consider this scenario in REPL:
-    // > int a = 1;
-    // > { int a = 2; some runtime error code }
-    // > print a;
-    // without the guard, prints 2 (which is incorrect); with guard, prints 1 (correct)
-    EnvironmentGuard guard(env_, localEnv);
+Runtime::Value& AstInterpreter::lookup(const VariableSlot& slot) {
+    if (slot.depth_ == VariableSlot::CAPTURE) {
+        METRIC_COUNT(captureLookups_);
+        return closure_[slot.slot_];
+    }
+    if (slot.depth_ == VariableSlot::GLOBAL) {
+        METRIC_COUNT(globalLookups_);
+        return globals_.values_[slot.slot_];
+    }
 
+    METRIC_COUNT(localLookups_);
+    return env_->ancestor(slot.depth_)->values_[slot.slot_];
+}
+
+// Arguments this interpreter set up sit on stack_ or in tailArguments_, and are dropped as soon as
+// the call is over. The callee's frame takes them over instead of counting another reference to
+// every string and function passed.
+Runtime::Value* AstInterpreter::ownedArguments(Runtime::Arguments arguments) {
+    std::less<const Runtime::Value*> before;
+    for (std::vector<Runtime::Value>* buffer : {&stack_, &tailArguments_}) {
+        const Runtime::Value* begin = buffer->data();
+        const Runtime::Value* end = begin + buffer->size();
+        if (!before(arguments.begin(), begin) && !before(end, arguments.end()) && arguments.size() != 0)
+            return buffer->data() + (arguments.begin() - begin);
+    }
+
+    return nullptr;
+}
+
+AstInterpreter::Completion AstInterpreter::executeBlocK(const std::vector<AstStatPtr>& body) {
     for (const AstStatPtr& stat : body) {
-        execute(*stat);
+        Completion completion = execute(*stat);
+        if (completion != Completion::NORMAL)
+            return completion;
     }
+
+    return Completion::NORMAL;
 }
 
-AstInterpreter::UserFunction::UserFunction(AstStatFuncDecl* decl, EnvironmentPtr closure)
-    : decl_(decl)
-    , closure_(closure) {}
+void AstInterpreter::trackLine(int line) {
+    if (sampler_ != nullptr)
+        sampler_->setLine(line);
+    if (heap_ != nullptr) {
+        heap_->setLine(line);
+        if (heap_->snapshotRequested()) {
+            std::ofstream out(heap_->takeSnapshotPath());
+            HeapProfiler::writeSnapshot(out, heapRoots());
+            out << "\n";
+        }
+    }
+}
+
+AstInterpreter::UserFunction::UserFunction(Runtime::Collector& collector, AstStatFuncDecl* decl, AstStatBlock* body, Jit::Entry* jit, std::unique_ptr<Memoizer::Table> memo)
+    : Runtime::CollectedCallable(collector)
+    , decl_(decl)
+    , body_(body)
+    , captures_(new Runtime::Value[decl->captures_.size() + 1])
+    , jit_(jit)
+    , memo_(std::move(memo)) {
+    if (HeapProfiler::active_ != nullptr)
+        HeapProfiler::active_->allocated(HeapProfiler::Category::CLOSURE, this, sizeof(UserFunction) + (decl->captures_.size() + 1) * sizeof(Runtime::Value));
+}
+
+AstInterpreter::UserFunction::~UserFunction() {
+    if (HeapProfiler::active_ != nullptr)
+        HeapProfiler::active_->freed(this);
+}
+
+Runtime::Value* AstInterpreter::UserFunction::ownedValues(size_t& count) {
+    count = decl_->captures_.size() + 1;
+    return captures_.get();
+}
 
 size_t AstInterpreter::UserFunction::arity() const {
     return decl_->paramNames_.size();
 }
 
-Runtime::Value AstInterpreter::UserFunction::call(int line, AstInterpreter& interpreter, const std::vector<Runtime::Value>& arguments) {
-    if (decl_->paramNames_.size() != arguments.size())
-        throw RuntimeError(line, "Function '" + decl_->name_.lexeme_ + "' expected " + std::to_string(decl_->paramNames_.size()) + " argument(s), but got " + std::to_string(arguments.size()) + ".");
-    
-    EnvironmentPtr localEnv = std::make_shared<Environment>(closure_);
+Runtime::Value AstInterpreter::UserFunction::call(int line, AstInterpreter& interpreter, Runtime::Arguments arguments) {
+    std::string key;
+    if (memo_ == nullptr || !Memoizer::encode(arguments, key))
+        return run(line, interpreter, arguments);
 
-    for (size_t i = 0; i < decl_->paramNames_.size(); i++)
-        localEnv->define(decl_->paramNames_.at(i).lexeme_, arguments.at(i));
+    Runtime::Value result;
+    if (interpreter.memoizer_->lookup(*memo_, key, result)) {
+        METRIC_COUNT(memoHits_);
+        return result;
+    }
+
+    // Tail calls made along the way are pure too, so whatever the loop in run() ends with is this
+    // call's result
+    result = run(line, interpreter, arguments);
+    interpreter.memoizer_->store(*memo_, std::move(key), result);
+    return result;
+}
+
+Runtime::Value AstInterpreter::UserFunction::run(int line, AstInterpreter& interpreter, Runtime::Arguments arguments) {
+    UserFunction* function = this;
+    Runtime::Value callee; // Keeps a tail-called function alive once its caller's frame is gone
+
+    // The caller's loops count towards the caller again once this call is over, and its
+    // captures are back in reach
+    struct Running {
+        Jit::Entry*& running_;
+        Jit::Entry* caller_;
+        Runtime::Value*& closure_;
+        Runtime::Value* callerClosure_;
+        ~Running() {
+            running_ = caller_;
+            closure_ = callerClosure_;
+        }
+    } running{interpreter.running_, interpreter.running_, interpreter.closure_, interpreter.closure_};
+
+    // Tail calls loop here instead of nesting, so tail recursion runs in constant native stack
+    // and reuses the same arena frame
+    for (;;) {
+        const AstStatFuncDecl* decl = function->decl_;
+        if (decl->paramNames_.size() != arguments.size())
+            throw RuntimeError(line, "Function '" + decl->name_.lexeme_ + "' expected " + std::to_string(decl->paramNames_.size()) + " argument(s), but got " + std::to_string(arguments.size()) + ".");
+
+        // Left at the end of the iteration, before a tail callee enters its node in the next one
+        Profiler::Scope profiled(interpreter.profiler_, decl);
+        SampleProfiler::Scope sampled(interpreter.sampler_, decl);
+        Tracer::Scope traced(interpreter.tracer_, decl);
+        METRIC_COUNT(userCalls_);
+
+        if (function->jit_ != nullptr) {
+            Runtime::Value result;
+            if (interpreter.jit_->call(*function->jit_, arguments, result))
+                return result;
+        }
+        interpreter.running_ = function->jit_;
+        interpreter.closure_ = function->captures_.get();
+
+        Completion completion;
+        {
+            EnvironmentGuard guard(interpreter.env_, interpreter.frames_, nullptr, decl->localCount_);
+            Runtime::Value* owned = interpreter.ownedArguments(arguments);
+            for (size_t i = 0; i < decl->paramNames_.size(); i++) {
+                if (owned != nullptr)
+                    interpreter.env_->values_[i] = std::move(owned[i]);
+                else
+                    interpreter.env_->values_[i] = arguments[i];
+            }
+
+            // The call is an expression, so the caller's statement must not see the body's completion
+            completion = interpreter.executeBlocK(function->body_->body_);
+            interpreter.completion_ = Completion::NORMAL;
+        }
 
-    AstStatBlock* bodyBlock = dynamic_cast<AstStatBlock*>(decl_->body_.get());
-    if (!bodyBlock)
-        throw RuntimeError(line, "[Internal Compiler Error]: Function body is not a block statement.");
+        if (completion != Completion::RETURN)
+            return std::monostate();
+        if (interpreter.tailCallee_.is<std::monostate>())
+            return std::move(interpreter.returnValue_);
 
-    try {
-        interpreter.executeBlocK(bodyBlock->body_, localEnv);
-    } catch (ReturnSignal returnSig) {
-        return returnSig.value_;
-    }
+        METRIC_COUNT(tailCalls_);
+        callee = std::move(interpreter.tailCallee_);
+        function = static_cast<UserFunction*>(callee.as<Runtime::Callable>());
+        line = interpreter.tailCallLine_;
 
-    return std::monostate();
+        // The next frame's parameters are copied out of tailArguments_ before anything can
+        // overwrite it, so a view over it is enough
+        arguments = Runtime::Arguments(interpreter.tailArguments_.data(), interpreter.tailArguments_.size());
+    }
 }
 
 std::string AstInterpreter::UserFunction::toString() const {
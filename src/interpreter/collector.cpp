@@ -0,0 +1,152 @@
+#include <latimer/interpreter/collector.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace Runtime {
+
+namespace {
+
+constexpr int64_t MARKED = -1;
+
+} // namespace
+
+CollectedCallable::CollectedCallable(Collector& collector)
+    : collector_(collector)
+    , previous_(nullptr)
+    , next_(nullptr)
+    , references_(0) {
+    collector_.track(this);
+}
+
+CollectedCallable::~CollectedCallable() {
+    collector_.untrack(this);
+}
+
+Collector::Collector()
+    : tracked_(nullptr)
+    , trackedCount_(0)
+    , threshold_(DEFAULT_THRESHOLD)
+    , nextCollection_(DEFAULT_THRESHOLD)
+    , stats_{0, 0, 0, 0, 0.0, 0.0} {}
+
+Collector::~Collector() {
+    // The engine's environments and stacks are gone, so whatever is still tracked only refers to
+    // itself
+    collect();
+}
+
+void Collector::setThreshold(size_t threshold) {
+    threshold_ = std::max<size_t>(threshold, 1);
+    nextCollection_ = std::max(threshold_, trackedCount_);
+}
+
+void Collector::maybeCollect() {
+    if (trackedCount_ < nextCollection_)
+        return;
+
+    collect();
+    nextCollection_ = std::max(threshold_, 2 * trackedCount_);
+}
+
+void Collector::collect() {
+    auto start = std::chrono::steady_clock::now();
+
+    // Count the references each closure gets from other tracked closures, and take them away
+    for (CollectedCallable* callable = tracked_; callable != nullptr; callable = callable->next_)
+        callable->references_ = callable->refCount_;
+
+    for (CollectedCallable* callable = tracked_; callable != nullptr; callable = callable->next_) {
+        size_t count;
+        Value* values = callable->ownedValues(count);
+        for (size_t i = 0; i < count; i++) {
+            if (CollectedCallable* child = trackedChild(values[i]))
+                child->references_--;
+        }
+    }
+
+    // What is left is referenced from outside: mark from there
+    std::vector<CollectedCallable*> pending;
+    for (CollectedCallable* callable = tracked_; callable != nullptr; callable = callable->next_) {
+        if (callable->references_ > 0) {
+            callable->references_ = MARKED;
+            pending.push_back(callable);
+        }
+    }
+
+    while (!pending.empty()) {
+        CollectedCallable* callable = pending.back();
+        pending.pop_back();
+
+        size_t count;
+        Value* values = callable->ownedValues(count);
+        for (size_t i = 0; i < count; i++) {
+            CollectedCallable* child = trackedChild(values[i]);
+            if (child != nullptr && child->references_ != MARKED) {
+                child->references_ = MARKED;
+                pending.push_back(child);
+            }
+        }
+    }
+
+    // Hold every unmarked closure while clearing their captures, so none is deleted while another
+    // one's captures are still being cleared; dropping the hold then deletes them
+    std::vector<Value> garbage;
+    for (CollectedCallable* callable = tracked_; callable != nullptr; callable = callable->next_) {
+        if (callable->references_ != MARKED)
+            garbage.emplace_back(callable);
+    }
+
+    for (Value& held : garbage) {
+        size_t count;
+        Value* values = static_cast<CollectedCallable*>(held.as<Callable>())->ownedValues(count);
+        for (size_t i = 0; i < count; i++)
+            values[i] = std::monostate();
+    }
+
+    stats_.freed_ += garbage.size();
+    garbage.clear();
+
+    double pauseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats_.collections_++;
+    stats_.totalPauseMs_ += pauseMs;
+    stats_.maxPauseMs_ = std::max(stats_.maxPauseMs_, pauseMs);
+}
+
+Collector::Stats Collector::stats() const {
+    Stats stats = stats_;
+    stats.tracked_ = trackedCount_;
+    return stats;
+}
+
+void Collector::track(CollectedCallable* callable) {
+    callable->next_ = tracked_;
+    if (tracked_ != nullptr)
+        tracked_->previous_ = callable;
+    tracked_ = callable;
+
+    trackedCount_++;
+    stats_.peakTracked_ = std::max(stats_.peakTracked_, trackedCount_);
+}
+
+void Collector::untrack(CollectedCallable* callable) {
+    if (callable->previous_ != nullptr)
+        callable->previous_->next_ = callable->next_;
+    else
+        tracked_ = callable->next_;
+    if (callable->next_ != nullptr)
+        callable->next_->previous_ = callable->previous_;
+
+    trackedCount_--;
+}
+
+CollectedCallable* Collector::trackedChild(const Value& value) const {
+    if (!value.is<Callable>())
+        return nullptr;
+
+    CollectedCallable* child = value.as<Callable>()->asCollected();
+    return child != nullptr && &child->collector_ == this ? child : nullptr;
+}
+
+} // namespace Runtime
@@ -0,0 +1,132 @@
+#include <latimer/interpreter/environment.hpp>
+#include <latimer/interpreter/heap_profiler.hpp>
+#include <latimer/interpreter/metrics.hpp>
+
+#include <new>
+
+namespace {
+
+constexpr size_t alignUp(size_t bytes) {
+    constexpr size_t align = alignof(std::max_align_t);
+    return (bytes + align - 1) & ~(align - 1);
+}
+
+} // namespace
+
+Environment::Environment(size_t slotCount)
+    : values_(nullptr)
+    , size_(slotCount)
+    , enclosing_(nullptr)
+    , storage_(slotCount) {
+    values_ = storage_.data();
+}
+
+Environment::Environment(Environment* enclosing, Runtime::Value* values, size_t slotCount)
+    : values_(values)
+    , size_(slotCount)
+    , enclosing_(enclosing)
+    , storage_() {}
+
+void Environment::define(size_t slot, Runtime::Value value) {
+    if (slot >= size_) {
+        storage_.resize(slot + 1);
+        values_ = storage_.data();
+        size_ = storage_.size();
+    }
+
+    values_[slot] = std::move(value);
+}
+
+Environment* Environment::ancestor(int depth) {
+    Environment* env = this;
+    for (int i = 0; i < depth; i++)
+        env = env->enclosing_;
+    return env;
+}
+
+FrameArena::FrameArena()
+    : chunks_()
+    , current_(0)
+    , top_(0)
+    , framesPushed_(0)
+    , chunksAllocated_(0)
+    , bytesReserved_(0) {}
+
+FrameArena::~FrameArena() = default;
+
+Environment* FrameArena::push(Environment* enclosing, size_t slotCount) {
+    Mark mark = {current_, top_};
+
+    constexpr size_t headerBytes = alignUp(sizeof(Mark)) + alignUp(sizeof(Environment));
+    std::byte* memory = allocate(headerBytes + slotCount * sizeof(Runtime::Value));
+
+    Runtime::Value* values = reinterpret_cast<Runtime::Value*>(memory + headerBytes);
+    for (size_t i = 0; i < slotCount; i++)
+        new (values + i) Runtime::Value();
+
+    new (memory) Mark(mark);
+    framesPushed_++;
+    METRIC_COUNT(framesPushed_);
+    Environment* frame = new (memory + alignUp(sizeof(Mark))) Environment(enclosing, values, slotCount);
+    if (HeapProfiler::active_ != nullptr)
+        HeapProfiler::active_->allocated(HeapProfiler::Category::FRAME, frame, headerBytes + slotCount * sizeof(Runtime::Value));
+    return frame;
+}
+
+void FrameArena::pop(Environment* frame) {
+    std::byte* memory = reinterpret_cast<std::byte*>(frame) - alignUp(sizeof(Mark));
+    Mark mark = *reinterpret_cast<Mark*>(memory);
+
+    if (HeapProfiler::active_ != nullptr)
+        HeapProfiler::active_->freed(frame);
+    for (size_t i = 0; i < frame->size_; i++)
+        frame->values_[i].~Value();
+    frame->~Environment();
+
+    current_ = mark.chunk_;
+    top_ = mark.top_;
+}
+
+size_t FrameArena::framesPushed() const {
+    return framesPushed_;
+}
+
+size_t FrameArena::chunksAllocated() const {
+    return chunksAllocated_;
+}
+
+size_t FrameArena::bytesReserved() const {
+    return bytesReserved_;
+}
+
+std::byte* FrameArena::allocate(size_t bytes) {
+    bytes = alignUp(bytes);
+
+    if (!chunks_.empty() && top_ + bytes <= chunks_[current_].size_) {
+        std::byte* memory = chunks_[current_].data_.get() + top_;
+        top_ += bytes;
+        return memory;
+    }
+
+    // Move on to the next chunk, replacing it if it is too small for this frame. Everything past
+    // the current chunk is free, so nothing live is lost.
+    size_t next = chunks_.empty() ? 0 : current_ + 1;
+    if (next == chunks_.size() || chunks_[next].size_ < bytes) {
+        size_t size = bytes > CHUNK_BYTES ? bytes : CHUNK_BYTES;
+        Chunk chunk = {std::make_unique<std::byte[]>(size), size};
+
+        if (next == chunks_.size()) {
+            chunks_.push_back(std::move(chunk));
+        } else {
+            bytesReserved_ -= chunks_[next].size_;
+            chunks_[next] = std::move(chunk);
+        }
+
+        chunksAllocated_++;
+        bytesReserved_ += size;
+    }
+
+    current_ = next;
+    top_ = bytes;
+    return chunks_[current_].data_.get();
+}
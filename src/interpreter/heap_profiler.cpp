@@ -0,0 +1,261 @@
+#include <latimer/interpreter/heap_profiler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include <latimer/interpreter/collector.hpp>
+#include <latimer/interpreter/value.hpp>
+
+namespace {
+
+constexpr size_t TOP_LINES = 15;
+constexpr size_t PREVIEW_CHARS = 40;
+
+const char* const CATEGORY_NAMES[] = {"ast", "frame", "string", "closure"};
+
+static_assert(sizeof(CATEGORY_NAMES) / sizeof(CATEGORY_NAMES[0]) == static_cast<size_t>(HeapProfiler::Category::COUNT), "a name per category");
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+                else
+                    out << c;
+        }
+    }
+    out << '"';
+}
+
+// The object a Value points to, or nullptr for immediates
+const void* objectOf(const Runtime::Value& value) {
+    if (value.is<std::string>())
+        return &value.as<std::string>();
+    if (value.is<Runtime::Callable>())
+        return value.as<Runtime::Callable>();
+    return nullptr;
+}
+
+} // namespace
+
+HeapProfiler* HeapProfiler::active_ = nullptr;
+
+HeapProfiler::HeapProfiler(std::string path)
+    : path_(std::move(path))
+    , line_(0)
+    , categories_()
+    , lines_()
+    , live_()
+    , liveBytes_(0)
+    , peakBytes_(0)
+    , snapshots_(0)
+    , snapshotRequested_(0)
+    , previous_()
+    , running_(false) {}
+
+HeapProfiler::~HeapProfiler() {
+    stop();
+}
+
+void HeapProfiler::start() {
+    if (running_ || active_ != nullptr)
+        return;
+
+    active_ = this;
+    running_ = true;
+
+    struct sigaction action = {};
+    action.sa_handler = &HeapProfiler::handle;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, &previous_);
+}
+
+void HeapProfiler::stop() {
+    if (!running_)
+        return;
+
+    sigaction(SIGUSR1, &previous_, nullptr);
+    running_ = false;
+    active_ = nullptr;
+}
+
+void HeapProfiler::handle(int) {
+    if (active_ != nullptr)
+        active_->snapshotRequested_ = 1;
+}
+
+void HeapProfiler::allocated(Category category, const void* object, size_t bytes) {
+    live_[object] = {category, line_, bytes};
+
+    Totals& totals = categories_[static_cast<size_t>(category)];
+    totals.allocations_++;
+    totals.bytes_ += bytes;
+    totals.live_ += bytes;
+    totals.peak_ = std::max(totals.peak_, totals.live_);
+
+    Totals& line = lines_[line_];
+    line.allocations_++;
+    line.bytes_ += bytes;
+    line.live_ += bytes;
+    line.peak_ = std::max(line.peak_, line.live_);
+
+    liveBytes_ += bytes;
+    peakBytes_ = std::max(peakBytes_, liveBytes_);
+}
+
+void HeapProfiler::freed(const void* object) {
+    auto found = live_.find(object);
+    if (found == live_.end())
+        return;
+
+    const Allocation& allocation = found->second;
+    categories_[static_cast<size_t>(allocation.category_)].live_ -= allocation.bytes_;
+    lines_[allocation.line_].live_ -= allocation.bytes_;
+    liveBytes_ -= allocation.bytes_;
+    live_.erase(found);
+}
+
+void HeapProfiler::allocatedUpFront(Category category, size_t bytes) {
+    Totals& totals = categories_[static_cast<size_t>(category)];
+    totals.allocations_++;
+    totals.bytes_ += bytes;
+    totals.live_ += bytes;
+    totals.peak_ = std::max(totals.peak_, totals.live_);
+
+    liveBytes_ += bytes;
+    peakBytes_ = std::max(peakBytes_, liveBytes_);
+}
+
+std::string HeapProfiler::takeSnapshotPath() {
+    snapshotRequested_ = 0;
+    return path_ + "." + std::to_string(++snapshots_);
+}
+
+void HeapProfiler::printReport(std::ostream& out) const {
+    out << "heap profile: " << liveBytes_ << " bytes live at exit, " << peakBytes_ << " peak" << std::endl;
+    out << std::left << std::setw(10) << "category" << std::right << std::setw(14) << "allocations" << std::setw(16) << "bytes"
+        << std::setw(14) << "live" << std::setw(14) << "peak" << std::endl;
+    for (size_t i = 0; i < static_cast<size_t>(Category::COUNT); i++) {
+        const Totals& totals = categories_[i];
+        out << std::left << std::setw(10) << CATEGORY_NAMES[i] << std::right << std::setw(14) << totals.allocations_ << std::setw(16) << totals.bytes_
+            << std::setw(14) << totals.live_ << std::setw(14) << totals.peak_ << std::endl;
+    }
+
+    std::vector<std::pair<int, Totals>> sorted(lines_.begin(), lines_.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.bytes_ != b.second.bytes_ ? a.second.bytes_ > b.second.bytes_ : a.first < b.first;
+    });
+    if (sorted.size() > TOP_LINES)
+        sorted.resize(TOP_LINES);
+
+    out << std::left << std::setw(10) << "line" << std::right << std::setw(14) << "allocations" << std::setw(16) << "bytes"
+        << std::setw(14) << "live" << std::setw(14) << "peak" << std::endl;
+    for (const auto& line : sorted) {
+        out << std::left << std::setw(10) << line.first << std::right << std::setw(14) << line.second.allocations_ << std::setw(16) << line.second.bytes_
+            << std::setw(14) << line.second.live_ << std::setw(14) << line.second.peak_ << std::endl;
+    }
+}
+
+void HeapProfiler::writeReport(std::ostream& out, const Roots& roots) const {
+    auto writeTotals = [&](const Totals& totals) {
+        out << "{\"allocations\": " << totals.allocations_ << ", \"bytes\": " << totals.bytes_
+            << ", \"live\": " << totals.live_ << ", \"peak\": " << totals.peak_ << "}";
+    };
+
+    out << "{\n  \"liveBytes\": " << liveBytes_ << ",\n  \"peakBytes\": " << peakBytes_ << ",\n  \"categories\": {";
+    for (size_t i = 0; i < static_cast<size_t>(Category::COUNT); i++) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << CATEGORY_NAMES[i] << "\": ";
+        writeTotals(categories_[i]);
+    }
+    out << "\n  },\n  \"lines\": {";
+
+    std::vector<std::pair<int, Totals>> sorted(lines_.begin(), lines_.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (size_t i = 0; i < sorted.size(); i++) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << sorted[i].first << "\": ";
+        writeTotals(sorted[i].second);
+    }
+    out << "\n  },\n  \"snapshot\": ";
+    writeSnapshot(out, roots);
+    out << "}\n";
+}
+
+void HeapProfiler::writeSnapshot(std::ostream& out, const Roots& roots) {
+    std::unordered_map<const void*, size_t> ids;
+    std::vector<const Runtime::Value*> pending; // A Value pointing at each object, in id order
+
+    auto writeValue = [&](const Runtime::Value& value) {
+        switch (value.type()) {
+            case Runtime::Value::Type::NIL: out << "null"; return;
+            case Runtime::Value::Type::BOOL: out << (value.as<bool>() ? "true" : "false"); return;
+            case Runtime::Value::Type::INT: out << value.as<int64_t>(); return;
+            case Runtime::Value::Type::DOUBLE:
+                // JSON has no inf or nan, so those are written as strings, spelled as print() does
+                if (std::isfinite(value.as<double>()))
+                    out << Runtime::toString(value);
+                else
+                    writeJsonString(out, Runtime::toString(value));
+                return;
+            case Runtime::Value::Type::CHAR: writeJsonString(out, Runtime::toString(value)); return;
+            case Runtime::Value::Type::STRING:
+            case Runtime::Value::Type::CALLABLE: {
+                auto inserted = ids.insert({objectOf(value), ids.size() + 1});
+                if (inserted.second)
+                    pending.push_back(&value);
+                out << "{\"ref\": " << inserted.first->second << "}";
+                return;
+            }
+        }
+    };
+
+    out << "{\n    \"roots\": [";
+    for (size_t i = 0; i < roots.size(); i++) {
+        out << (i == 0 ? "\n" : ",\n") << "      {\"name\": ";
+        writeJsonString(out, roots[i].first);
+        out << ", \"value\": ";
+        writeValue(*roots[i].second);
+        out << "}";
+    }
+    out << "\n    ],\n    \"objects\": [";
+
+    // Values reached from a closure stay alive while it is written, as nothing runs meanwhile
+    for (size_t next = 0; next < pending.size(); next++) {
+        const Runtime::Value& value = *pending[next];
+        out << (next == 0 ? "\n" : ",\n") << "      {\"id\": " << next + 1;
+
+        if (value.is<std::string>()) {
+            const std::string& text = value.as<std::string>();
+            out << ", \"type\": \"string\", \"bytes\": " << sizeof(Runtime::String) + text.capacity() << ", \"length\": " << text.size() << ", \"preview\": ";
+            writeJsonString(out, text.substr(0, PREVIEW_CHARS));
+            out << "}";
+            continue;
+        }
+
+        Runtime::Callable* callable = value.as<Runtime::Callable>();
+        Runtime::CollectedCallable* closure = callable->asCollected();
+        out << ", \"type\": \"" << (closure != nullptr ? "closure" : "native") << "\", \"name\": ";
+        writeJsonString(out, callable->toString());
+        if (closure != nullptr) {
+            size_t count;
+            Runtime::Value* values = closure->ownedValues(count);
+            out << ", \"captureBytes\": " << count * sizeof(Runtime::Value) << ", \"captures\": [";
+            for (size_t i = 0; i < count; i++) {
+                out << (i == 0 ? "" : ", ");
+                writeValue(values[i]);
+            }
+            out << "]";
+        }
+        out << "}";
+    }
+    out << "\n    ]\n  }";
+}
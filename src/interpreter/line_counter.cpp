@@ -0,0 +1,119 @@
+#include <latimer/interpreter/line_counter.hpp>
+
+#include <algorithm>
+#include <iomanip>
+
+#include <latimer/ast/ast_transformer.hpp>
+
+namespace {
+
+constexpr size_t TOP_LINES = 15;
+constexpr size_t PREVIEW_CHARS = 60;
+
+// Marks the line every statement starts on
+class StatementLines : public AstTransformer {
+public:
+    explicit StatementLines(std::vector<bool>& lines)
+        : lines_(lines) {}
+
+    void mark(std::vector<AstStatPtr>& statements) { transform(statements); }
+
+private:
+    std::vector<bool>& lines_;
+
+    void marked(const AstStat& stat) {
+        size_t line = static_cast<size_t>(std::max(stat.line_, 0));
+        if (lines_.size() <= line)
+            lines_.resize(line + 1, false);
+        lines_[line] = true;
+    }
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override { marked(stat); AstTransformer::visitVarDeclStat(stat); }
+    void visitExpressionStat(AstStatExpression& stat) override { marked(stat); AstTransformer::visitExpressionStat(stat); }
+    void visitIfElseStat(AstStatIfElse& stat) override { marked(stat); AstTransformer::visitIfElseStat(stat); }
+    void visitWhileStat(AstStatWhile& stat) override { marked(stat); AstTransformer::visitWhileStat(stat); }
+    void visitForStat(AstStatFor& stat) override { marked(stat); AstTransformer::visitForStat(stat); }
+    void visitBreakStat(AstStatBreak& stat) override { marked(stat); }
+    void visitContinueStat(AstStatContinue& stat) override { marked(stat); }
+    void visitBlockStat(AstStatBlock& stat) override { marked(stat); AstTransformer::visitBlockStat(stat); }
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override { marked(stat); AstTransformer::visitFuncDeclStat(stat); }
+    void visitReturnStat(AstStatReturn& stat) override { marked(stat); AstTransformer::visitReturnStat(stat); }
+};
+
+// Line `number` of the source without its indentation, shortened for the report
+std::string sourceLine(const std::string& source, size_t number) {
+    size_t begin = 0;
+    for (size_t line = 1; line < number && begin != std::string::npos; line++) {
+        begin = source.find('\n', begin);
+        if (begin != std::string::npos)
+            begin++;
+    }
+    if (begin == std::string::npos)
+        return "";
+
+    size_t end = source.find('\n', begin);
+    std::string text = source.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+    text.erase(0, text.find_first_not_of(" \t"));
+    if (!text.empty() && text.back() == '\r')
+        text.pop_back();
+    if (text.size() > PREVIEW_CHARS)
+        text = text.substr(0, PREVIEW_CHARS - 3) + "...";
+    return text;
+}
+
+} // namespace
+
+LineCounter::LineCounter(std::vector<AstStatPtr>& statements)
+    : counts_()
+    , executable_() {
+    StatementLines(executable_).mark(statements);
+    counts_.assign(executable_.size(), 0);
+}
+
+void LineCounter::printReport(std::ostream& out, const std::string& source) const {
+    uint64_t total = 0;
+    size_t executable = 0;
+    size_t hit = 0;
+    std::vector<std::pair<size_t, uint64_t>> sorted;
+    for (size_t line = 0; line < counts_.size(); line++) {
+        total += counts_[line];
+        if (executable_[line]) {
+            executable++;
+            if (counts_[line] != 0)
+                hit++;
+        }
+        if (counts_[line] != 0)
+            sorted.push_back({line, counts_[line]});
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if (sorted.size() > TOP_LINES)
+        sorted.resize(TOP_LINES);
+
+    out << "line counts: " << total << " statements executed" << std::endl;
+    out << std::left << std::setw(10) << "line" << std::right << std::setw(16) << "count" << std::setw(9) << "%" << "  source" << std::endl;
+    for (const auto& line : sorted) {
+        double percent = total == 0 ? 0.0 : 100.0 * static_cast<double>(line.second) / static_cast<double>(total);
+        out << std::left << std::setw(10) << line.first << std::right << std::setw(16) << line.second
+            << std::setw(8) << std::fixed << std::setprecision(2) << percent << "%  " << sourceLine(source, line.first) << std::endl;
+    }
+    out << "lines executed: " << hit << " of " << executable << std::endl;
+}
+
+void LineCounter::writeLcov(std::ostream& out, const std::string& path) const {
+    size_t executable = 0;
+    size_t hit = 0;
+
+    out << "TN:\nSF:" << path << "\n";
+    for (size_t line = 1; line < counts_.size(); line++) {
+        if (!executable_[line])
+            continue;
+        executable++;
+        if (counts_[line] != 0)
+            hit++;
+        out << "DA:" << line << "," << counts_[line] << "\n";
+    }
+    out << "LF:" << executable << "\nLH:" << hit << "\nend_of_record\n";
+}
@@ -0,0 +1,91 @@
+#include <latimer/interpreter/memoizer.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+template <typename T>
+void append(std::string& key, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    key.append(bytes, sizeof(T));
+}
+
+} // namespace
+
+std::unique_ptr<Memoizer::Table> Memoizer::tableFor(const AstStatFuncDecl* decl) {
+    if (!decl->pure_)
+        return nullptr;
+
+    Entry& entry = entries_.insert({decl, {decl, 0, 0, 0, 0}}).first->second;
+    entry.tables_++;
+
+    auto table = std::make_unique<Table>();
+    table->entry_ = &entry;
+    return table;
+}
+
+bool Memoizer::encode(Runtime::Arguments arguments, std::string& key) {
+    key.clear();
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const Runtime::Value& argument = arguments[i];
+        key.push_back(static_cast<char>(argument.type()));
+
+        // Doubles compare by their bits, so 0.0 and -0.0 (which print differently) never share a result
+        switch (argument.type()) {
+            case Runtime::Value::Type::NIL: break;
+            case Runtime::Value::Type::BOOL: key.push_back(argument.as<bool>() ? 1 : 0); break;
+            case Runtime::Value::Type::INT: append(key, argument.as<int64_t>()); break;
+            case Runtime::Value::Type::DOUBLE: append(key, argument.as<double>()); break;
+            case Runtime::Value::Type::CHAR: key.push_back(argument.as<char>()); break;
+            case Runtime::Value::Type::STRING: {
+                const std::string& value = argument.as<std::string>();
+                append(key, value.size());
+                key += value;
+                break;
+            }
+            case Runtime::Value::Type::CALLABLE: return false;
+        }
+    }
+
+    return true;
+}
+
+bool Memoizer::lookup(Table& table, const std::string& key, Runtime::Value& result) {
+    auto found = table.results_.find(key);
+    if (found == table.results_.end()) {
+        table.entry_->misses_++;
+        return false;
+    }
+
+    table.entry_->hits_++;
+    result = found->second;
+    return true;
+}
+
+void Memoizer::store(Table& table, std::string key, const Runtime::Value& result) {
+    // A cached closure would be shared by every caller, along with whatever it assigns
+    if (result.is<Runtime::Callable>())
+        return;
+
+    if (table.results_.size() >= TABLE_CAPACITY) {
+        table.results_.clear();
+        table.entry_->flushes_++;
+    }
+
+    table.results_.emplace(std::move(key), result);
+}
+
+std::vector<const Memoizer::Entry*> Memoizer::entries() const {
+    std::vector<const Entry*> called;
+    for (const auto& entry : entries_) {
+        if (entry.second.hits_ + entry.second.misses_ != 0)
+            called.push_back(&entry.second);
+    }
+
+    std::sort(called.begin(), called.end(), [](const Entry* a, const Entry* b) {
+        return a->decl_->line_ < b->decl_->line_;
+    });
+    return called;
+}
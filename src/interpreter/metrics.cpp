@@ -0,0 +1,56 @@
+#include <latimer/interpreter/metrics.hpp>
+
+namespace {
+
+const char* const NODE_NAMES[] = {
+    "GroupExpr",
+    "UnaryExpr",
+    "BinaryExpr",
+    "TypedUnaryExpr",
+    "TypedBinaryExpr",
+    "TernaryExpr",
+    "LiteralNullExpr",
+    "LiteralBoolExpr",
+    "LiteralIntExpr",
+    "LiteralDoubleExpr",
+    "LiteralStringExpr",
+    "LiteralCharExpr",
+    "VariableExpr",
+    "AssignmentExpr",
+    "CallExpr",
+    "VarDeclStat",
+    "ExpressionStat",
+    "IfElseStat",
+    "WhileStat",
+    "ForStat",
+    "BreakStat",
+    "ContinueStat",
+    "BlockStat",
+    "FuncDeclStat",
+    "ReturnStat",
+};
+
+static_assert(sizeof(NODE_NAMES) / sizeof(NODE_NAMES[0]) == static_cast<size_t>(Metrics::Node::COUNT), "a name per node kind");
+
+} // namespace
+
+Metrics::Counters Metrics::counters_ = {};
+
+void Metrics::writeJson(std::ostream& out) {
+    const Counters& c = counters_;
+
+    uint64_t evaluated = 0;
+    out << "{\n  \"nodes\": {";
+    for (size_t i = 0; i < static_cast<size_t>(Node::COUNT); i++) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << NODE_NAMES[i] << "\": " << c.nodes_[i];
+        evaluated += c.nodes_[i];
+    }
+    out << "\n  },\n";
+    out << "  \"nodesEvaluated\": " << evaluated << ",\n";
+    out << "  \"calls\": {\"user\": " << c.userCalls_ << ", \"tail\": " << c.tailCalls_ << ", \"native\": " << c.nativeCalls_ << ", \"memoHits\": " << c.memoHits_ << "},\n";
+    out << "  \"framesPushed\": " << c.framesPushed_ << ",\n";
+    out << "  \"lookups\": {\"local\": " << c.localLookups_ << ", \"global\": " << c.globalLookups_ << ", \"capture\": " << c.captureLookups_ << "},\n";
+    out << "  \"stringConcats\": {\"count\": " << c.stringConcats_ << ", \"bytes\": " << c.stringConcatBytes_ << "},\n";
+    out << "  \"controlFlow\": {\"break\": " << c.breaks_ << ", \"continue\": " << c.continues_ << ", \"return\": " << c.returns_ << ", \"runtimeError\": " << c.runtimeErrors_ << "}\n";
+    out << "}\n";
+}
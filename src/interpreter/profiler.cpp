@@ -0,0 +1,159 @@
+#include <latimer/interpreter/profiler.hpp>
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+double milliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+Profiler::Profiler()
+    : nodes_()
+    , stack_()
+    , natives_() {
+    nodes_.push_back({nullptr, nullptr, 0, {}, 1, Clock::duration::zero(), Clock::duration::zero()});
+}
+
+void Profiler::nameNative(const Runtime::Callable* native, std::string name) {
+    natives_[native] = std::move(name);
+}
+
+void Profiler::start() {
+    stack_.clear();
+    stack_.push_back({0, Clock::now()});
+}
+
+void Profiler::stop() {
+    while (!stack_.empty())
+        exit();
+}
+
+void Profiler::enter(const AstStatFuncDecl* function) {
+    enterNode(function, function, nullptr);
+}
+
+void Profiler::enter(const Runtime::Callable* native) {
+    enterNode(native, nullptr, native);
+}
+
+void Profiler::enterNode(const void* key, const AstStatFuncDecl* function, const Runtime::Callable* native) {
+    size_t parent = stack_.back().first;
+
+    size_t node = 0;
+    for (const auto& child : nodes_[parent].children_) {
+        if (child.first == key) {
+            node = child.second;
+            break;
+        }
+    }
+
+    if (node == 0) {
+        node = nodes_.size();
+        nodes_.push_back({function, native, parent, {}, 0, Clock::duration::zero(), Clock::duration::zero()});
+        nodes_[parent].children_.push_back({key, node});
+    }
+
+    nodes_[node].calls_++;
+    stack_.push_back({node, Clock::now()});
+}
+
+void Profiler::exit() {
+    auto [node, entered] = stack_.back();
+    stack_.pop_back();
+
+    Clock::duration elapsed = Clock::now() - entered;
+    nodes_[node].inclusive_ += elapsed;
+    if (node != 0)
+        nodes_[nodes_[node].parent_].childTime_ += elapsed;
+}
+
+void Profiler::printTable(std::ostream& out) const {
+    struct Total {
+        std::string label_;
+        uint64_t calls_;
+        Clock::duration inclusive_;
+        Clock::duration exclusive_;
+    };
+
+    // Depth-first over the tree, counting how often each function is already on the path so that
+    // only its outermost calls add to its inclusive time
+    std::unordered_map<const void*, Total> totals;
+    std::unordered_map<const void*, size_t> onPath;
+    std::vector<std::pair<size_t, bool>> pending = {{0, false}}; // Node, leaving
+    while (!pending.empty()) {
+        auto [index, leaving] = pending.back();
+        pending.pop_back();
+
+        const Node& node = nodes_[index];
+        const void* key = node.function_ != nullptr ? static_cast<const void*>(node.function_) : node.native_;
+        if (leaving) {
+            onPath[key]--;
+            continue;
+        }
+
+        Total& total = totals.insert({key, {label(node), 0, Clock::duration::zero(), Clock::duration::zero()}}).first->second;
+        total.calls_ += node.calls_;
+        total.exclusive_ += node.inclusive_ - node.childTime_;
+        if (onPath[key]++ == 0)
+            total.inclusive_ += node.inclusive_;
+
+        pending.push_back({index, true});
+        for (const auto& child : node.children_)
+            pending.push_back({child.second, false});
+    }
+
+    std::vector<const Total*> sorted;
+    for (const auto& total : totals)
+        sorted.push_back(&total.second);
+    std::sort(sorted.begin(), sorted.end(), [](const Total* a, const Total* b) {
+        return a->exclusive_ > b->exclusive_;
+    });
+
+    double overall = std::max(milliseconds(nodes_[0].inclusive_), 1e-9);
+    out << "profile: " << std::fixed << std::setprecision(3) << milliseconds(nodes_[0].inclusive_) << " ms wall time" << std::endl;
+    out << std::setw(12) << "calls" << std::setw(16) << "inclusive ms" << std::setw(9) << "%"
+        << std::setw(16) << "exclusive ms" << std::setw(9) << "%" << "  function" << std::endl;
+    for (const Total* total : sorted) {
+        double inclusive = milliseconds(total->inclusive_);
+        double exclusive = milliseconds(total->exclusive_);
+        out << std::setw(12) << total->calls_
+            << std::setw(16) << std::setprecision(3) << inclusive << std::setw(8) << std::setprecision(1) << 100.0 * inclusive / overall << "%"
+            << std::setw(16) << std::setprecision(3) << exclusive << std::setw(8) << std::setprecision(1) << 100.0 * exclusive / overall << "%"
+            << "  " << total->label_ << std::endl;
+    }
+    out << std::defaultfloat;
+}
+
+void Profiler::writeCollapsed(std::ostream& out) const {
+    for (size_t index = 0; index < nodes_.size(); index++) {
+        const Node& node = nodes_[index];
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(node.inclusive_ - node.childTime_).count();
+        if (micros <= 0)
+            continue;
+
+        writePath(out, index);
+        out << " " << micros << "\n";
+    }
+}
+
+std::string Profiler::label(const Node& node) const {
+    if (node.function_ != nullptr)
+        return node.function_->name_.lexeme_ + ":" + std::to_string(node.function_->line_);
+    if (node.native_ != nullptr) {
+        auto found = natives_.find(node.native_);
+        return found != natives_.end() ? found->second : node.native_->toString();
+    }
+    return "<script>";
+}
+
+void Profiler::writePath(std::ostream& out, size_t node) const {
+    if (node != 0) {
+        writePath(out, nodes_[node].parent_);
+        out << ";";
+    }
+    out << label(nodes_[node]);
+}
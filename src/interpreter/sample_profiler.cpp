@@ -0,0 +1,184 @@
+#include <latimer/interpreter/sample_profiler.hpp>
+
+#include <time.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr size_t TOP_LINES = 15;
+
+std::string label(const AstStatFuncDecl* function) {
+    if (function == nullptr)
+        return "<script>";
+    return function->name_.lexeme_ + ":" + std::to_string(function->line_);
+}
+
+} // namespace
+
+SampleProfiler* SampleProfiler::active_ = nullptr;
+
+SampleProfiler::SampleProfiler(unsigned hz)
+    : hz_(std::max(hz, 1u))
+    , frames_()
+    , depth_(0)
+    , line_(0)
+    , buffer_(new uintptr_t[BUFFER_WORDS]) // Left uninitialized, so untouched pages cost nothing
+    , used_(0)
+    , samples_(0)
+    , dropped_(0)
+    , previous_()
+    , timer_()
+    , running_(false) {}
+
+SampleProfiler::~SampleProfiler() {
+    stop();
+}
+
+void SampleProfiler::start() {
+    if (running_ || active_ != nullptr)
+        return;
+
+    active_ = this;
+    running_ = true;
+
+    struct sigaction action = {};
+    action.sa_handler = &SampleProfiler::handle;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &previous_);
+
+    // A monotonic timer rather than a CPU-time one, whose expiry the kernel only checks every
+    // scheduler tick, which would cap the rate well below 1 kHz
+    struct sigevent event = {};
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIGPROF;
+    timer_create(CLOCK_MONOTONIC, &event, &timer_);
+
+    long interval = std::max(1000000000L / static_cast<long>(hz_), 1L);
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = interval / 1000000000;
+    spec.it_interval.tv_nsec = interval % 1000000000;
+    spec.it_value = spec.it_interval;
+    timer_settime(timer_, 0, &spec, nullptr);
+}
+
+void SampleProfiler::stop() {
+    if (!running_)
+        return;
+
+    timer_delete(timer_);
+    sigaction(SIGPROF, &previous_, nullptr);
+
+    running_ = false;
+    active_ = nullptr;
+}
+
+void SampleProfiler::handle(int) {
+    if (active_ != nullptr)
+        active_->record();
+}
+
+// Runs in the signal handler: no allocation, only copies out of the shadow stack
+void SampleProfiler::record() {
+    size_t depth = std::min(static_cast<size_t>(depth_), MAX_DEPTH);
+    size_t used = used_;
+    if (used + 2 + depth > BUFFER_WORDS) {
+        dropped_ = dropped_ + 1;
+        return;
+    }
+
+    buffer_[used] = static_cast<uintptr_t>(line_);
+    buffer_[used + 1] = depth;
+    for (size_t i = 0; i < depth; i++)
+        buffer_[used + 2 + i] = reinterpret_cast<uintptr_t>(frames_[i].function_);
+
+    used_ = used + 2 + depth;
+    samples_ = samples_ + 1;
+}
+
+template <typename Visit>
+void SampleProfiler::forEachSample(Visit visit) const {
+    for (size_t at = 0; at < used_;) {
+        int line = static_cast<int>(buffer_[at]);
+        size_t depth = buffer_[at + 1];
+        const AstStatFuncDecl* const* frames = reinterpret_cast<const AstStatFuncDecl* const*>(&buffer_[at + 2]);
+        visit(line, frames, depth);
+        at += 2 + depth;
+    }
+}
+
+void SampleProfiler::printReport(std::ostream& out) const {
+    struct Counts {
+        size_t self_;
+        size_t total_;
+        size_t lastSample_; // Counts a recursive function's total once per sample
+    };
+
+    std::unordered_map<const AstStatFuncDecl*, Counts> functions;
+    std::unordered_map<int, size_t> lines;
+    size_t sample = 0;
+    forEachSample([&](int line, const AstStatFuncDecl* const* frames, size_t depth) {
+        sample++;
+        lines[line]++;
+
+        const AstStatFuncDecl* top = depth == 0 ? nullptr : frames[depth - 1];
+        functions.insert({top, {0, 0, 0}}).first->second.self_++;
+
+        Counts& script = functions.insert({nullptr, {0, 0, 0}}).first->second;
+        script.total_++;
+        for (size_t i = 0; i < depth; i++) {
+            Counts& counts = functions.insert({frames[i], {0, 0, 0}}).first->second;
+            if (counts.lastSample_ != sample) {
+                counts.lastSample_ = sample;
+                counts.total_++;
+            }
+        }
+    });
+
+    double overall = std::max<double>(static_cast<double>(samples_), 1.0);
+    out << "sample profile: " << samples_ << " samples at " << hz_ << " Hz (" << dropped_ << " dropped)" << std::endl;
+
+    std::vector<std::pair<const AstStatFuncDecl*, Counts>> sortedFunctions(functions.begin(), functions.end());
+    std::sort(sortedFunctions.begin(), sortedFunctions.end(), [](const auto& a, const auto& b) {
+        return a.second.self_ != b.second.self_ ? a.second.self_ > b.second.self_ : a.second.total_ > b.second.total_;
+    });
+
+    out << std::fixed << std::setprecision(1);
+    out << std::setw(12) << "self" << std::setw(9) << "%" << std::setw(12) << "total" << std::setw(9) << "%" << "  function" << std::endl;
+    for (const auto& function : sortedFunctions) {
+        out << std::setw(12) << function.second.self_ << std::setw(8) << 100.0 * function.second.self_ / overall << "%"
+            << std::setw(12) << function.second.total_ << std::setw(8) << 100.0 * function.second.total_ / overall << "%"
+            << "  " << label(function.first) << std::endl;
+    }
+
+    std::vector<std::pair<int, size_t>> sortedLines(lines.begin(), lines.end());
+    std::sort(sortedLines.begin(), sortedLines.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if (sortedLines.size() > TOP_LINES)
+        sortedLines.resize(TOP_LINES);
+
+    out << std::setw(12) << "samples" << std::setw(9) << "%" << "  line" << std::endl;
+    for (const auto& line : sortedLines)
+        out << std::setw(12) << line.second << std::setw(8) << 100.0 * line.second / overall << "%  " << line.first << std::endl;
+    out << std::defaultfloat;
+}
+
+void SampleProfiler::writeCollapsed(std::ostream& out) const {
+    std::map<std::string, size_t> stacks;
+    forEachSample([&](int, const AstStatFuncDecl* const* frames, size_t depth) {
+        std::string stack = label(nullptr);
+        for (size_t i = 0; i < depth; i++)
+            stack += ";" + label(frames[i]);
+        stacks[stack]++;
+    });
+
+    for (const auto& stack : stacks)
+        out << stack.first << " " << stack.second << "\n";
+}
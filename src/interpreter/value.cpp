@@ -0,0 +1,18 @@
+#include <latimer/interpreter/value.hpp>
+
+#include <latimer/interpreter/heap_profiler.hpp>
+
+namespace Runtime {
+
+String::String(std::string value)
+    : value_(std::move(value)) {
+    if (HeapProfiler::active_ != nullptr)
+        HeapProfiler::active_->allocated(HeapProfiler::Category::STRING, this, sizeof(String) + value_.capacity());
+}
+
+String::~String() {
+    if (HeapProfiler::active_ != nullptr)
+        HeapProfiler::active_->freed(this);
+}
+
+} // namespace Runtime
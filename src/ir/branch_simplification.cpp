@@ -0,0 +1,188 @@
+#include <latimer/ir/passes.hpp>
+
+#include <algorithm>
+
+using Ir::BlockId;
+using Ir::Op;
+using Ir::ValueId;
+
+namespace {
+
+void killBlock(Ir::Function& function, BlockId block) {
+    Ir::Block& dead = function.blocks_[block];
+    for (ValueId id : dead.instructions_) {
+        function.values_[id].dead_ = true;
+        function.values_[id].operands_.clear();
+    }
+    dead.instructions_.clear();
+    dead.predecessors_.clear();
+    dead.dead_ = true;
+}
+
+bool hasPhis(const Ir::Function& function, BlockId block) {
+    const std::vector<ValueId>& instructions = function.blocks_[block].instructions_;
+    return !instructions.empty() && function.values_[instructions.front()].op_ == Op::PHI;
+}
+
+// Whether a condition always holds a bool: null passes as a bool to the Checker, and still has to
+// fail the branch at runtime
+bool alwaysBool(const Ir::Instruction& condition) {
+    switch (condition.op_) {
+        case Op::CONSTANT: return condition.constant_.is<bool>();
+        case Op::UNARY:
+        case Op::BINARY:
+        case Op::GENERIC_UNARY:
+        case Op::GENERIC_BINARY:
+            return condition.type_ == Ir::Type::BOOL;
+        default:
+            return false;
+    }
+}
+
+size_t foldBranches(Ir::Function& function) {
+    size_t changes = 0;
+    for (BlockId block = 0; block < function.blocks_.size(); block++) {
+        if (function.blocks_[block].dead_)
+            continue;
+
+        Ir::Instruction& terminator = function.terminator(block);
+        if (terminator.op_ != Op::BRANCH)
+            continue;
+
+        const Ir::Instruction& condition = function.values_[terminator.operands_[0]];
+        if (!alwaysBool(condition))
+            continue;
+
+        BlockId kept;
+        if (condition.op_ == Op::CONSTANT)
+            kept = terminator.targets_[condition.constant_.as<bool>() ? 0 : 1];
+        else if (terminator.targets_[0] == terminator.targets_[1])
+            kept = terminator.targets_[0];
+        else
+            continue;
+
+        BlockId dropped = terminator.targets_[0] == kept ? terminator.targets_[1] : terminator.targets_[0];
+        function.removePredecessor(dropped, block);
+        terminator.op_ = Op::JUMP;
+        terminator.operands_.clear();
+        terminator.targets_ = {kept};
+        changes++;
+    }
+    return changes;
+}
+
+size_t removeUnreachable(Ir::Function& function) {
+    std::vector<bool> reachable(function.blocks_.size(), false);
+    std::vector<BlockId> worklist{0};
+    reachable[0] = true;
+    while (!worklist.empty()) {
+        BlockId block = worklist.back();
+        worklist.pop_back();
+        for (BlockId successor : function.successors(block)) {
+            if (!reachable[successor]) {
+                reachable[successor] = true;
+                worklist.push_back(successor);
+            }
+        }
+    }
+
+    size_t changes = 0;
+    for (BlockId block = 0; block < function.blocks_.size(); block++) {
+        if (function.blocks_[block].dead_ || reachable[block])
+            continue;
+
+        for (BlockId successor : function.successors(block)) {
+            if (reachable[successor])
+                function.removePredecessor(successor, block);
+        }
+        killBlock(function, block);
+        changes++;
+    }
+    return changes;
+}
+
+size_t mergeBlocks(Ir::Function& function) {
+    size_t changes = 0;
+    for (BlockId block = 0; block < function.blocks_.size(); block++) {
+        while (!function.blocks_[block].dead_) {
+            ValueId jump = function.blocks_[block].instructions_.back();
+            if (function.values_[jump].op_ != Op::JUMP)
+                break;
+
+            BlockId successor = function.values_[jump].targets_[0];
+            if (successor == block || successor == 0 || function.blocks_[successor].predecessors_.size() != 1)
+                break;
+
+            // A phi with one predecessor is just its operand
+            std::vector<ValueId> moved;
+            for (ValueId id : function.blocks_[successor].instructions_) {
+                Ir::Instruction& instruction = function.values_[id];
+                if (instruction.op_ == Op::PHI) {
+                    function.replaceAllUses(id, instruction.operands_[0]);
+                    instruction.dead_ = true;
+                    instruction.operands_.clear();
+                    continue;
+                }
+                instruction.block_ = block;
+                moved.push_back(id);
+            }
+
+            function.kill(jump);
+            std::vector<ValueId>& instructions = function.blocks_[block].instructions_;
+            instructions.insert(instructions.end(), moved.begin(), moved.end());
+
+            for (BlockId next : function.successors(block)) {
+                std::vector<BlockId>& preds = function.blocks_[next].predecessors_;
+                std::replace(preds.begin(), preds.end(), successor, block);
+            }
+
+            Ir::Block& merged = function.blocks_[successor];
+            merged.instructions_.clear();
+            merged.predecessors_.clear();
+            merged.dead_ = true;
+            changes++;
+        }
+    }
+    return changes;
+}
+
+// A block that only jumps on to a block without phis can be skipped by its predecessors
+size_t threadJumps(Ir::Function& function) {
+    size_t changes = 0;
+    for (BlockId block = 1; block < function.blocks_.size(); block++) {
+        Ir::Block& empty = function.blocks_[block];
+        if (empty.dead_ || empty.instructions_.size() != 1)
+            continue;
+
+        const Ir::Instruction& jump = function.values_[empty.instructions_[0]];
+        BlockId target = jump.targets_.empty() ? block : jump.targets_[0];
+        if (jump.op_ != Op::JUMP || target == block || hasPhis(function, target))
+            continue;
+        if (std::find(empty.predecessors_.begin(), empty.predecessors_.end(), block) != empty.predecessors_.end())
+            continue;
+
+        for (BlockId pred : empty.predecessors_) {
+            for (BlockId& successor : function.terminator(pred).targets_) {
+                if (successor == block) {
+                    successor = target;
+                    function.blocks_[target].predecessors_.push_back(pred);
+                }
+            }
+        }
+
+        function.removePredecessor(target, block);
+        killBlock(function, block);
+        changes++;
+    }
+    return changes;
+}
+
+} // namespace
+
+size_t BranchSimplification::run(Ir::Function& function) {
+    size_t changes = foldBranches(function);
+    changes += removeUnreachable(function);
+    changes += mergeBlocks(function);
+    changes += threadJumps(function);
+    return changes;
+}
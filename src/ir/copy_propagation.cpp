@@ -0,0 +1,45 @@
+#include <latimer/ir/passes.hpp>
+
+using Ir::Op;
+using Ir::ValueId;
+
+size_t CopyPropagation::run(Ir::Function& function) {
+    static constexpr ValueId NONE = static_cast<ValueId>(-1);
+
+    size_t changes = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (ValueId id = 0; id < function.values_.size(); id++) {
+            const Ir::Instruction& instruction = function.values_[id];
+            if (instruction.dead_)
+                continue;
+
+            ValueId replacement = NONE;
+            if (instruction.op_ == Op::COPY) {
+                replacement = instruction.operands_[0];
+            } else if (instruction.op_ == Op::PHI) {
+                // Trivial when it merges a single value, apart from itself around a loop
+                for (ValueId operand : instruction.operands_) {
+                    if (operand == id || operand == replacement)
+                        continue;
+                    if (replacement != NONE) {
+                        replacement = NONE;
+                        break;
+                    }
+                    replacement = operand;
+                }
+            }
+
+            if (replacement == NONE)
+                continue;
+
+            function.replaceAllUses(id, replacement);
+            function.kill(id);
+            changes++;
+            changed = true;
+        }
+    }
+
+    return changes;
+}
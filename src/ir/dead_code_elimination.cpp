@@ -0,0 +1,37 @@
+#include <latimer/ir/passes.hpp>
+
+using Ir::ValueId;
+
+size_t DeadCodeElimination::run(Ir::Function& function) {
+    // Everything an effect (or a possible runtime error) depends on is live
+    std::vector<bool> live(function.values_.size(), false);
+    std::vector<ValueId> worklist;
+    for (ValueId id = 0; id < function.values_.size(); id++) {
+        const Ir::Instruction& instruction = function.values_[id];
+        if (!instruction.dead_ && !instruction.isPure()) {
+            live[id] = true;
+            worklist.push_back(id);
+        }
+    }
+
+    while (!worklist.empty()) {
+        ValueId id = worklist.back();
+        worklist.pop_back();
+        for (ValueId operand : function.values_[id].operands_) {
+            if (!live[operand]) {
+                live[operand] = true;
+                worklist.push_back(operand);
+            }
+        }
+    }
+
+    size_t changes = 0;
+    for (ValueId id = 0; id < function.values_.size(); id++) {
+        if (!function.values_[id].dead_ && !live[id]) {
+            function.kill(id);
+            changes++;
+        }
+    }
+
+    return changes;
+}
@@ -0,0 +1,71 @@
+#include <latimer/ir/dominators.hpp>
+
+#include <algorithm>
+#include <utility>
+
+DominatorTree::DominatorTree(const Ir::Function& function)
+    : order_()
+    , position_(function.blocks_.size(), NONE)
+    , idom_(function.blocks_.size(), NONE)
+    , children_(function.blocks_.size()) {
+
+    // Postorder with an explicit stack, deep loop nests would otherwise recurse deeply
+    std::vector<bool> visited(function.blocks_.size(), false);
+    std::vector<std::pair<Ir::BlockId, size_t>> stack{{0, 0}};
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        std::vector<Ir::BlockId> successors = function.successors(block);
+        if (next < successors.size()) {
+            Ir::BlockId successor = successors[next++];
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.push_back({successor, 0});
+            }
+            continue;
+        }
+
+        order_.push_back(block);
+        stack.pop_back();
+    }
+    std::reverse(order_.begin(), order_.end());
+    for (size_t i = 0; i < order_.size(); i++)
+        position_[order_[i]] = i;
+
+    idom_[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < order_.size(); i++) {
+            Ir::BlockId block = order_[i];
+            Ir::BlockId idom = NONE;
+            for (Ir::BlockId pred : function.blocks_[block].predecessors_) {
+                if (!reachable(pred) || idom_[pred] == NONE)
+                    continue;
+                idom = idom == NONE ? pred : intersect(pred, idom);
+            }
+
+            if (idom != idom_[block]) {
+                idom_[block] = idom;
+                changed = true;
+            }
+        }
+    }
+
+    for (size_t i = 1; i < order_.size(); i++)
+        children_[idom_[order_[i]]].push_back(order_[i]);
+}
+
+bool DominatorTree::reachable(Ir::BlockId block) const {
+    return position_[block] != NONE;
+}
+
+Ir::BlockId DominatorTree::intersect(Ir::BlockId a, Ir::BlockId b) const {
+    while (a != b) {
+        while (position_[a] > position_[b])
+            a = idom_[a];
+        while (position_[b] > position_[a])
+            b = idom_[b];
+    }
+    return a;
+}
@@ -0,0 +1,181 @@
+#include <latimer/ir/passes.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/ir/dominators.hpp>
+#include <latimer/optimizer/constant_folder.hpp>
+
+using Ir::Op;
+using Ir::ValueId;
+
+namespace {
+
+// Operators whose operands can be swapped without changing what they compute
+bool commutative(const Ir::Instruction& instruction) {
+    if (instruction.op_ != Op::BINARY)
+        return false;
+
+    switch (instruction.index_) {
+        case AstExprTypedBinary::INT_ADD:
+        case AstExprTypedBinary::INT_MULTIPLY:
+        case AstExprTypedBinary::INT_BIT_AND:
+        case AstExprTypedBinary::INT_BIT_OR:
+        case AstExprTypedBinary::INT_BIT_XOR:
+        case AstExprTypedBinary::INT_EQUAL:
+        case AstExprTypedBinary::INT_NOT_EQUAL:
+        case AstExprTypedBinary::CHAR_EQUAL:
+        case AstExprTypedBinary::CHAR_NOT_EQUAL:
+        case AstExprTypedBinary::BOOL_EQUAL:
+        case AstExprTypedBinary::BOOL_NOT_EQUAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Doubles by bit pattern, so 0.0 and -0.0 (or two NaNs) never share a number
+std::string constantKey(const Runtime::Value& value) {
+    std::string key(1, static_cast<char>('0' + static_cast<int>(value.type())));
+    switch (value.type()) {
+        case Runtime::Value::Type::NIL: break;
+        case Runtime::Value::Type::BOOL: key += value.as<bool>() ? '1' : '0'; break;
+        case Runtime::Value::Type::INT: key += std::to_string(value.as<int64_t>()); break;
+        case Runtime::Value::Type::DOUBLE: {
+            uint64_t bits;
+            double number = value.as<double>();
+            std::memcpy(&bits, &number, sizeof(bits));
+            key += std::to_string(bits);
+            break;
+        }
+        case Runtime::Value::Type::CHAR: key += value.as<char>(); break;
+        case Runtime::Value::Type::STRING: key += value.as<std::string>(); break;
+        case Runtime::Value::Type::CALLABLE: key += std::to_string(reinterpret_cast<uintptr_t>(value.as<Runtime::Callable>())); break;
+    }
+    return key;
+}
+
+// Rewrites an operator over constants into the constant it computes
+bool fold(Ir::Function& function, Ir::Instruction& instruction) {
+    Runtime::Value result;
+    switch (instruction.op_) {
+        case Op::UNARY:
+        case Op::GENERIC_UNARY: {
+            const Ir::Instruction& right = function.values_[instruction.operands_[0]];
+            if (right.op_ != Op::CONSTANT || !ConstantFolder::foldUnary(instruction.token_, right.constant_, result))
+                return false;
+            break;
+        }
+        case Op::BINARY:
+        case Op::GENERIC_BINARY: {
+            const Ir::Instruction& left = function.values_[instruction.operands_[0]];
+            const Ir::Instruction& right = function.values_[instruction.operands_[1]];
+            if (left.op_ != Op::CONSTANT || right.op_ != Op::CONSTANT || !ConstantFolder::foldBinary(left.constant_, instruction.token_, right.constant_, result))
+                return false;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    instruction.op_ = Op::CONSTANT;
+    instruction.constant_ = result;
+    instruction.operands_.clear();
+    return true;
+}
+
+// What makes two instructions compute the same value, or "" if the instruction is never shared
+std::string valueKey(const Ir::Instruction& instruction) {
+    switch (instruction.op_) {
+        case Op::CONSTANT:
+        case Op::UNARY:
+        case Op::BINARY:
+        case Op::GENERIC_UNARY:
+        case Op::GENERIC_BINARY:
+        case Op::NATIVE:
+        case Op::PHI:
+            break;
+        default:
+            return "";
+    }
+
+    std::string key = std::to_string(static_cast<int>(instruction.op_)) + ":" + std::to_string(static_cast<int>(instruction.type_))
+        + ":" + std::to_string(instruction.index_) + ":" + std::to_string(static_cast<int>(instruction.token_));
+
+    if (instruction.op_ == Op::CONSTANT)
+        return key + ":" + constantKey(instruction.constant_);
+    if (instruction.op_ == Op::NATIVE)
+        return key + ":" + instruction.text_;
+
+    // Phis only agree when they merge the same values at the same join
+    if (instruction.op_ == Op::PHI)
+        key += "@" + std::to_string(instruction.block_);
+
+    std::vector<ValueId> operands = instruction.operands_;
+    if (commutative(instruction))
+        std::sort(operands.begin(), operands.end());
+    for (ValueId operand : operands)
+        key += "," + std::to_string(operand);
+    return key;
+}
+
+} // namespace
+
+size_t GlobalValueNumbering::run(Ir::Function& function) {
+    DominatorTree tree(function);
+    std::unordered_map<std::string, ValueId> available;
+    size_t changes = 0;
+
+    // Walk the dominator tree; what a block computes is available to the blocks it dominates and
+    // is forgotten on the way back up
+    struct Visit {
+        Ir::BlockId block_;
+        bool leaving_;
+        std::vector<std::string> added_;
+    };
+    std::vector<Visit> stack{{0, false, {}}};
+    while (!stack.empty()) {
+        if (stack.back().leaving_) {
+            for (const std::string& key : stack.back().added_)
+                available.erase(key);
+            stack.pop_back();
+            continue;
+        }
+
+        stack.back().leaving_ = true;
+        Ir::BlockId block = stack.back().block_;
+        std::vector<std::string> added;
+
+        std::vector<ValueId> instructions = function.blocks_[block].instructions_;
+        for (ValueId id : instructions) {
+            Ir::Instruction& instruction = function.values_[id];
+            if (fold(function, instruction))
+                changes++;
+
+            std::string key = valueKey(instruction);
+            if (key.empty())
+                continue;
+
+            auto found = available.find(key);
+            if (found == available.end()) {
+                available.emplace(key, id);
+                added.push_back(std::move(key));
+                continue;
+            }
+
+            function.replaceAllUses(id, found->second);
+            function.kill(id);
+            changes++;
+        }
+
+        stack.back().added_ = std::move(added);
+        for (Ir::BlockId child : tree.children(block))
+            stack.push_back({child, false, {}});
+    }
+
+    return changes;
+}
@@ -0,0 +1,97 @@
+#include <latimer/ir/ir.hpp>
+
+#include <algorithm>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+namespace Ir {
+
+bool Instruction::isTerminator() const {
+    return op_ >= Op::JUMP;
+}
+
+bool Instruction::isPure() const {
+    switch (op_) {
+        case Op::CONSTANT:
+        case Op::PARAMETER:
+        case Op::PHI:
+        case Op::COPY:
+        case Op::NATIVE:
+        case Op::SELF:
+        case Op::LOAD_CAPTURE:
+        case Op::CLOSURE:
+            return true;
+        // UNARY and BINARY fall back to the generic operators, and fail with them, on a null operand
+        default:
+            return false;
+    }
+}
+
+const Instruction& Function::terminator(BlockId block) const {
+    return values_[blocks_[block].instructions_.back()];
+}
+
+Instruction& Function::terminator(BlockId block) {
+    return values_[blocks_[block].instructions_.back()];
+}
+
+std::vector<BlockId> Function::successors(BlockId block) const {
+    const std::vector<ValueId>& instructions = blocks_[block].instructions_;
+    if (instructions.empty() || !values_[instructions.back()].isTerminator())
+        return {};
+
+    return values_[instructions.back()].targets_;
+}
+
+void Function::removePredecessor(BlockId block, BlockId pred) {
+    std::vector<BlockId>& preds = blocks_[block].predecessors_;
+    auto found = std::find(preds.begin(), preds.end(), pred);
+    if (found == preds.end())
+        throw InternalCompilerError("[Internal Compiler Error]: IR edge to remove does not exist.");
+
+    size_t index = found - preds.begin();
+    preds.erase(found);
+    for (ValueId id : blocks_[block].instructions_) {
+        Instruction& phi = values_[id];
+        if (phi.op_ != Op::PHI)
+            break;
+        phi.operands_.erase(phi.operands_.begin() + index);
+    }
+}
+
+void Function::replaceAllUses(ValueId from, ValueId to) {
+    for (Instruction& instruction : values_) {
+        if (instruction.dead_)
+            continue;
+        for (ValueId& operand : instruction.operands_) {
+            if (operand == from)
+                operand = to;
+        }
+    }
+}
+
+void Function::kill(ValueId value) {
+    Instruction& instruction = values_[value];
+    instruction.dead_ = true;
+    instruction.operands_.clear();
+
+    std::vector<ValueId>& instructions = blocks_[instruction.block_].instructions_;
+    instructions.erase(std::remove(instructions.begin(), instructions.end(), value), instructions.end());
+}
+
+const char* typeName(Type type) {
+    switch (type) {
+        case Type::VOID: return "void";
+        case Type::NIL: return "null";
+        case Type::BOOL: return "bool";
+        case Type::INT: return "int";
+        case Type::DOUBLE: return "double";
+        case Type::CHAR: return "char";
+        case Type::STRING: return "string";
+        case Type::FUNCTION: return "fn";
+    }
+    return "?";
+}
+
+} // namespace Ir
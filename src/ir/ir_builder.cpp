@@ -0,0 +1,591 @@
+#include <latimer/ir/ir_builder.hpp>
+
+#include <iostream>
+
+#include <latimer/interpreter/native_functions.hpp>
+#include <latimer/utils/error_handler.hpp>
+#include <latimer/utils/macros.hpp>
+
+using Ir::BlockId;
+using Ir::Op;
+using Ir::ValueId;
+
+IrBuilder::IrBuilder(Utils::ErrorHandler& errorHandler)
+    : errorHandler_(errorHandler)
+    , module_()
+    , current_(nullptr)
+    , scopes_()
+    , bindings_()
+    , natives_()
+    , result_(0)
+    , type_(Ir::Type::VOID) {}
+
+Ir::Module IrBuilder::build(std::vector<AstStatPtr>& statements) {
+    module_ = Ir::Module();
+    bindings_.clear();
+    for (auto& native : nativeFunctions())
+        natives_[native.first] = native.second;
+
+    module_.functions_.push_back({"script", 0, {}, {}, {}, {}});
+    FunctionState script{0, 0, {}, {}, {}, {}};
+    current_ = &script;
+    newBlock(true);
+
+    try {
+        scopes_.beginScope(false);
+        for (AstStatPtr& stat : statements) {
+            if (!stat) throw InternalCompilerError("[Internal Compiler Error]: nullptr statement in AST list.");
+            lower(*stat);
+        }
+        scopes_.endScope();
+
+        if (!terminated())
+            emit(Op::RETURN, Ir::Type::VOID, 0);
+    } catch (InternalCompilerError error) {
+        std::cerr << error.what() << std::endl;
+        errorHandler_.hadError_ = true;
+    }
+
+    current_ = nullptr;
+    return std::move(module_);
+}
+
+Ir::Function& IrBuilder::function() {
+    return module_.functions_[current_->index_];
+}
+
+ValueId IrBuilder::lower(AstExpr& expr) {
+    expr.accept(*this);
+    return result_;
+}
+
+void IrBuilder::lower(AstStat& stat) {
+    stat.accept(*this);
+}
+
+Ir::Type IrBuilder::convertType(AstType& type) {
+    type.accept(*this);
+    return type_;
+}
+
+Ir::Type IrBuilder::irType(const TypePtr& type) {
+    if (type == nullptr)
+        return Ir::Type::NIL;
+    if (std::holds_alternative<FunctionType>(type->type_))
+        return Ir::Type::FUNCTION;
+    if (!std::holds_alternative<PrimitiveType>(type->type_))
+        return Ir::Type::NIL;
+
+    switch (std::get<PrimitiveType>(type->type_).type_) {
+        case PrimitiveType::NilType: return Ir::Type::NIL;
+        case PrimitiveType::Boolean: return Ir::Type::BOOL;
+        case PrimitiveType::Integer: return Ir::Type::INT;
+        case PrimitiveType::Double: return Ir::Type::DOUBLE;
+        case PrimitiveType::String: return Ir::Type::STRING;
+        case PrimitiveType::Character: return Ir::Type::CHAR;
+        case PrimitiveType::Void: return Ir::Type::VOID;
+    }
+    return Ir::Type::NIL;
+}
+
+BlockId IrBuilder::newBlock(bool sealed) {
+    Ir::Function& fn = function();
+    BlockId block = static_cast<BlockId>(fn.blocks_.size());
+    fn.blocks_.push_back({{}, {}, false});
+    current_->definitions_.emplace_back();
+    current_->sealed_.push_back(sealed);
+    current_->incompletePhis_.emplace_back();
+    return block;
+}
+
+// All of the block's predecessors are known, so its placeholder phis can read their operands
+void IrBuilder::sealBlock(BlockId block) {
+    auto incomplete = std::move(current_->incompletePhis_[block]);
+    current_->incompletePhis_[block].clear();
+    current_->sealed_[block] = true;
+
+    for (auto& [key, phi] : incomplete)
+        addPhiOperands(key, phi);
+}
+
+bool IrBuilder::terminated() const {
+    const Ir::Function& fn = module_.functions_[current_->index_];
+    const std::vector<ValueId>& instructions = fn.blocks_[current_->block_].instructions_;
+    return !instructions.empty() && fn.values_[instructions.back()].isTerminator();
+}
+
+void IrBuilder::startUnreachable() {
+    current_->block_ = newBlock(true);
+}
+
+ValueId IrBuilder::emit(Op op, Ir::Type type, int line, std::vector<ValueId> operands) {
+    Ir::Function& fn = function();
+    ValueId id = static_cast<ValueId>(fn.values_.size());
+    fn.values_.push_back({op, type, line, current_->block_, false, std::move(operands), {}, Runtime::Value(), 0, TokenType(), ""});
+    fn.blocks_[current_->block_].instructions_.push_back(id);
+    return id;
+}
+
+ValueId IrBuilder::constant(const Runtime::Value& value, Ir::Type type, int line) {
+    ValueId id = emit(Op::CONSTANT, type, line);
+    function().values_[id].constant_ = value;
+    return id;
+}
+
+void IrBuilder::jump(BlockId target, int line) {
+    ValueId id = emit(Op::JUMP, Ir::Type::VOID, line);
+    Ir::Function& fn = function();
+    fn.values_[id].targets_ = {target};
+    fn.blocks_[target].predecessors_.push_back(current_->block_);
+}
+
+void IrBuilder::branch(ValueId condition, BlockId then, BlockId otherwise, int line, const char* errorMsg) {
+    ValueId id = emit(Op::BRANCH, Ir::Type::VOID, line, {condition});
+    Ir::Function& fn = function();
+    fn.values_[id].targets_ = {then, otherwise};
+    fn.values_[id].text_ = errorMsg;
+    fn.blocks_[then].predecessors_.push_back(current_->block_);
+    fn.blocks_[otherwise].predecessors_.push_back(current_->block_);
+}
+
+void IrBuilder::declare(const std::string& name, const void* key, Binding binding) {
+    scopes_.declare(name, key);
+    bindings_[key] = binding;
+}
+
+void IrBuilder::writeVariable(const void* key, BlockId block, ValueId value) {
+    current_->definitions_[block][key] = value;
+}
+
+ValueId IrBuilder::readVariable(const void* key, BlockId block) {
+    auto found = current_->definitions_[block].find(key);
+    if (found != current_->definitions_[block].end())
+        return found->second;
+
+    return readVariableRecursive(key, block);
+}
+
+ValueId IrBuilder::readVariableRecursive(const void* key, BlockId block) {
+    Ir::Function& fn = function();
+    const std::vector<BlockId>& preds = fn.blocks_[block].predecessors_;
+    Ir::Type type = bindings_.at(key).type_;
+
+    ValueId value;
+    if (!current_->sealed_[block]) {
+        value = newPhi(block, type, fn.line_);
+        current_->incompletePhis_[block].push_back({key, value});
+    } else if (preds.size() == 1) {
+        value = readVariable(key, preds[0]);
+    } else if (preds.empty()) {
+        // Only unreachable code reads a variable no path has defined. The block may already be
+        // terminated, so the placeholder goes first.
+        BlockId saved = current_->block_;
+        current_->block_ = block;
+        value = constant(Runtime::Value(), type, fn.line_);
+        current_->block_ = saved;
+
+        std::vector<ValueId>& instructions = fn.blocks_[block].instructions_;
+        instructions.pop_back();
+        instructions.insert(instructions.begin(), value);
+    } else {
+        // Defined before reading the operands, so a loop that reaches back here finds the phi
+        value = newPhi(block, type, fn.line_);
+        writeVariable(key, block, value);
+        addPhiOperands(key, value);
+    }
+
+    writeVariable(key, block, value);
+    return value;
+}
+
+ValueId IrBuilder::newPhi(BlockId block, Ir::Type type, int line) {
+    Ir::Function& fn = function();
+    ValueId id = static_cast<ValueId>(fn.values_.size());
+    fn.values_.push_back({Op::PHI, type, line, block, false, {}, {}, Runtime::Value(), 0, TokenType(), ""});
+
+    std::vector<ValueId>& instructions = fn.blocks_[block].instructions_;
+    auto position = instructions.begin();
+    while (position != instructions.end() && fn.values_[*position].op_ == Op::PHI)
+        position++;
+    instructions.insert(position, id);
+    return id;
+}
+
+void IrBuilder::addPhiOperands(const void* key, ValueId phi) {
+    BlockId block = function().values_[phi].block_;
+    std::vector<BlockId> preds = function().blocks_[block].predecessors_;
+
+    std::vector<ValueId> operands;
+    for (BlockId pred : preds)
+        operands.push_back(readVariable(key, pred));
+    function().values_[phi].operands_ = std::move(operands);
+}
+
+ValueId IrBuilder::readName(const Token& name, Ir::Type type) {
+    const void* key = scopes_.lookup(name.lexeme_);
+    if (key == nullptr) {
+        auto native = natives_.find(name.lexeme_);
+        if (native != natives_.end()) {
+            ValueId id = emit(Op::NATIVE, Ir::Type::FUNCTION, name.line_);
+            function().values_[id].constant_ = native->second;
+            function().values_[id].text_ = name.lexeme_;
+            return id;
+        }
+
+        ValueId id = emit(Op::UNDEFINED, type, name.line_);
+        function().values_[id].text_ = name.lexeme_;
+        return id;
+    }
+
+    const Binding& binding = bindings_.at(key);
+    switch (binding.storage_) {
+        case Storage::LOCAL:
+            return readVariable(key, current_->block_);
+        case Storage::CAPTURE: {
+            ValueId id = emit(Op::LOAD_CAPTURE, binding.type_, name.line_);
+            function().values_[id].index_ = binding.index_;
+            function().values_[id].text_ = name.lexeme_;
+            return id;
+        }
+        case Storage::SELF:
+            return emit(Op::SELF, Ir::Type::FUNCTION, name.line_);
+    }
+    return 0;
+}
+
+void IrBuilder::visitPrimitiveType(AstTypePrimitive& type) {
+    switch (type.kind_) {
+        case AstTypePrimitive::BOOL: type_ = Ir::Type::BOOL; break;
+        case AstTypePrimitive::INT: type_ = Ir::Type::INT; break;
+        case AstTypePrimitive::DOUBLE: type_ = Ir::Type::DOUBLE; break;
+        case AstTypePrimitive::STRING: type_ = Ir::Type::STRING; break;
+        case AstTypePrimitive::CHAR: type_ = Ir::Type::CHAR; break;
+        case AstTypePrimitive::VOID: type_ = Ir::Type::VOID; break;
+    }
+}
+
+void IrBuilder::visitFunctionType(UNUSED AstTypeFunction& type) {
+    type_ = Ir::Type::FUNCTION;
+}
+
+void IrBuilder::visitGroupExpr(AstExprGroup& expr) {
+    result_ = lower(*expr.expr_);
+}
+
+void IrBuilder::visitUnaryExpr(AstExprUnary& expr) {
+    ValueId right = lower(*expr.right_);
+    result_ = emit(Op::GENERIC_UNARY, irType(expr.type_), expr.op_.line_, {right});
+    function().values_[result_].token_ = expr.op_.type_;
+    function().values_[result_].text_ = expr.op_.lexeme_;
+}
+
+void IrBuilder::visitBinaryExpr(AstExprBinary& expr) {
+    ValueId left = lower(*expr.left_);
+    ValueId right = lower(*expr.right_);
+    result_ = emit(Op::GENERIC_BINARY, irType(expr.type_), expr.op_.line_, {left, right});
+    function().values_[result_].token_ = expr.op_.type_;
+    function().values_[result_].text_ = expr.op_.lexeme_;
+}
+
+void IrBuilder::visitTypedUnaryExpr(AstExprTypedUnary& expr) {
+    ValueId right = lower(*expr.right_);
+    result_ = emit(Op::UNARY, irType(expr.type_), expr.op_.line_, {right});
+    function().values_[result_].index_ = expr.kind_;
+    function().values_[result_].token_ = expr.op_.type_;
+    function().values_[result_].text_ = expr.op_.lexeme_;
+}
+
+void IrBuilder::visitTypedBinaryExpr(AstExprTypedBinary& expr) {
+    ValueId left = lower(*expr.left_);
+    ValueId right = lower(*expr.right_);
+    result_ = emit(Op::BINARY, irType(expr.type_), expr.op_.line_, {left, right});
+    function().values_[result_].index_ = expr.kind_;
+    function().values_[result_].token_ = expr.op_.type_;
+    function().values_[result_].text_ = expr.op_.lexeme_;
+}
+
+void IrBuilder::visitTernaryExpr(AstExprTernary& expr) {
+    ValueId condition = lower(*expr.condition_);
+    BlockId thenBlock = newBlock(true);
+    BlockId elseBlock = newBlock(true);
+    BlockId merge = newBlock(false);
+    branch(condition, thenBlock, elseBlock, expr.line_, "Ternary condition must be a boolean.");
+
+    current_->block_ = thenBlock;
+    ValueId thenValue = lower(*expr.thenBranch_);
+    jump(merge, expr.line_);
+
+    current_->block_ = elseBlock;
+    ValueId elseValue = lower(*expr.elseBranch_);
+    jump(merge, expr.line_);
+
+    sealBlock(merge);
+    current_->block_ = merge;
+    Ir::Type type = irType(expr.type_);
+    result_ = newPhi(merge, type, expr.line_);
+    function().values_[result_].operands_ = {thenValue, elseValue};
+}
+
+void IrBuilder::visitLiteralNullExpr(AstExprLiteralNull& expr) {
+    result_ = constant(Runtime::Value(), Ir::Type::NIL, expr.line_);
+}
+
+void IrBuilder::visitLiteralBoolExpr(AstExprLiteralBool& expr) {
+    result_ = constant(expr.value_, Ir::Type::BOOL, expr.line_);
+}
+
+void IrBuilder::visitLiteralIntExpr(AstExprLiteralInt& expr) {
+    result_ = constant(expr.value_, Ir::Type::INT, expr.line_);
+}
+
+void IrBuilder::visitLiteralDoubleExpr(AstExprLiteralDouble& expr) {
+    result_ = constant(expr.value_, Ir::Type::DOUBLE, expr.line_);
+}
+
+void IrBuilder::visitLiteralStringExpr(AstExprLiteralString& expr) {
+    result_ = constant(expr.value_, Ir::Type::STRING, expr.line_);
+}
+
+void IrBuilder::visitLiteralCharExpr(AstExprLiteralChar& expr) {
+    result_ = constant(expr.value_, Ir::Type::CHAR, expr.line_);
+}
+
+void IrBuilder::visitVariableExpr(AstExprVariable& expr) {
+    result_ = readName(expr.name_, irType(expr.type_));
+}
+
+// The IR leaves loop invariants to its own passes and computes the expression where it was
+void IrBuilder::visitHoistedExpr(AstExprHoisted& expr) {
+    result_ = lower(*expr.expr_);
+}
+
+void IrBuilder::visitAssignmentExpr(AstExprAssignment& expr) {
+    ValueId value = lower(*expr.value_);
+    result_ = value;
+
+    const void* key = scopes_.lookup(expr.name_.lexeme_);
+    if (key == nullptr) {
+        // Natives are globals the script cannot see either, so assigning to one fails too
+        ValueId id = emit(Op::UNDEFINED, irType(expr.type_), expr.name_.line_, {value});
+        function().values_[id].text_ = expr.name_.lexeme_;
+        return;
+    }
+
+    const Binding& binding = bindings_.at(key);
+    switch (binding.storage_) {
+        case Storage::LOCAL:
+            writeVariable(key, current_->block_, value);
+            break;
+        case Storage::CAPTURE:
+        case Storage::SELF: {
+            // The function's own name is the closure slot after its captures
+            ValueId id = emit(Op::STORE_CAPTURE, Ir::Type::VOID, expr.name_.line_, {value});
+            function().values_[id].index_ = binding.storage_ == Storage::SELF ? static_cast<int>(function().captures_.size()) : binding.index_;
+            function().values_[id].text_ = expr.name_.lexeme_;
+            break;
+        }
+    }
+}
+
+void IrBuilder::visitCallExpr(AstExprCall& expr) {
+    std::vector<ValueId> operands{lower(*expr.callee_)};
+    for (AstExprPtr& arg : expr.args_)
+        operands.push_back(lower(*arg));
+
+    result_ = emit(Op::CALL, irType(expr.type_), expr.line_, std::move(operands));
+}
+
+void IrBuilder::visitVarDeclStat(AstStatVarDecl& stat) {
+    // Nothing reads the LoopInvariantHoister's temporaries, see visitHoistedExpr
+    if (stat.speculative_)
+        return;
+
+    Ir::Type type = stat.type_ != nullptr ? convertType(*stat.type_) : irType(stat.initializer_->type_);
+    ValueId value = stat.initializer_ != nullptr ? lower(*stat.initializer_) : constant(Runtime::Value(), type, stat.line_);
+
+    declare(stat.name_.lexeme_, &stat, {Storage::LOCAL, 0, type});
+    writeVariable(&stat, current_->block_, value);
+}
+
+void IrBuilder::visitExpressionStat(AstStatExpression& stat) {
+    lower(*stat.expr_);
+}
+
+void IrBuilder::visitIfElseStat(AstStatIfElse& stat) {
+    ValueId condition = lower(*stat.condition_);
+    BlockId thenBlock = newBlock(true);
+    BlockId elseBlock = stat.elseBranch_ != nullptr ? newBlock(true) : 0;
+    BlockId merge = newBlock(false);
+    branch(condition, thenBlock, stat.elseBranch_ != nullptr ? elseBlock : merge, stat.line_, "Condition of if statement must evaluate to a boolean value.");
+
+    current_->block_ = thenBlock;
+    lower(*stat.thenBranch_);
+    if (!terminated())
+        jump(merge, stat.line_);
+
+    if (stat.elseBranch_ != nullptr) {
+        current_->block_ = elseBlock;
+        lower(*stat.elseBranch_);
+        if (!terminated())
+            jump(merge, stat.line_);
+    }
+
+    sealBlock(merge);
+    current_->block_ = merge;
+}
+
+void IrBuilder::visitForStat(AstStatFor& stat) {
+    scopes_.beginScope(false);
+    if (stat.initializer_ != nullptr)
+        lower(*stat.initializer_);
+
+    BlockId header = newBlock(false);
+    BlockId body = newBlock(true);
+    BlockId increment = newBlock(false);
+    BlockId exit = newBlock(false);
+    jump(header, stat.line_);
+
+    current_->block_ = header;
+    if (stat.condition_ != nullptr)
+        branch(lower(*stat.condition_), body, exit, stat.line_, "For loop condition must evaluate to a boolean.");
+    else
+        jump(body, stat.line_);
+
+    current_->block_ = body;
+    current_->loops_.push_back({increment, exit});
+    lower(*stat.body_);
+    current_->loops_.pop_back();
+    if (!terminated())
+        jump(increment, stat.line_);
+
+    sealBlock(increment);
+    current_->block_ = increment;
+    if (stat.increment_ != nullptr)
+        lower(*stat.increment_);
+    jump(header, stat.line_);
+
+    sealBlock(header);
+    sealBlock(exit);
+    current_->block_ = exit;
+    scopes_.endScope();
+}
+
+void IrBuilder::visitWhileStat(AstStatWhile& stat) {
+    BlockId header = newBlock(false);
+    BlockId body = newBlock(true);
+    BlockId exit = newBlock(false);
+    jump(header, stat.line_);
+
+    current_->block_ = header;
+    branch(lower(*stat.condition_), body, exit, stat.line_, "Condition of while loop must evaluate to a boolean value.");
+
+    current_->block_ = body;
+    current_->loops_.push_back({header, exit});
+    lower(*stat.body_);
+    current_->loops_.pop_back();
+    if (!terminated())
+        jump(header, stat.line_);
+
+    sealBlock(header);
+    sealBlock(exit);
+    current_->block_ = exit;
+}
+
+void IrBuilder::visitBreakStat(AstStatBreak& stat) {
+    if (current_->loops_.empty())
+        throw InternalCompilerError("[Internal Compiler Error]: 'break' outside of a loop reached the IR builder.");
+
+    jump(current_->loops_.back().break_, stat.line_);
+    startUnreachable();
+}
+
+void IrBuilder::visitContinueStat(AstStatContinue& stat) {
+    if (current_->loops_.empty())
+        throw InternalCompilerError("[Internal Compiler Error]: 'continue' outside of a loop reached the IR builder.");
+
+    jump(current_->loops_.back().continue_, stat.line_);
+    startUnreachable();
+}
+
+void IrBuilder::visitBlockStat(AstStatBlock& stat) {
+    scopes_.beginScope(false);
+    for (AstStatPtr& inner : stat.body_)
+        lower(*inner);
+    scopes_.endScope();
+}
+
+void IrBuilder::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    // The closure is built where the declaration runs, copying the captures in order
+    std::vector<ValueId> captured;
+    std::vector<Ir::Type> capturedTypes;
+    for (const Token& capture : stat.captures_) {
+        const void* key = scopes_.lookup(capture.lexeme_);
+        Ir::Type type = key != nullptr ? bindings_.at(key).type_ : Ir::Type::FUNCTION;
+        captured.push_back(readName(capture, type));
+        capturedTypes.push_back(type);
+    }
+
+    size_t index = module_.functions_.size();
+    ValueId closure = emit(Op::CLOSURE, Ir::Type::FUNCTION, stat.line_, captured);
+    function().values_[closure].index_ = static_cast<int>(index);
+    function().values_[closure].text_ = stat.name_.lexeme_;
+    declare(stat.name_.lexeme_, &stat, {Storage::LOCAL, 0, Ir::Type::FUNCTION});
+    writeVariable(&stat, current_->block_, closure);
+
+    Ir::Function lowered{stat.name_.lexeme_, stat.line_, {}, {}, {}, {}};
+    for (const Token& param : stat.paramNames_)
+        lowered.params_.push_back(param.lexeme_);
+    for (const Token& capture : stat.captures_)
+        lowered.captures_.push_back(capture.lexeme_);
+    module_.functions_.push_back(std::move(lowered));
+
+    FunctionState state{index, 0, {}, {}, {}, {}};
+    FunctionState* enclosing = current_;
+    current_ = &state;
+    newBlock(true);
+
+    scopes_.beginScope(true);
+    for (size_t i = 0; i < stat.captures_.size(); i++)
+        declare(stat.captures_[i].lexeme_, &stat.captures_[i], {Storage::CAPTURE, static_cast<int>(i), capturedTypes[i]});
+    declare(stat.name_.lexeme_, &stat.name_, {Storage::SELF, 0, Ir::Type::FUNCTION});
+
+    scopes_.beginScope(false);
+    for (size_t i = 0; i < stat.paramNames_.size(); i++) {
+        Ir::Type type = convertType(*stat.paramTypes_[i]);
+        ValueId param = emit(Op::PARAMETER, type, stat.paramNames_[i].line_);
+        function().values_[param].index_ = static_cast<int>(i);
+        function().values_[param].text_ = stat.paramNames_[i].lexeme_;
+        declare(stat.paramNames_[i].lexeme_, &stat.paramNames_[i], {Storage::LOCAL, 0, type});
+        writeVariable(&stat.paramNames_[i], current_->block_, param);
+    }
+
+    for (AstStatPtr& inner : body->body_)
+        lower(*inner);
+    if (!terminated())
+        emit(Op::RETURN, Ir::Type::VOID, stat.line_);
+
+    scopes_.endScope();
+    scopes_.endScope();
+    current_ = enclosing;
+}
+
+void IrBuilder::visitReturnStat(AstStatReturn& stat) {
+    if (stat.value_ == nullptr) {
+        emit(Op::RETURN, Ir::Type::VOID, stat.line_);
+    } else if (stat.tailCall_) {
+        AstExprCall& call = static_cast<AstExprCall&>(*stat.value_);
+        std::vector<ValueId> operands{lower(*call.callee_)};
+        for (AstExprPtr& arg : call.args_)
+            operands.push_back(lower(*arg));
+        emit(Op::TAIL_CALL, irType(call.type_), call.line_, std::move(operands));
+    } else {
+        ValueId value = lower(*stat.value_);
+        emit(Op::RETURN, Ir::Type::VOID, stat.line_, {value});
+    }
+
+    startUnreachable();
+}
@@ -0,0 +1,378 @@
+#include <latimer/ir/ir_interpreter.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include <latimer/ast/ast.hpp>
+#include <latimer/interpreter/int_arithmetic.hpp>
+#include <latimer/interpreter/native_functions.hpp>
+#include <latimer/interpreter/typed_operands.hpp>
+#include <latimer/utils/macros.hpp>
+
+using Ir::Op;
+using Ir::ValueId;
+
+namespace {
+
+Runtime::Value unsupported(const Runtime::Value& left, const std::string& op, const Runtime::Value& right, int line) {
+    throw RuntimeError(line, "Unsupported operands for '" + Runtime::toString(left) + "' " + op + " '" + Runtime::toString(right) + "'.");
+}
+
+// Same operand pairs, in the same order, as AstInterpreter::visitBinaryExpr
+Runtime::Value genericBinary(const Ir::Instruction& instruction, const Runtime::Value& left, const Runtime::Value& right) {
+#define CASE_PAIR(type, op)                                    \
+    if (left.is<type>() && right.is<type>())                   \
+        return left.as<type>() op right.as<type>();
+#define CASE_INT(wrapping)                                     \
+    if (left.is<int64_t>() && right.is<int64_t>())             \
+        return Runtime::wrapping(left.as<int64_t>(), right.as<int64_t>());
+
+    switch (instruction.token_) {
+        case TokenType::PLUS: CASE_INT(wrappingAdd) CASE_PAIR(double, +) CASE_PAIR(std::string, +) break;
+        case TokenType::MINUS: CASE_INT(wrappingSubtract) CASE_PAIR(double, -) break;
+        case TokenType::STAR: CASE_INT(wrappingMultiply) CASE_PAIR(double, *) break;
+        case TokenType::SLASH: CASE_PAIR(int64_t, /) CASE_PAIR(double, /) break;
+        case TokenType::PERECENT: CASE_PAIR(int64_t, %) break;
+        case TokenType::LESS_LESS: CASE_PAIR(int64_t, <<) break;
+        case TokenType::GREATER_GREATER: CASE_PAIR(int64_t, >>) break;
+        case TokenType::AMPERSAND: CASE_PAIR(int64_t, &) break;
+        case TokenType::PIPE: CASE_PAIR(int64_t, |) break;
+        case TokenType::CARET: CASE_PAIR(int64_t, ^) break;
+        case TokenType::AMPERSAND_AMPERSAND: CASE_PAIR(bool, &&) break;
+        case TokenType::PIPE_PIPE: CASE_PAIR(bool, ||) break;
+        case TokenType::LESS: CASE_PAIR(int64_t, <) CASE_PAIR(double, <) CASE_PAIR(std::string, <) CASE_PAIR(char, <) break;
+        case TokenType::LESS_EQUAL: CASE_PAIR(int64_t, <=) CASE_PAIR(double, <=) CASE_PAIR(std::string, <=) CASE_PAIR(char, <=) break;
+        case TokenType::GREATER: CASE_PAIR(int64_t, >) CASE_PAIR(double, >) CASE_PAIR(std::string, >) CASE_PAIR(char, >) break;
+        case TokenType::GREATER_EQUAL: CASE_PAIR(int64_t, >=) CASE_PAIR(double, >=) CASE_PAIR(std::string, >=) CASE_PAIR(char, >=) break;
+        case TokenType::EQUAL_EQUAL:
+            CASE_PAIR(int64_t, ==) CASE_PAIR(double, ==) CASE_PAIR(std::string, ==) CASE_PAIR(char, ==) CASE_PAIR(bool, ==)
+            if (left.is<std::monostate>() && right.is<std::monostate>()) return true;
+            break;
+        case TokenType::BANG_EQUAL:
+            CASE_PAIR(int64_t, !=) CASE_PAIR(double, !=) CASE_PAIR(std::string, !=) CASE_PAIR(char, !=) CASE_PAIR(bool, !=)
+            if (left.is<std::monostate>() && right.is<std::monostate>()) return false;
+            break;
+        default:
+            throw InternalCompilerError("[Internal Compiler Error]: Unexpected Binary Operator: " + instruction.text_ + ".");
+    }
+
+#undef CASE_PAIR
+#undef CASE_INT
+    return unsupported(left, instruction.text_, right, instruction.line_);
+}
+
+Runtime::Value genericUnary(const Ir::Instruction& instruction, const Runtime::Value& right) {
+    switch (instruction.token_) {
+        case TokenType::BANG:
+            if (!right.is<bool>()) throw RuntimeError(instruction.line_, "Unary '!' expects 'bool'.");
+            return !right.as<bool>();
+        case TokenType::TILDE:
+            if (!right.is<int64_t>()) throw RuntimeError(instruction.line_, "Unary '~' expects 'int'.");
+            return ~right.as<int64_t>();
+        case TokenType::MINUS:
+            if (right.is<int64_t>()) return Runtime::wrappingNegate(right.as<int64_t>());
+            if (right.is<double>()) return -right.as<double>();
+            throw RuntimeError(instruction.line_, "Unary '-' expects 'int' or 'double'.");
+        default:
+            throw InternalCompilerError("[Internal Compiler Error]: Unexpected Unary Operator: " + instruction.text_ + ".");
+    }
+}
+
+// A null operand (see typed_operands.hpp) goes to the generic operator
+Runtime::Value typedUnary(const Ir::Instruction& instruction, const Runtime::Value& right) {
+    if (right.type() != Runtime::operandType(static_cast<AstExprTypedUnary::Kind>(instruction.index_)))
+        return genericUnary(instruction, right);
+
+    switch (instruction.index_) {
+        case AstExprTypedUnary::INT_NEGATE: return Runtime::wrappingNegate(right.as<int64_t>());
+        case AstExprTypedUnary::INT_BIT_NOT: return ~right.as<int64_t>();
+        case AstExprTypedUnary::DOUBLE_NEGATE: return -right.as<double>();
+        case AstExprTypedUnary::BOOL_NOT: return !right.as<bool>();
+    }
+    throw InternalCompilerError("[Internal Compiler Error]: Unexpected typed unary kind.");
+}
+
+Runtime::Value typedBinary(const Ir::Instruction& instruction, const Runtime::Value& left, const Runtime::Value& right) {
+    Runtime::Value::Type type = Runtime::operandType(static_cast<AstExprTypedBinary::Kind>(instruction.index_));
+    if (left.type() != type || right.type() != type)
+        return genericBinary(instruction, left, right);
+
+    switch (instruction.index_) {
+        case AstExprTypedBinary::INT_ADD: return Runtime::wrappingAdd(left.as<int64_t>(), right.as<int64_t>());
+        case AstExprTypedBinary::INT_SUBTRACT: return Runtime::wrappingSubtract(left.as<int64_t>(), right.as<int64_t>());
+        case AstExprTypedBinary::INT_MULTIPLY: return Runtime::wrappingMultiply(left.as<int64_t>(), right.as<int64_t>());
+        case AstExprTypedBinary::INT_DIVIDE: return left.as<int64_t>() / right.as<int64_t>();
+        case AstExprTypedBinary::INT_MODULO: return left.as<int64_t>() % right.as<int64_t>();
+        case AstExprTypedBinary::INT_SHIFT_LEFT: return left.as<int64_t>() << right.as<int64_t>();
+        case AstExprTypedBinary::INT_SHIFT_RIGHT: return left.as<int64_t>() >> right.as<int64_t>();
+        case AstExprTypedBinary::INT_BIT_AND: return left.as<int64_t>() & right.as<int64_t>();
+        case AstExprTypedBinary::INT_BIT_OR: return left.as<int64_t>() | right.as<int64_t>();
+        case AstExprTypedBinary::INT_BIT_XOR: return left.as<int64_t>() ^ right.as<int64_t>();
+        case AstExprTypedBinary::INT_LESS: return left.as<int64_t>() < right.as<int64_t>();
+        case AstExprTypedBinary::INT_LESS_EQUAL: return left.as<int64_t>() <= right.as<int64_t>();
+        case AstExprTypedBinary::INT_GREATER: return left.as<int64_t>() > right.as<int64_t>();
+        case AstExprTypedBinary::INT_GREATER_EQUAL: return left.as<int64_t>() >= right.as<int64_t>();
+        case AstExprTypedBinary::INT_EQUAL: return left.as<int64_t>() == right.as<int64_t>();
+        case AstExprTypedBinary::INT_NOT_EQUAL: return left.as<int64_t>() != right.as<int64_t>();
+        case AstExprTypedBinary::DOUBLE_ADD: return left.as<double>() + right.as<double>();
+        case AstExprTypedBinary::DOUBLE_SUBTRACT: return left.as<double>() - right.as<double>();
+        case AstExprTypedBinary::DOUBLE_MULTIPLY: return left.as<double>() * right.as<double>();
+        case AstExprTypedBinary::DOUBLE_DIVIDE: return left.as<double>() / right.as<double>();
+        case AstExprTypedBinary::DOUBLE_LESS: return left.as<double>() < right.as<double>();
+        case AstExprTypedBinary::DOUBLE_LESS_EQUAL: return left.as<double>() <= right.as<double>();
+        case AstExprTypedBinary::DOUBLE_GREATER: return left.as<double>() > right.as<double>();
+        case AstExprTypedBinary::DOUBLE_GREATER_EQUAL: return left.as<double>() >= right.as<double>();
+        case AstExprTypedBinary::DOUBLE_EQUAL: return left.as<double>() == right.as<double>();
+        case AstExprTypedBinary::DOUBLE_NOT_EQUAL: return left.as<double>() != right.as<double>();
+        case AstExprTypedBinary::CHAR_LESS: return left.as<char>() < right.as<char>();
+        case AstExprTypedBinary::CHAR_LESS_EQUAL: return left.as<char>() <= right.as<char>();
+        case AstExprTypedBinary::CHAR_GREATER: return left.as<char>() > right.as<char>();
+        case AstExprTypedBinary::CHAR_GREATER_EQUAL: return left.as<char>() >= right.as<char>();
+        case AstExprTypedBinary::CHAR_EQUAL: return left.as<char>() == right.as<char>();
+        case AstExprTypedBinary::CHAR_NOT_EQUAL: return left.as<char>() != right.as<char>();
+        case AstExprTypedBinary::BOOL_EQUAL: return left.as<bool>() == right.as<bool>();
+        case AstExprTypedBinary::BOOL_NOT_EQUAL: return left.as<bool>() != right.as<bool>();
+        default: break;
+    }
+
+    const std::string& a = left.as<std::string>();
+    const std::string& b = right.as<std::string>();
+    switch (instruction.index_) {
+        case AstExprTypedBinary::STRING_CONCAT: return a + b;
+        case AstExprTypedBinary::STRING_LESS: return a < b;
+        case AstExprTypedBinary::STRING_LESS_EQUAL: return a <= b;
+        case AstExprTypedBinary::STRING_GREATER: return a > b;
+        case AstExprTypedBinary::STRING_GREATER_EQUAL: return a >= b;
+        case AstExprTypedBinary::STRING_EQUAL: return a == b;
+        case AstExprTypedBinary::STRING_NOT_EQUAL: return a != b;
+        default: throw InternalCompilerError("[Internal Compiler Error]: Unexpected typed binary kind.");
+    }
+}
+
+} // namespace
+
+IrClosure::IrClosure(Runtime::Collector& collector, const Ir::Function* function)
+    : Runtime::CollectedCallable(collector)
+    , function_(function)
+    , captures_() {}
+
+Runtime::Value* IrClosure::ownedValues(size_t& count) {
+    count = captures_.size();
+    return captures_.data();
+}
+
+size_t IrClosure::arity() const {
+    return function_->params_.size();
+}
+
+Runtime::Value IrClosure::call(UNUSED int line, UNUSED AstInterpreter& interpreter, UNUSED Runtime::Arguments arguments) {
+    throw InternalCompilerError("[Internal Compiler Error]: IR closure '" + function_->name_ + "' called outside of the IR interpreter.");
+}
+
+std::string IrClosure::toString() const {
+    return "<fn " + function_->name_ + ">";
+}
+
+IrInterpreter::IrInterpreter(Utils::ErrorHandler& errorHandler)
+    : collector_()
+    , errorHandler_(errorHandler)
+    , module_(nullptr)
+    , registers_()
+    , frames_()
+    , arguments_()
+    , phis_() {}
+
+void IrInterpreter::interpret(const Ir::Module& module) {
+    module_ = &module;
+
+    try {
+        pushFrame(Runtime::Value(new IrClosure(collector_, &module.functions_.front())), 0);
+        run();
+    } catch (RuntimeError error) {
+        errorHandler_.runtimeError(error);
+    } catch (InternalCompilerError error) {
+        std::cerr << error.what() << std::endl;
+    }
+
+    frames_.clear();
+    registers_.clear();
+    arguments_.clear();
+}
+
+Runtime::Collector& IrInterpreter::collector() {
+    return collector_;
+}
+
+void IrInterpreter::run() {
+    for (;;) {
+        Frame& frame = frames_.back();
+        const Ir::Function& function = *frame.function_;
+        ValueId id = function.blocks_[frame.block_].instructions_[frame.pc_++];
+        const Ir::Instruction& instruction = function.values_[id];
+        Runtime::Value* regs = registers_.data() + frame.base_;
+        IrClosure* closure = static_cast<IrClosure*>(frame.closure_.as<Runtime::Callable>());
+
+        switch (instruction.op_) {
+            case Op::CONSTANT:
+            case Op::NATIVE:
+                regs[id] = instruction.constant_;
+                break;
+            case Op::PARAMETER:
+                regs[id] = registers_[frame.args_ + instruction.index_];
+                break;
+            case Op::PHI:
+                break; // Assigned by enter()
+            case Op::COPY:
+                regs[id] = regs[instruction.operands_[0]];
+                break;
+            case Op::UNARY:
+                regs[id] = typedUnary(instruction, regs[instruction.operands_[0]]);
+                break;
+            case Op::BINARY:
+                regs[id] = typedBinary(instruction, regs[instruction.operands_[0]], regs[instruction.operands_[1]]);
+                break;
+            case Op::GENERIC_UNARY:
+                regs[id] = genericUnary(instruction, regs[instruction.operands_[0]]);
+                break;
+            case Op::GENERIC_BINARY:
+                regs[id] = genericBinary(instruction, regs[instruction.operands_[0]], regs[instruction.operands_[1]]);
+                break;
+            case Op::SELF:
+                // The slot rather than frame.closure_, which the function may have reassigned
+                regs[id] = closure->captures_[function.captures_.size()];
+                break;
+            case Op::LOAD_CAPTURE:
+                regs[id] = closure->captures_[instruction.index_];
+                break;
+            case Op::STORE_CAPTURE:
+                closure->captures_[instruction.index_] = regs[instruction.operands_[0]];
+                break;
+            case Op::CLOSURE: {
+                collector_.maybeCollect();
+                IrClosure* created = new IrClosure(collector_, &module_->functions_.at(instruction.index_));
+                regs[id] = Runtime::Value(created);
+                created->captures_.reserve(instruction.operands_.size() + 1);
+                for (ValueId operand : instruction.operands_)
+                    created->captures_.push_back(regs[operand]);
+                created->captures_.push_back(regs[id]);
+                break;
+            }
+            case Op::CALL: {
+                for (size_t i = 1; i < instruction.operands_.size(); i++)
+                    arguments_.push_back(regs[instruction.operands_[i]]);
+
+                const Runtime::Value& callee = regs[instruction.operands_[0]];
+                Runtime::Callable* callable = requireCallable(callee, arguments_.size(), instruction.line_);
+                if (callable->isNative()) {
+                    Runtime::Arguments arguments(arguments_.data(), arguments_.size());
+                    regs[id] = static_cast<NativeFunction*>(callable)->invoke(instruction.line_, arguments);
+                    arguments_.clear();
+                    break;
+                }
+
+                frame.call_ = id;
+                pushFrame(callee, instruction.line_);
+                break;
+            }
+            case Op::UNDEFINED:
+                if (instruction.operands_.empty())
+                    throw RuntimeError(instruction.line_, "Variable '" + instruction.text_ + "' has not been declared or initialized.");
+                throw RuntimeError(instruction.line_, "Cannot assign value " + Runtime::toString(regs[instruction.operands_[0]]) + " to undefined variable '" + instruction.text_ + "'.");
+
+            case Op::JUMP:
+                enter(frame, instruction.targets_[0]);
+                break;
+            case Op::BRANCH: {
+                const Runtime::Value& condition = regs[instruction.operands_[0]];
+                if (!condition.is<bool>())
+                    throw RuntimeError(instruction.line_, instruction.text_);
+                enter(frame, instruction.targets_[condition.as<bool>() ? 0 : 1]);
+                break;
+            }
+            case Op::RETURN:
+                if (finish(instruction.operands_.empty() ? Runtime::Value() : std::move(regs[instruction.operands_[0]])))
+                    return;
+                break;
+            case Op::TAIL_CALL: {
+                for (size_t i = 1; i < instruction.operands_.size(); i++)
+                    arguments_.push_back(regs[instruction.operands_[i]]);
+
+                Runtime::Value callee = regs[instruction.operands_[0]];
+                Runtime::Callable* callable = requireCallable(callee, arguments_.size(), instruction.line_);
+                if (callable->isNative()) {
+                    Runtime::Arguments arguments(arguments_.data(), arguments_.size());
+                    Runtime::Value result = static_cast<NativeFunction*>(callable)->invoke(instruction.line_, arguments);
+                    arguments_.clear();
+                    if (finish(std::move(result)))
+                        return;
+                    break;
+                }
+
+                // The callee's frame takes the place of this one
+                registers_.resize(frame.args_);
+                frames_.pop_back();
+                pushFrame(std::move(callee), instruction.line_);
+                break;
+            }
+        }
+    }
+}
+
+void IrInterpreter::enter(Frame& frame, Ir::BlockId target) {
+    const Ir::Block& block = frame.function_->blocks_[target];
+    size_t pred = std::find(block.predecessors_.begin(), block.predecessors_.end(), frame.block_) - block.predecessors_.begin();
+    Runtime::Value* regs = registers_.data() + frame.base_;
+
+    // Every phi reads its operand before any is written: a loop header's phis may read each other
+    phis_.clear();
+    for (ValueId id : block.instructions_) {
+        const Ir::Instruction& phi = frame.function_->values_[id];
+        if (phi.op_ != Op::PHI)
+            break;
+        phis_.push_back(regs[phi.operands_[pred]]);
+    }
+    for (size_t i = 0; i < phis_.size(); i++)
+        regs[block.instructions_[i]] = std::move(phis_[i]);
+
+    frame.block_ = target;
+    frame.pc_ = phis_.size();
+}
+
+bool IrInterpreter::finish(Runtime::Value result) {
+    registers_.resize(frames_.back().args_);
+    frames_.pop_back();
+    if (frames_.empty())
+        return true;
+
+    const Frame& caller = frames_.back();
+    registers_[caller.base_ + caller.call_] = std::move(result);
+    return false;
+}
+
+// Moves arguments_ into the new frame's registers
+void IrInterpreter::pushFrame(Runtime::Value callee, int line) {
+    if (frames_.size() >= FRAMES_MAX)
+        throw RuntimeError(line, "Stack overflow.");
+
+    // Only the IR interpreter creates non-native callables while it is running
+    const Ir::Function* function = static_cast<IrClosure*>(callee.as<Runtime::Callable>())->function_;
+    size_t args = registers_.size();
+    for (Runtime::Value& argument : arguments_)
+        registers_.push_back(std::move(argument));
+    arguments_.clear();
+
+    size_t base = registers_.size();
+    registers_.resize(base + function->values_.size());
+    frames_.push_back({std::move(callee), function, 0, 0, args, base, 0});
+}
+
+Runtime::Callable* IrInterpreter::requireCallable(const Runtime::Value& callee, size_t argCount, int line) {
+    if (!callee.is<Runtime::Callable>())
+        throw RuntimeError(line, "Attempted to call a non-callable value.");
+
+    Runtime::Callable* callable = callee.as<Runtime::Callable>();
+    if (callable->arity() != 255 && argCount != callable->arity())
+        throw RuntimeError(line, "Expected " + std::to_string(callable->arity()) + " arguments but got " + std::to_string(argCount) + ".");
+
+    return callable;
+}
@@ -0,0 +1,136 @@
+#include <latimer/ir/ir_printer.hpp>
+
+#include <cstdio>
+
+#include <latimer/ast/ast.hpp>
+
+using Ir::Op;
+using Ir::ValueId;
+
+namespace {
+
+const char* unaryName(int kind) {
+    switch (kind) {
+        case AstExprTypedUnary::INT_NEGATE: return "int_negate";
+        case AstExprTypedUnary::INT_BIT_NOT: return "int_bit_not";
+        case AstExprTypedUnary::DOUBLE_NEGATE: return "double_negate";
+        case AstExprTypedUnary::BOOL_NOT: return "bool_not";
+    }
+    return "unary";
+}
+
+const char* binaryName(int kind) {
+    static const char* const names[] = {
+        "int_add", "int_subtract", "int_multiply", "int_divide", "int_modulo", "int_shift_left",
+        "int_shift_right", "int_bit_and", "int_bit_or", "int_bit_xor", "int_less", "int_less_equal",
+        "int_greater", "int_greater_equal", "int_equal", "int_not_equal",
+        "double_add", "double_subtract", "double_multiply", "double_divide", "double_less",
+        "double_less_equal", "double_greater", "double_greater_equal", "double_equal", "double_not_equal",
+        "char_less", "char_less_equal", "char_greater", "char_greater_equal", "char_equal", "char_not_equal",
+        "bool_equal", "bool_not_equal",
+        "string_concat", "string_less", "string_less_equal", "string_greater", "string_greater_equal",
+        "string_equal", "string_not_equal",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == AstExprTypedBinary::STRING_NOT_EQUAL + 1, "One name per typed binary kind.");
+
+    return kind >= 0 && kind <= AstExprTypedBinary::STRING_NOT_EQUAL ? names[kind] : "binary";
+}
+
+std::string constantText(const Runtime::Value& value) {
+    switch (value.type()) {
+        case Runtime::Value::Type::STRING: return "\"" + value.as<std::string>() + "\"";
+        case Runtime::Value::Type::CHAR: return "'" + Runtime::toString(value) + "'";
+        case Runtime::Value::Type::DOUBLE: {
+            // Every digit, the interpreter's six decimals would hide what GVN told apart
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", value.as<double>());
+            return buffer;
+        }
+        default: return Runtime::toString(value);
+    }
+}
+
+void printOperands(const std::vector<ValueId>& operands, size_t from, std::ostream& out) {
+    for (size_t i = from; i < operands.size(); i++)
+        out << (i == from ? " %" : ", %") << operands[i];
+}
+
+} // namespace
+
+void IrPrinter::print(const Ir::Module& module, std::ostream& out) const {
+    for (const Ir::Function& function : module.functions_)
+        print(function, out);
+}
+
+void IrPrinter::print(const Ir::Function& function, std::ostream& out) const {
+    out << "function " << function.name_ << "(";
+    for (size_t i = 0; i < function.params_.size(); i++)
+        out << (i == 0 ? "" : ", ") << function.params_[i];
+    out << ")";
+    if (!function.captures_.empty()) {
+        out << " captures [";
+        for (size_t i = 0; i < function.captures_.size(); i++)
+            out << (i == 0 ? "" : ", ") << function.captures_[i];
+        out << "]";
+    }
+    out << " [line " << function.line_ << "]" << std::endl;
+
+    for (Ir::BlockId block = 0; block < function.blocks_.size(); block++) {
+        const Ir::Block& current = function.blocks_[block];
+        if (current.dead_)
+            continue;
+
+        out << "b" << block << ":";
+        if (!current.predecessors_.empty()) {
+            out << " ; preds";
+            for (Ir::BlockId pred : current.predecessors_)
+                out << " b" << pred;
+        }
+        out << std::endl;
+
+        for (ValueId id : current.instructions_)
+            printInstruction(function, id, out);
+    }
+    out << std::endl;
+}
+
+void IrPrinter::printInstruction(const Ir::Function& function, ValueId id, std::ostream& out) const {
+    const Ir::Instruction& instruction = function.values_[id];
+    out << "    ";
+    if (!instruction.isTerminator() && instruction.op_ != Op::STORE_CAPTURE)
+        out << "%" << id << ": " << Ir::typeName(instruction.type_) << " = ";
+
+    switch (instruction.op_) {
+        case Op::CONSTANT: out << "constant " << constantText(instruction.constant_); break;
+        case Op::PARAMETER: out << "parameter " << instruction.index_ << " ; " << instruction.text_; break;
+        case Op::PHI: {
+            out << "phi";
+            const std::vector<Ir::BlockId>& preds = function.blocks_[instruction.block_].predecessors_;
+            for (size_t i = 0; i < instruction.operands_.size(); i++)
+                out << (i == 0 ? " [" : ", [") << "b" << (i < preds.size() ? preds[i] : 0) << ": %" << instruction.operands_[i] << "]";
+            break;
+        }
+        case Op::COPY: out << "copy"; printOperands(instruction.operands_, 0, out); break;
+        case Op::UNARY: out << unaryName(instruction.index_); printOperands(instruction.operands_, 0, out); break;
+        case Op::BINARY: out << binaryName(instruction.index_); printOperands(instruction.operands_, 0, out); break;
+        case Op::GENERIC_UNARY:
+        case Op::GENERIC_BINARY:
+            out << "checked '" << instruction.text_ << "'";
+            printOperands(instruction.operands_, 0, out);
+            break;
+        case Op::NATIVE: out << "native " << instruction.text_; break;
+        case Op::SELF: out << "self"; break;
+        case Op::LOAD_CAPTURE: out << "load_capture " << instruction.index_ << " ; " << instruction.text_; break;
+        case Op::STORE_CAPTURE:
+            out << "store_capture " << instruction.index_ << ", %" << instruction.operands_[0] << " ; " << instruction.text_;
+            break;
+        case Op::CLOSURE: out << "closure " << instruction.text_ << " [function " << instruction.index_ << "]"; printOperands(instruction.operands_, 0, out); break;
+        case Op::CALL: out << "call %" << instruction.operands_[0]; printOperands(instruction.operands_, 1, out); break;
+        case Op::UNDEFINED: out << "undefined " << instruction.text_; printOperands(instruction.operands_, 0, out); break;
+        case Op::JUMP: out << "jump b" << instruction.targets_[0]; break;
+        case Op::BRANCH: out << "branch %" << instruction.operands_[0] << ", b" << instruction.targets_[0] << ", b" << instruction.targets_[1]; break;
+        case Op::RETURN: out << "return"; printOperands(instruction.operands_, 0, out); break;
+        case Op::TAIL_CALL: out << "tail_call %" << instruction.operands_[0]; printOperands(instruction.operands_, 1, out); break;
+    }
+    out << std::endl;
+}
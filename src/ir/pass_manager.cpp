@@ -0,0 +1,43 @@
+#include <latimer/ir/pass_manager.hpp>
+
+#include <algorithm>
+
+#include <latimer/ir/passes.hpp>
+
+IrPassManager IrPassManager::standardPipeline() {
+    IrPassManager manager;
+    manager.add(std::make_unique<CopyPropagation>());
+    manager.add(std::make_unique<GlobalValueNumbering>());
+    manager.add(std::make_unique<DeadCodeElimination>());
+    manager.add(std::make_unique<BranchSimplification>());
+    return manager;
+}
+
+void IrPassManager::add(std::unique_ptr<IrPass> pass) {
+    stats_.push_back({pass->name(), 0});
+    passes_.push_back(std::move(pass));
+}
+
+void IrPassManager::run(Ir::Module& module) {
+    for (Ir::Function& function : module.functions_) {
+        for (size_t round = 1; round <= MAX_ROUNDS; round++) {
+            size_t changes = 0;
+            for (size_t i = 0; i < passes_.size(); i++) {
+                size_t changed = passes_[i]->run(function);
+                stats_[i].changes_ += changed;
+                changes += changed;
+            }
+
+            rounds_ = std::max(rounds_, round);
+            if (changes == 0)
+                break;
+        }
+    }
+}
+
+void IrPassManager::printStats(std::ostream& out) const {
+    out << "; " << rounds_ << " round(s):";
+    for (const PassStats& stats : stats_)
+        out << " " << stats.name_ << " " << stats.changes_;
+    out << std::endl;
+}
@@ -0,0 +1,244 @@
+#include <latimer/jit/assembler.hpp>
+
+#include <cstring>
+
+#include <latimer/utils/error_handler.hpp>
+
+Assembler::Label Assembler::newLabel() {
+    labels_.push_back(SIZE_MAX);
+    return labels_.size() - 1;
+}
+
+void Assembler::bind(Label label) {
+    labels_[label] = code_.size();
+}
+
+const std::vector<uint8_t>& Assembler::finish() {
+    for (const Fixup& fixup : fixups_) {
+        if (labels_[fixup.label_] == SIZE_MAX)
+            throw InternalCompilerError("[Internal Compiler Error]: Jump to an unbound JIT label.");
+
+        int32_t offset = static_cast<int32_t>(labels_[fixup.label_] - (fixup.at_ + 4));
+        std::memcpy(&code_[fixup.at_], &offset, sizeof(offset));
+    }
+
+    fixups_.clear();
+    return code_;
+}
+
+void Assembler::prologue() {
+    byte(0x55); // push rbp
+    mov(RBP, RSP);
+    rex();
+    byte(0x81);
+    byte(0xEC); // sub rsp, imm32
+    frameSizeAt_ = code_.size();
+    int32(0);
+}
+
+void Assembler::setFrameSize(int32_t bytes) {
+    std::memcpy(&code_[frameSizeAt_], &bytes, sizeof(bytes));
+}
+
+void Assembler::epilogue() {
+    mov(RSP, RBP);
+    byte(0x5D); // pop rbp
+    byte(0xC3); // ret
+}
+
+void Assembler::movImmediate(Reg dst, uint64_t value) {
+    rex();
+    byte(0xB8 + dst);
+    for (int i = 0; i < 8; i++)
+        byte(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+void Assembler::mov(Reg dst, Reg src) {
+    rex();
+    byte(0x89);
+    modrmRegs(src, dst);
+}
+
+void Assembler::load(Reg dst, Reg base, int32_t disp) {
+    rex();
+    byte(0x8B);
+    modrmDisp32(dst, base, disp);
+}
+
+void Assembler::store(Reg base, int32_t disp, Reg src) {
+    rex();
+    byte(0x89);
+    modrmDisp32(src, base, disp);
+}
+
+void Assembler::lea(Reg dst, Reg base, int32_t disp) {
+    rex();
+    byte(0x8D);
+    modrmDisp32(dst, base, disp);
+}
+
+void Assembler::intOp(IntOp op, Reg dst, Reg src) {
+    rex();
+    byte(op);
+    modrmRegs(src, dst);
+}
+
+void Assembler::imul(Reg dst, Reg src) {
+    rex();
+    byte(0x0F);
+    byte(0xAF);
+    modrmRegs(dst, src);
+}
+
+void Assembler::idivRcx() {
+    rex();
+    byte(0x99); // cqo
+    rex();
+    byte(0xF7);
+    modrmRegs(7, RCX);
+}
+
+void Assembler::shlCl(Reg dst) {
+    rex();
+    byte(0xD3);
+    modrmRegs(4, dst);
+}
+
+void Assembler::sarCl(Reg dst) {
+    rex();
+    byte(0xD3);
+    modrmRegs(7, dst);
+}
+
+void Assembler::neg(Reg dst) {
+    rex();
+    byte(0xF7);
+    modrmRegs(3, dst);
+}
+
+void Assembler::bitNot(Reg dst) {
+    rex();
+    byte(0xF7);
+    modrmRegs(2, dst);
+}
+
+void Assembler::xorImmediate8(Reg dst, int8_t value) {
+    rex();
+    byte(0x83);
+    modrmRegs(6, dst);
+    byte(static_cast<uint8_t>(value));
+}
+
+void Assembler::test(Reg a, Reg b) {
+    rex();
+    byte(0x85);
+    modrmRegs(b, a);
+}
+
+void Assembler::flipSignBit(Reg dst) {
+    rex();
+    byte(0x0F);
+    byte(0xBA);
+    modrmRegs(7, dst);
+    byte(63);
+}
+
+void Assembler::setcc(Condition condition, Reg dst) {
+    byte(0x0F);
+    byte(0x90 + condition);
+    modrmRegs(0, dst);
+}
+
+void Assembler::zeroExtendByte(Reg dst) {
+    byte(0x0F);
+    byte(0xB6);
+    modrmRegs(dst, dst);
+}
+
+void Assembler::andByte(Reg dst, Reg src) {
+    byte(0x20);
+    modrmRegs(src, dst);
+}
+
+void Assembler::orByte(Reg dst, Reg src) {
+    byte(0x08);
+    modrmRegs(src, dst);
+}
+
+void Assembler::doubleOp(DoubleOp op) {
+    xmmFromGeneral(0, RAX);
+    xmmFromGeneral(1, RCX);
+    byte(0xF2);
+    byte(0x0F);
+    byte(op);
+    modrmRegs(0, 1);
+
+    // movq rax, xmm0
+    byte(0x66);
+    rex();
+    byte(0x0F);
+    byte(0x7E);
+    modrmRegs(0, RAX);
+}
+
+void Assembler::ucomisd(bool swapped) {
+    xmmFromGeneral(0, RAX);
+    xmmFromGeneral(1, RCX);
+    byte(0x66);
+    byte(0x0F);
+    byte(0x2E);
+    modrmRegs(swapped ? 1 : 0, swapped ? 0 : 1);
+}
+
+void Assembler::jmp(Label label) {
+    byte(0xE9);
+    rel32(label);
+}
+
+void Assembler::jcc(Condition condition, Label label) {
+    byte(0x0F);
+    byte(0x80 + condition);
+    rel32(label);
+}
+
+void Assembler::call(Label label) {
+    byte(0xE8);
+    rel32(label);
+}
+
+void Assembler::byte(uint8_t value) {
+    code_.push_back(value);
+}
+
+void Assembler::int32(int32_t value) {
+    for (int i = 0; i < 4; i++)
+        byte(static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8 * i)));
+}
+
+void Assembler::rex() {
+    byte(0x48);
+}
+
+// Only rbp and rdi are used as bases, neither of which needs a SIB byte
+void Assembler::modrmDisp32(Reg reg, Reg base, int32_t disp) {
+    byte(0x80 | (reg << 3) | base);
+    int32(disp);
+}
+
+void Assembler::modrmRegs(uint8_t reg, uint8_t rm) {
+    byte(0xC0 | (reg << 3) | rm);
+}
+
+void Assembler::rel32(Label label) {
+    fixups_.push_back({code_.size(), label});
+    int32(0);
+}
+
+// movq xmm, r64
+void Assembler::xmmFromGeneral(uint8_t xmm, Reg src) {
+    byte(0x66);
+    rex();
+    byte(0x0F);
+    byte(0x6E);
+    modrmRegs(xmm, src);
+}
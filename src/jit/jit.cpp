@@ -0,0 +1,128 @@
+#include <latimer/jit/jit.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <latimer/jit/jit_compiler.hpp>
+
+namespace {
+
+bool takesPrimitive(const AstType* type, AstTypePrimitive::PrimitiveKind kind) {
+    auto primitive = dynamic_cast<const AstTypePrimitive*>(type);
+    return primitive != nullptr && primitive->kind_ == kind;
+}
+
+} // namespace
+
+Jit::Jit()
+    : entries_()
+    , mappings_()
+    , arguments_() {}
+
+Jit::~Jit() {
+    for (const Mapping& mapping : mappings_)
+        munmap(mapping.address_, mapping.size_);
+}
+
+Jit::Entry* Jit::entryFor(AstStatFuncDecl* decl) {
+    return &entries_.insert({decl, {decl, State::COUNTING, 0, nullptr, 0, 0, 0, ""}}).first->second;
+}
+
+bool Jit::call(Entry& entry, Runtime::Arguments arguments, Runtime::Value& result) {
+    if (entry.state_ == State::COUNTING) {
+        if (++entry.hotness_ < HOT_THRESHOLD)
+            return false;
+        compile(entry);
+    }
+
+    if (entry.state_ != State::COMPILED)
+        return false;
+
+    // The code trusts its arguments to have the declared types, so anything else is interpreted
+    const AstStatFuncDecl* decl = entry.decl_;
+    arguments_.resize(arguments.size());
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const Runtime::Value& argument = arguments[i];
+        const AstType* type = decl->paramTypes_[i].get();
+
+        if (argument.is<int64_t>() && takesPrimitive(type, AstTypePrimitive::INT)) {
+            arguments_[i] = argument.as<int64_t>();
+        } else if (argument.is<double>() && takesPrimitive(type, AstTypePrimitive::DOUBLE)) {
+            double value = argument.as<double>();
+            std::memcpy(&arguments_[i], &value, sizeof(value));
+        } else if (argument.is<bool>() && takesPrimitive(type, AstTypePrimitive::BOOL)) {
+            arguments_[i] = argument.as<bool>() ? 1 : 0;
+        } else {
+            entry.fallbacks_++;
+            return false;
+        }
+    }
+
+    int64_t bits = entry.code_(arguments_.data());
+    entry.nativeCalls_++;
+
+    const AstType* returnType = decl->returnType_.get();
+    if (takesPrimitive(returnType, AstTypePrimitive::INT)) {
+        result = bits;
+    } else if (takesPrimitive(returnType, AstTypePrimitive::DOUBLE)) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        result = value;
+    } else {
+        result = bits != 0;
+    }
+    return true;
+}
+
+std::vector<const Jit::Entry*> Jit::tiered() const {
+    std::vector<const Entry*> tiered;
+    for (const auto& entry : entries_) {
+        if (entry.second.state_ != State::COUNTING)
+            tiered.push_back(&entry.second);
+    }
+
+    std::sort(tiered.begin(), tiered.end(), [](const Entry* a, const Entry* b) {
+        return a->decl_->line_ < b->decl_->line_;
+    });
+    return tiered;
+}
+
+void Jit::compile(Entry& entry) {
+#if defined(__x86_64__)
+    std::vector<uint8_t> code;
+    JitCompiler compiler;
+    if (!compiler.compile(*entry.decl_, code, entry.reason_)) {
+        entry.state_ = State::REJECTED;
+        return;
+    }
+
+    // Written while writable, then flipped to executable: never both at once
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (code.size() + page - 1) / page * page;
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED) {
+        entry.state_ = State::REJECTED;
+        entry.reason_ = "no executable memory";
+        return;
+    }
+
+    std::memcpy(address, code.data(), code.size());
+    if (mprotect(address, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(address, size);
+        entry.state_ = State::REJECTED;
+        entry.reason_ = "no executable memory";
+        return;
+    }
+
+    mappings_.push_back({address, size});
+    entry.code_ = reinterpret_cast<int64_t (*)(const int64_t*)>(address);
+    entry.codeBytes_ = code.size();
+    entry.state_ = State::COMPILED;
+#else
+    entry.state_ = State::REJECTED;
+    entry.reason_ = "the JIT only targets x86-64";
+#endif
+}
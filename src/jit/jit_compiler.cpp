@@ -0,0 +1,430 @@
+#include <latimer/jit/jit_compiler.hpp>
+
+#include <cstring>
+
+#include <latimer/utils/error_handler.hpp>
+
+namespace {
+
+// Whether every path through the statement ends in a `return`
+bool alwaysReturns(const AstStat& stat) {
+    if (dynamic_cast<const AstStatReturn*>(&stat))
+        return true;
+    if (auto block = dynamic_cast<const AstStatBlock*>(&stat)) {
+        for (const AstStatPtr& inner : block->body_) {
+            if (alwaysReturns(*inner))
+                return true;
+        }
+        return false;
+    }
+    if (auto ifElse = dynamic_cast<const AstStatIfElse*>(&stat))
+        return ifElse->elseBranch_ != nullptr && alwaysReturns(*ifElse->thenBranch_) && alwaysReturns(*ifElse->elseBranch_);
+    return false;
+}
+
+} // namespace
+
+bool JitCompiler::compile(AstStatFuncDecl& decl, std::vector<uint8_t>& code, std::string& reason) {
+    as_ = Assembler();
+    decl_ = &decl;
+    scopes_.clear();
+    loopExits_.clear();
+    temporaries_.clear();
+    slots_ = 0;
+    depth_ = 0;
+
+    try {
+        if (!decl.captures_.empty())
+            throw Unsupported{"captures variables"};
+        requireValueType(decl.returnType_.get(), "returns");
+        for (const AstTypePtr& type : decl.paramTypes_)
+            requireValueType(type.get(), "takes a parameter of");
+
+        auto body = dynamic_cast<AstStatBlock*>(decl.body_.get());
+        if (!body)
+            throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+        if (!alwaysReturns(*body))
+            throw Unsupported{"can reach the end of its body without returning a value"};
+
+        entry_ = as_.newLabel();
+        body_ = as_.newLabel();
+        return_ = as_.newLabel();
+
+        as_.bind(entry_);
+        as_.prologue();
+
+        // Like the Resolver, the parameters take the first slots and share the body's scope
+        scopes_.emplace_back();
+        for (size_t i = 0; i < decl.paramNames_.size(); i++) {
+            int slot = newSlot();
+            scopes_.back().insert({decl.paramNames_[i].lexeme_, slot});
+            as_.load(Assembler::RAX, Assembler::RDI, static_cast<int32_t>(8 * i));
+            as_.store(Assembler::RBP, offset(slot), Assembler::RAX);
+        }
+
+        as_.bind(body_);
+        for (AstStatPtr& stat : body->body_)
+            compileStat(*stat);
+
+        as_.bind(return_);
+        as_.epilogue();
+
+        // Keep rsp 16-byte aligned at calls
+        as_.setFrameSize(static_cast<int32_t>((8 * slots_ + 15) / 16 * 16));
+        code = as_.finish();
+        return true;
+    } catch (Unsupported unsupported) {
+        reason = unsupported.reason_;
+        return false;
+    }
+}
+
+int32_t JitCompiler::offset(int slot) {
+    return -8 * (slot + 1);
+}
+
+int JitCompiler::newSlot() {
+    return slots_++;
+}
+
+int JitCompiler::lookup(const Token& name) const {
+    for (size_t i = scopes_.size(); i-- > 0;) {
+        auto found = scopes_[i].find(name.lexeme_);
+        if (found != scopes_[i].end())
+            return found->second;
+    }
+
+    throw Unsupported{"uses '" + name.lexeme_ + "', which is not one of its parameters or locals"};
+}
+
+void JitCompiler::compileExpr(AstExpr& expr) {
+    expr.accept(*this);
+}
+
+void JitCompiler::compileStat(AstStat& stat) {
+    stat.accept(*this);
+}
+
+void JitCompiler::requireValueType(const AstType* type, const std::string& what) const {
+    auto primitive = dynamic_cast<const AstTypePrimitive*>(type);
+    if (primitive == nullptr || (primitive->kind_ != AstTypePrimitive::INT && primitive->kind_ != AstTypePrimitive::DOUBLE && primitive->kind_ != AstTypePrimitive::BOOL))
+        throw Unsupported{what + " a type other than int, double or bool"};
+}
+
+void JitCompiler::compileCall(AstExprCall& call, bool tail) {
+    auto callee = dynamic_cast<AstExprVariable*>(call.callee_.get());
+    if (callee == nullptr || callee->name_.lexeme_ != decl_->name_.lexeme_)
+        throw Unsupported{"calls something other than itself"};
+
+    // A local of the same name would hide the function
+    for (const auto& scope : scopes_) {
+        if (scope.count(callee->name_.lexeme_))
+            throw Unsupported{"calls something other than itself"};
+    }
+
+    // The arguments are laid out as an array, first argument at the lowest address
+    size_t count = call.args_.size();
+    int base = slots_;
+    slots_ += static_cast<int>(count);
+    for (size_t i = 0; i < count; i++) {
+        compileExpr(*call.args_[i]);
+        as_.store(Assembler::RBP, offset(base + static_cast<int>(count - 1 - i)), Assembler::RAX);
+    }
+
+    if (!tail) {
+        as_.lea(Assembler::RDI, Assembler::RBP, offset(base + static_cast<int>(count) - 1));
+        as_.call(entry_);
+        return;
+    }
+
+    // All arguments are evaluated before any parameter is overwritten
+    for (size_t i = 0; i < count; i++) {
+        as_.load(Assembler::RAX, Assembler::RBP, offset(base + static_cast<int>(count - 1 - i)));
+        as_.store(Assembler::RBP, offset(static_cast<int>(i)), Assembler::RAX);
+    }
+    as_.jmp(body_);
+}
+
+void JitCompiler::visitPrimitiveType(AstTypePrimitive& type) {
+
+}
+
+void JitCompiler::visitFunctionType(AstTypeFunction& type) {
+
+}
+
+void JitCompiler::visitGroupExpr(AstExprGroup& expr) {
+    compileExpr(*expr.expr_);
+}
+
+void JitCompiler::visitUnaryExpr(AstExprUnary& expr) {
+    throw Unsupported{"uses an operator with a runtime type check"};
+}
+
+void JitCompiler::visitBinaryExpr(AstExprBinary& expr) {
+    throw Unsupported{"uses an operator with a runtime type check"};
+}
+
+void JitCompiler::visitTypedUnaryExpr(AstExprTypedUnary& expr) {
+    compileExpr(*expr.right_);
+
+    switch (expr.kind_) {
+        case AstExprTypedUnary::INT_NEGATE: as_.neg(Assembler::RAX); break;
+        case AstExprTypedUnary::INT_BIT_NOT: as_.bitNot(Assembler::RAX); break;
+        case AstExprTypedUnary::DOUBLE_NEGATE: as_.flipSignBit(Assembler::RAX); break;
+        case AstExprTypedUnary::BOOL_NOT: as_.xorImmediate8(Assembler::RAX, 1); break;
+    }
+}
+
+void JitCompiler::visitTypedBinaryExpr(AstExprTypedBinary& expr) {
+    if (expr.kind_ > AstExprTypedBinary::DOUBLE_NOT_EQUAL && expr.kind_ != AstExprTypedBinary::BOOL_EQUAL && expr.kind_ != AstExprTypedBinary::BOOL_NOT_EQUAL)
+        throw Unsupported{"uses char or string operators"};
+
+    // The left operand waits in a slot of its own while the right one is computed
+    compileExpr(*expr.left_);
+    if (static_cast<int>(temporaries_.size()) <= depth_)
+        temporaries_.push_back(newSlot());
+    int temporary = temporaries_[depth_];
+    as_.store(Assembler::RBP, offset(temporary), Assembler::RAX);
+
+    depth_++;
+    compileExpr(*expr.right_);
+    depth_--;
+
+    as_.mov(Assembler::RCX, Assembler::RAX);
+    as_.load(Assembler::RAX, Assembler::RBP, offset(temporary));
+
+    auto compare = [this](Assembler::Condition condition) {
+        as_.intOp(Assembler::CMP, Assembler::RAX, Assembler::RCX);
+        as_.setcc(condition, Assembler::RAX);
+        as_.zeroExtendByte(Assembler::RAX);
+    };
+    // Unordered (NaN) operands compare false, except for !=
+    auto compareDoubles = [this](Assembler::Condition condition, bool swapped) {
+        as_.ucomisd(swapped);
+        as_.setcc(condition, Assembler::RAX);
+        as_.zeroExtendByte(Assembler::RAX);
+    };
+
+    switch (expr.kind_) {
+        case AstExprTypedBinary::INT_ADD: as_.intOp(Assembler::ADD, Assembler::RAX, Assembler::RCX); break;
+        case AstExprTypedBinary::INT_SUBTRACT: as_.intOp(Assembler::SUB, Assembler::RAX, Assembler::RCX); break;
+        case AstExprTypedBinary::INT_MULTIPLY: as_.imul(Assembler::RAX, Assembler::RCX); break;
+        case AstExprTypedBinary::INT_DIVIDE: as_.idivRcx(); break;
+        case AstExprTypedBinary::INT_MODULO: as_.idivRcx(); as_.mov(Assembler::RAX, Assembler::RDX); break;
+        case AstExprTypedBinary::INT_SHIFT_LEFT: as_.shlCl(Assembler::RAX); break;
+        case AstExprTypedBinary::INT_SHIFT_RIGHT: as_.sarCl(Assembler::RAX); break;
+        case AstExprTypedBinary::INT_BIT_AND: as_.intOp(Assembler::AND, Assembler::RAX, Assembler::RCX); break;
+        case AstExprTypedBinary::INT_BIT_OR: as_.intOp(Assembler::OR, Assembler::RAX, Assembler::RCX); break;
+        case AstExprTypedBinary::INT_BIT_XOR: as_.intOp(Assembler::XOR, Assembler::RAX, Assembler::RCX); break;
+        case AstExprTypedBinary::INT_LESS: compare(Assembler::LESS); break;
+        case AstExprTypedBinary::INT_LESS_EQUAL: compare(Assembler::LESS_EQUAL); break;
+        case AstExprTypedBinary::INT_GREATER: compare(Assembler::GREATER); break;
+        case AstExprTypedBinary::INT_GREATER_EQUAL: compare(Assembler::GREATER_EQUAL); break;
+        case AstExprTypedBinary::INT_EQUAL: compare(Assembler::EQUAL); break;
+        case AstExprTypedBinary::INT_NOT_EQUAL: compare(Assembler::NOT_EQUAL); break;
+
+        case AstExprTypedBinary::DOUBLE_ADD: as_.doubleOp(Assembler::ADDSD); break;
+        case AstExprTypedBinary::DOUBLE_SUBTRACT: as_.doubleOp(Assembler::SUBSD); break;
+        case AstExprTypedBinary::DOUBLE_MULTIPLY: as_.doubleOp(Assembler::MULSD); break;
+        case AstExprTypedBinary::DOUBLE_DIVIDE: as_.doubleOp(Assembler::DIVSD); break;
+        case AstExprTypedBinary::DOUBLE_LESS: compareDoubles(Assembler::ABOVE, true); break;
+        case AstExprTypedBinary::DOUBLE_LESS_EQUAL: compareDoubles(Assembler::ABOVE_EQUAL, true); break;
+        case AstExprTypedBinary::DOUBLE_GREATER: compareDoubles(Assembler::ABOVE, false); break;
+        case AstExprTypedBinary::DOUBLE_GREATER_EQUAL: compareDoubles(Assembler::ABOVE_EQUAL, false); break;
+        case AstExprTypedBinary::DOUBLE_EQUAL:
+            as_.ucomisd(false);
+            as_.setcc(Assembler::EQUAL, Assembler::RAX);
+            as_.setcc(Assembler::NO_PARITY, Assembler::RCX);
+            as_.andByte(Assembler::RAX, Assembler::RCX);
+            as_.zeroExtendByte(Assembler::RAX);
+            break;
+        case AstExprTypedBinary::DOUBLE_NOT_EQUAL:
+            as_.ucomisd(false);
+            as_.setcc(Assembler::NOT_EQUAL, Assembler::RAX);
+            as_.setcc(Assembler::PARITY, Assembler::RCX);
+            as_.orByte(Assembler::RAX, Assembler::RCX);
+            as_.zeroExtendByte(Assembler::RAX);
+            break;
+
+        case AstExprTypedBinary::BOOL_EQUAL: compare(Assembler::EQUAL); break;
+        case AstExprTypedBinary::BOOL_NOT_EQUAL: compare(Assembler::NOT_EQUAL); break;
+        default: break;
+    }
+}
+
+void JitCompiler::visitTernaryExpr(AstExprTernary& expr) {
+    Assembler::Label otherwise = as_.newLabel();
+    Assembler::Label end = as_.newLabel();
+
+    compileExpr(*expr.condition_);
+    as_.test(Assembler::RAX, Assembler::RAX);
+    as_.jcc(Assembler::EQUAL, otherwise);
+    compileExpr(*expr.thenBranch_);
+    as_.jmp(end);
+    as_.bind(otherwise);
+    compileExpr(*expr.elseBranch_);
+    as_.bind(end);
+}
+
+void JitCompiler::visitLiteralNullExpr(AstExprLiteralNull& expr) {
+    throw Unsupported{"uses null"};
+}
+
+void JitCompiler::visitLiteralBoolExpr(AstExprLiteralBool& expr) {
+    as_.movImmediate(Assembler::RAX, expr.value_ ? 1 : 0);
+}
+
+void JitCompiler::visitLiteralIntExpr(AstExprLiteralInt& expr) {
+    as_.movImmediate(Assembler::RAX, static_cast<uint64_t>(expr.value_));
+}
+
+void JitCompiler::visitLiteralDoubleExpr(AstExprLiteralDouble& expr) {
+    uint64_t bits;
+    std::memcpy(&bits, &expr.value_, sizeof(bits));
+    as_.movImmediate(Assembler::RAX, bits);
+}
+
+void JitCompiler::visitLiteralStringExpr(AstExprLiteralString& expr) {
+    throw Unsupported{"uses strings"};
+}
+
+void JitCompiler::visitLiteralCharExpr(AstExprLiteralChar& expr) {
+    throw Unsupported{"uses chars"};
+}
+
+void JitCompiler::visitVariableExpr(AstExprVariable& expr) {
+    as_.load(Assembler::RAX, Assembler::RBP, offset(lookup(expr.name_)));
+}
+
+// Arguments are checked on entry and nothing compiled makes null, so the temporary always holds
+// its value
+void JitCompiler::visitHoistedExpr(AstExprHoisted& expr) {
+    visitVariableExpr(expr);
+}
+
+void JitCompiler::visitAssignmentExpr(AstExprAssignment& expr) {
+    int slot = lookup(expr.name_);
+    compileExpr(*expr.value_);
+    as_.store(Assembler::RBP, offset(slot), Assembler::RAX);
+}
+
+void JitCompiler::visitCallExpr(AstExprCall& expr) {
+    compileCall(expr, false);
+}
+
+void JitCompiler::visitVarDeclStat(AstStatVarDecl& stat) {
+    // The LoopInvariantHoister's temporaries have no declared type, but hold a specialized operator
+    if (stat.type_ != nullptr)
+        requireValueType(stat.type_.get(), "declares a local of");
+    if (stat.initializer_ == nullptr)
+        throw Unsupported{"declares a local without a value"};
+
+    compileExpr(*stat.initializer_);
+    int slot = newSlot();
+    as_.store(Assembler::RBP, offset(slot), Assembler::RAX);
+
+    // As in the Resolver, the first declaration of a name in a scope wins
+    scopes_.back().insert({stat.name_.lexeme_, slot});
+}
+
+void JitCompiler::visitExpressionStat(AstStatExpression& stat) {
+    compileExpr(*stat.expr_);
+}
+
+void JitCompiler::visitIfElseStat(AstStatIfElse& stat) {
+    Assembler::Label otherwise = as_.newLabel();
+    Assembler::Label end = as_.newLabel();
+
+    compileExpr(*stat.condition_);
+    as_.test(Assembler::RAX, Assembler::RAX);
+    as_.jcc(Assembler::EQUAL, otherwise);
+    compileStat(*stat.thenBranch_);
+    as_.jmp(end);
+    as_.bind(otherwise);
+    if (stat.elseBranch_ != nullptr)
+        compileStat(*stat.elseBranch_);
+    as_.bind(end);
+}
+
+void JitCompiler::visitWhileStat(AstStatWhile& stat) {
+    Assembler::Label top = as_.newLabel();
+    Assembler::Label exit = as_.newLabel();
+
+    as_.bind(top);
+    compileExpr(*stat.condition_);
+    as_.test(Assembler::RAX, Assembler::RAX);
+    as_.jcc(Assembler::EQUAL, exit);
+
+    loopExits_.push_back(exit);
+    compileStat(*stat.body_);
+    loopExits_.pop_back();
+
+    as_.jmp(top);
+    as_.bind(exit);
+}
+
+void JitCompiler::visitForStat(AstStatFor& stat) {
+    Assembler::Label top = as_.newLabel();
+    Assembler::Label exit = as_.newLabel();
+
+    scopes_.emplace_back();
+    if (stat.initializer_ != nullptr)
+        compileStat(*stat.initializer_);
+
+    as_.bind(top);
+    if (stat.condition_ != nullptr) {
+        compileExpr(*stat.condition_);
+        as_.test(Assembler::RAX, Assembler::RAX);
+        as_.jcc(Assembler::EQUAL, exit);
+    }
+
+    loopExits_.push_back(exit);
+    compileStat(*stat.body_);
+    loopExits_.pop_back();
+
+    if (stat.increment_ != nullptr)
+        compileExpr(*stat.increment_);
+    as_.jmp(top);
+    as_.bind(exit);
+    scopes_.pop_back();
+}
+
+void JitCompiler::visitBreakStat(AstStatBreak& stat) {
+    // Outside a loop, `break` ends the call with null
+    if (loopExits_.empty())
+        throw Unsupported{"breaks out of the function"};
+
+    as_.jmp(loopExits_.back());
+}
+
+void JitCompiler::visitContinueStat(AstStatContinue& stat) {
+    throw Unsupported{"uses continue"};
+}
+
+void JitCompiler::visitBlockStat(AstStatBlock& stat) {
+    scopes_.emplace_back();
+    for (AstStatPtr& inner : stat.body_)
+        compileStat(*inner);
+    scopes_.pop_back();
+}
+
+void JitCompiler::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    throw Unsupported{"declares a function"};
+}
+
+void JitCompiler::visitReturnStat(AstStatReturn& stat) {
+    if (stat.value_ == nullptr)
+        throw Unsupported{"returns without a value"};
+
+    if (stat.tailCall_) {
+        AstExpr* value = stat.value_.get();
+        while (auto group = dynamic_cast<AstExprGroup*>(value))
+            value = group->expr_.get();
+        compileCall(static_cast<AstExprCall&>(*value), true);
+        return;
+    }
+
+    compileExpr(*stat.value_);
+    as_.jmp(return_);
+}
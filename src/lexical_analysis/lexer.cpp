@@ -56,7 +56,7 @@ void Lexer::addToken(TokenType type) {
     addToken(type, std::monostate{});
 }
 
-void Lexer::addToken(TokenType type, Runtime::Value literal) {
+void Lexer::addToken(TokenType type, Literal literal) {
     std::string text = src_.substr(start_, current_ - start_);
     tokens_.emplace_back(type, text, literal, line_);
 }
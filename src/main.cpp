@@ -1,3 +1,4 @@
+#include <cctype>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -7,18 +8,109 @@
 
 #include <latimer/ast/ast.hpp>
 #include <latimer/lexical_analysis/lexer.hpp>
+#include <latimer/utils/ast_counter.hpp>
 #include <latimer/utils/ast_printer.hpp>
 #include <latimer/utils/error_handler.hpp>
+#include <latimer/utils/tracer.hpp>
 #include <latimer/ast/parser.hpp>
 #include <latimer/interpreter/ast_interpreter.hpp>
+#include <latimer/interpreter/metrics.hpp>
 #include <latimer/semantic_analysis/checker.hpp>
+#include <latimer/semantic_analysis/resolver.hpp>
+#include <latimer/optimizer/optimization_report.hpp>
+#include <latimer/optimizer/inliner.hpp>
+#include <latimer/optimizer/constant_folder.hpp>
+#include <latimer/optimizer/dead_code_eliminator.hpp>
+#include <latimer/optimizer/type_specializer.hpp>
+#include <latimer/optimizer/loop_invariant_hoister.hpp>
+#include <latimer/optimizer/tail_call_marker.hpp>
+#include <latimer/optimizer/purity_analyzer.hpp>
+#include <latimer/bytecode/compiler.hpp>
+#include <latimer/bytecode/vm.hpp>
+#include <latimer/c_backend/c_emitter.hpp>
+#include <latimer/ir/ir_builder.hpp>
+#include <latimer/ir/ir_interpreter.hpp>
+#include <latimer/ir/ir_printer.hpp>
+#include <latimer/ir/pass_manager.hpp>
+
+struct Options {
+    std::string filePath_;
+    bool useVm_ = false;
+    bool useIr_ = false; // Lower to the SSA IR, optimize it and run it there
+    bool dumpIr_ = false;
+    bool allocStats_ = false;
+    bool checkTypes_ = false;
+    bool dumpOpt_ = false;
+    bool noOpt_ = false; // Skip the AST optimizations: inlining, folding, DCE and loop-invariant motion
+    bool jit_ = false; // Tier hot functions up to machine code (AST path only)
+    bool jitStats_ = false;
+    bool memoize_ = false; // Cache the results of pure functions (AST path only)
+    bool memoStats_ = false;
+    bool gcStats_ = false;
+    size_t gcThreshold_ = 0; // Closures allocated before the first collection; 0 keeps the default
+    std::string profile_; // Profile calls and write collapsed stacks to this path (AST path only)
+    unsigned sampleHz_ = 0; // Sample the call stack this often; 0 disables (AST path only)
+    std::string sampleProfile_; // Where the sampled collapsed stacks go
+    std::string trace_; // Write the phases (and calls with --trace-calls) as Chrome trace events here
+    bool traceCalls_ = false; // AST path only
+    bool timePhases_ = false;
+    std::string metrics_; // Write the runtime counters here as JSON; needs a LATIMER_METRICS build
+    std::string heapProfile_; // Track allocations and write the report and a snapshot here (AST path only)
+    std::string lineCounts_; // Count statements per line and write an lcov tracefile here (AST path only)
+    std::string emitC_; // Write the program out as C to this path instead of running it
+};
+
+// Applies the options to an engine's collector
+void configureCollector(Runtime::Collector& collector, const Options& options) {
+    if (options.gcThreshold_ != 0)
+        collector.setThreshold(options.gcThreshold_);
+}
+
+void printCollectorStats(const Runtime::Collector& collector) {
+    Runtime::Collector::Stats stats = collector.stats();
+    std::cerr << "gc collections:    " << stats.collections_ << " (" << stats.totalPauseMs_ << " ms paused, " << stats.maxPauseMs_ << " ms longest)" << std::endl;
+    std::cerr << "gc closures freed: " << stats.freed_ << std::endl;
+    std::cerr << "gc closures live:  " << stats.tracked_ << " (peak " << stats.peakTracked_ << ")" << std::endl;
+}
+
+// Ends the last phase and reports the timeline the options ask for
+void finishTrace(Tracer& tracer, const Options& options) {
+    tracer.endPhase();
+    if (options.timePhases_) tracer.printPhases(std::cerr);
+
+    if (!options.trace_.empty()) {
+        std::ofstream out(options.trace_);
+        tracer.writeTrace(out);
+        if (!out) {
+            std::cerr << "Unable to write file";
+            std::exit(-1);
+        }
+    }
+}
+
+// `hz` or `hz,out.folded`, the rate being a positive number
+bool parseSampleProfile(const std::string& value, Options& options) {
+    size_t comma = value.find(',');
+    std::string hz = value.substr(0, comma);
+    if (hz.empty() || hz.find_first_not_of("0123456789") != std::string::npos || std::stoul(hz) == 0)
+        return false;
+    if (comma != std::string::npos && comma + 1 == value.size())
+        return false;
+
+    options.sampleHz_ = std::stoul(hz);
+    options.sampleProfile_ = comma == std::string::npos ? "sample.folded" : value.substr(comma + 1);
+    return true;
+}
 
 void runRepl() {
     // TODO: implement
 }
 
-void runFile(std::string filePath) {
-    std::ifstream file(filePath);
+void runFile(const Options& options) {
+    Tracer tracer(options.timePhases_ || !options.trace_.empty(), options.traceCalls_);
+
+    tracer.beginPhase("read");
+    std::ifstream file(options.filePath_);
     if (!file.is_open()) {
         std::cerr << "Unable to open file";
         std::exit(-1);
@@ -26,37 +118,306 @@ void runFile(std::string filePath) {
 
     std::stringstream buf;
     buf << file.rdbuf();
+    tracer.count("bytes", buf.str().size());
 
     Utils::ErrorHandler errorHandler;
     
+    tracer.beginPhase("lex");
     Lexer lexer = Lexer(buf.str(), errorHandler);
     std::vector<Token> tokens = lexer.scanTokens();
+    tracer.count("tokens", tokens.size());
     
+    tracer.beginPhase("parse");
     Parser parser = Parser(tokens, errorHandler);
     std::vector<AstStatPtr> statements = parser.parse();
     if (errorHandler.hadError_) std::exit(65);
+    if (tracer.enabled()) tracer.count("nodes", AstCounter().count(statements));
 
+    tracer.beginPhase("check");
     Checker checker = Checker(errorHandler);
     checker.check(statements);
     if (errorHandler.hadError_) std::exit(65);
+
+    OptimizationReport report(options.dumpOpt_);
+    if (!options.noOpt_) {
+        tracer.beginPhase("optimize");
+        Inliner inliner(report);
+        inliner.inlineCalls(statements);
+        ConstantFolder folder(report);
+        folder.fold(statements);
+        DeadCodeEliminator eliminator(report);
+        eliminator.eliminate(statements);
+        if (tracer.enabled()) tracer.count("nodes", AstCounter().count(statements));
+    }
+
+    // Every engine but the C backend, which jumps back for self calls on its own, reuses the frame
+    TailCallMarker tailCalls;
+    tailCalls.mark(statements);
+
+    if (!options.emitC_.empty()) {
+        if (options.dumpOpt_) report.print(std::cerr);
+
+        tracer.beginPhase("compile");
+        CEmitter emitter(errorHandler);
+        std::string source = emitter.emit(statements);
+        if (errorHandler.hadError_) std::exit(65);
+
+        std::ofstream out(options.emitC_);
+        out << source;
+        if (!out) {
+            std::cerr << "Unable to write file";
+            std::exit(-1);
+        }
+        finishTrace(tracer, options);
+        return;
+    }
     
-    AstInterpreter interpreter(errorHandler);
-    interpreter.interpret(statements);
+    if (options.useVm_) {
+        if (options.dumpOpt_) report.print(std::cerr);
+
+        tracer.beginPhase("compile");
+        BytecodeCompiler compiler(errorHandler);
+        Program program = compiler.compile(statements);
+        if (errorHandler.hadError_) std::exit(65);
+
+        tracer.beginPhase("run");
+        VM vm(errorHandler);
+        configureCollector(vm.collector(), options);
+        vm.interpret(program);
+        tracer.endPhase();
+        if (options.gcStats_) printCollectorStats(vm.collector());
+    } else {
+        // --check-types keeps the generic, runtime type-checked operators
+        tracer.beginPhase("specialize");
+        if (!options.checkTypes_) {
+            TypeSpecializer specializer;
+            specializer.specialize(statements);
+        }
+
+        // Only moves specialized operators, so this does nothing under --check-types
+        if (!options.noOpt_) {
+            LoopInvariantHoister hoister(report);
+            hoister.hoist(statements);
+        }
+        if (options.dumpOpt_) report.print(std::cerr);
+
+        if (options.useIr_) {
+            tracer.beginPhase("compile");
+            IrBuilder builder(errorHandler);
+            Ir::Module module = builder.build(statements);
+            if (errorHandler.hadError_) std::exit(65);
+            IrPassManager passes = IrPassManager::standardPipeline();
+            passes.run(module);
+
+            if (options.dumpIr_) {
+                IrPrinter().print(module, std::cerr);
+                passes.printStats(std::cerr);
+            }
+
+            tracer.beginPhase("run");
+            IrInterpreter interpreter(errorHandler);
+            configureCollector(interpreter.collector(), options);
+            interpreter.interpret(module);
+            tracer.endPhase();
+            if (options.gcStats_) printCollectorStats(interpreter.collector());
+        } else {
+            tracer.beginPhase("resolve");
+            if (options.memoize_) {
+                PurityAnalyzer purity;
+                purity.analyze(statements);
+            }
+
+            Resolver resolver(errorHandler);
+            resolver.resolve(statements);
+            if (errorHandler.hadError_) std::exit(65);
+
+            std::unique_ptr<Profiler> profiler = options.profile_.empty() ? nullptr : std::make_unique<Profiler>();
+            std::unique_ptr<SampleProfiler> sampler = options.sampleHz_ == 0 ? nullptr : std::make_unique<SampleProfiler>(options.sampleHz_);
+            tracer.beginPhase("run");
+            std::unique_ptr<HeapProfiler> heap = options.heapProfile_.empty() ? nullptr : std::make_unique<HeapProfiler>(options.heapProfile_);
+            if (heap != nullptr) {
+                AstCounter counter;
+                counter.count(statements);
+                heap->allocatedUpFront(HeapProfiler::Category::AST, counter.bytes());
+            }
+
+            std::unique_ptr<LineCounter> lines = options.lineCounts_.empty() ? nullptr : std::make_unique<LineCounter>(statements);
+
+            Instrumentation instrumentation;
+            instrumentation.profiler_ = profiler.get();
+            instrumentation.sampler_ = sampler.get();
+            instrumentation.tracer_ = &tracer;
+            instrumentation.heap_ = heap.get();
+            instrumentation.lines_ = lines.get();
+            AstInterpreter interpreter(errorHandler, options.jit_, options.memoize_, instrumentation);
+            configureCollector(interpreter.collector(), options);
+            interpreter.interpret(statements);
+            tracer.endPhase();
+            if (options.gcStats_) printCollectorStats(interpreter.collector());
+
+            if (profiler != nullptr) {
+                profiler->printTable(std::cerr);
+
+                std::ofstream out(options.profile_);
+                profiler->writeCollapsed(out);
+                if (!out) {
+                    std::cerr << "Unable to write file";
+                    std::exit(-1);
+                }
+            }
+
+            if (heap != nullptr) {
+                heap->printReport(std::cerr);
+
+                std::ofstream out(options.heapProfile_);
+                heap->writeReport(out, interpreter.heapRoots());
+                if (!out) {
+                    std::cerr << "Unable to write file";
+                    std::exit(-1);
+                }
+            }
+
+            if (lines != nullptr) {
+                lines->printReport(std::cerr, buf.str());
+
+                std::ofstream out(options.lineCounts_);
+                lines->writeLcov(out, options.filePath_);
+                if (!out) {
+                    std::cerr << "Unable to write file";
+                    std::exit(-1);
+                }
+            }
+
+            if (sampler != nullptr) {
+                sampler->printReport(std::cerr);
+
+                std::ofstream out(options.sampleProfile_);
+                sampler->writeCollapsed(out);
+                if (!out) {
+                    std::cerr << "Unable to write file";
+                    std::exit(-1);
+                }
+            }
+
+            if (options.allocStats_) {
+                AstInterpreter::AllocationStats stats = interpreter.allocationStats();
+                std::cerr << "frames pushed:     " << stats.framesPushed_ << std::endl;
+                std::cerr << "arena chunks:      " << stats.arenaChunks_ << " (" << stats.arenaBytes_ << " bytes reserved)" << std::endl;
+                std::cerr << "closures:          " << stats.closures_ << " (" << stats.capturedValues_ << " captured values)" << std::endl;
+            }
+
+            if (options.jitStats_ && interpreter.jit() != nullptr) {
+                for (const Jit::Entry* entry : interpreter.jit()->tiered()) {
+                    std::cerr << "jit '" << entry->decl_->name_.lexeme_ << "' (line " << entry->decl_->line_ << "): ";
+                    if (entry->state_ == Jit::State::COMPILED)
+                        std::cerr << "compiled, " << entry->codeBytes_ << " bytes, " << entry->nativeCalls_ << " native calls, " << entry->fallbacks_ << " interpreted" << std::endl;
+                    else
+                        std::cerr << "not compiled: " << entry->reason_ << std::endl;
+                }
+            }
+
+            if (options.memoStats_ && interpreter.memoizer() != nullptr) {
+                for (const Memoizer::Entry* entry : interpreter.memoizer()->entries()) {
+                    std::cerr << "memo '" << entry->decl_->name_.lexeme_ << "' (line " << entry->decl_->line_ << "): "
+                              << entry->hits_ << " hits, " << entry->misses_ << " misses, " << entry->flushes_ << " flushes, "
+                              << entry->tables_ << (entry->tables_ == 1 ? " closure" : " closures") << std::endl;
+                }
+            }
+        }
+    }
+    finishTrace(tracer, options);
+
+    if (!options.metrics_.empty()) {
+        std::ofstream out(options.metrics_);
+        Metrics::writeJson(out);
+        if (!out) {
+            std::cerr << "Unable to write file";
+            std::exit(-1);
+        }
+    }
+
     if (errorHandler.hadRuntimeError_) std::exit(70);
 }
 
 int main(int argc, char* argv[]) { // TODO: wtf is going on with `1 < 3 : 4 ? 2`
-    switch (argc) {
-        case 1:
-            runRepl();
-            break;
-        case 2:
-            runFile(std::string(argv[1]));
-            break;
-        default:
-            std::cout << "Usage: ./latimer [file_path]" << std::endl;
+    Options options;
+    bool hasFile = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--vm") {
+            options.useVm_ = true;
+        } else if (arg == "--ir") {
+            options.useIr_ = true;
+        } else if (arg == "--dump-ir") {
+            options.useIr_ = true;
+            options.dumpIr_ = true;
+        } else if (arg == "--alloc-stats") {
+            options.allocStats_ = true;
+        } else if (arg == "--check-types") {
+            options.checkTypes_ = true;
+        } else if (arg == "--dump-opt") {
+            options.dumpOpt_ = true;
+        } else if (arg == "--no-opt") {
+            options.noOpt_ = true;
+        } else if (arg == "--jit") {
+            options.jit_ = true;
+        } else if (arg == "--jit-stats") {
+            options.jit_ = true;
+            options.jitStats_ = true;
+        } else if (arg == "--memoize") {
+            options.memoize_ = true;
+        } else if (arg == "--memo-stats") {
+            options.memoize_ = true;
+            options.memoStats_ = true;
+        } else if (arg == "--gc-stats") {
+            options.gcStats_ = true;
+        } else if (arg == "--gc-threshold" && i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+            options.gcThreshold_ = std::stoul(argv[++i]);
+        } else if (arg == "--profile") {
+            options.profile_ = "profile.folded";
+        } else if (arg.rfind("--profile=", 0) == 0 && arg.size() > 10) {
+            options.profile_ = arg.substr(10);
+        } else if (arg.rfind("--sample-profile=", 0) == 0 && parseSampleProfile(arg.substr(17), options)) {
+        } else if (arg.rfind("--trace=", 0) == 0 && arg.size() > 8) {
+            options.trace_ = arg.substr(8);
+        } else if (arg == "--trace-calls") {
+            options.traceCalls_ = true;
+        } else if (arg == "--time-phases") {
+            options.timePhases_ = true;
+        } else if (arg == "--heap-profile") {
+            options.heapProfile_ = "heap.json";
+        } else if (arg.rfind("--heap-profile=", 0) == 0 && arg.size() > 15) {
+            options.heapProfile_ = arg.substr(15);
+        } else if (arg == "--line-counts") {
+            options.lineCounts_ = "coverage.info";
+        } else if (arg.rfind("--line-counts=", 0) == 0 && arg.size() > 14) {
+            options.lineCounts_ = arg.substr(14);
+        } else if (arg.rfind("--metrics=", 0) == 0 && arg.size() > 10) {
+            if (!Metrics::ENABLED) {
+                std::cout << "--metrics needs a build with LATIMER_METRICS (cmake -DLATIMER_METRICS=ON)" << std::endl;
+                return 64;
+            }
+            options.metrics_ = arg.substr(10);
+        } else if (arg == "--emit-c" && i + 1 < argc) {
+            options.emitC_ = argv[++i];
+        } else if (arg.rfind("--", 0) != 0 && !hasFile) {
+            options.filePath_ = arg;
+            hasFile = true;
+        } else {
+            std::cout << "Usage: ./latimer [--vm] [--ir] [--dump-ir] [--alloc-stats] [--check-types] [--dump-opt] [--no-opt] [--jit] [--jit-stats] [--memoize] [--memo-stats] [--gc-stats] [--gc-threshold closures] [--profile[=out.folded]] [--sample-profile=hz[,out.folded]] [--trace=out.json] [--trace-calls] [--time-phases] [--metrics=out.json] [--heap-profile[=heap.json]] [--line-counts[=coverage.info]] [--emit-c out.c] [file_path]" << std::endl;
             return 64;
+        }
     }
 
+    if (options.traceCalls_ && options.trace_.empty())
+        options.trace_ = "trace.json";
+
+    if (hasFile)
+        runFile(options);
+    else
+        runRepl();
+
     return 0;
 }
@@ -0,0 +1,333 @@
+#include <latimer/optimizer/constant_folder.hpp>
+
+#include <limits>
+
+#include <latimer/utils/ast_printer.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+namespace {
+
+bool literalValue(const AstExpr* expr, Runtime::Value& value) {
+    if (auto literal = dynamic_cast<const AstExprLiteralBool*>(expr))
+        value = literal->value_;
+    else if (auto literal = dynamic_cast<const AstExprLiteralInt*>(expr))
+        value = literal->value_;
+    else if (auto literal = dynamic_cast<const AstExprLiteralDouble*>(expr))
+        value = literal->value_;
+    else if (auto literal = dynamic_cast<const AstExprLiteralChar*>(expr))
+        value = literal->value_;
+    else if (auto literal = dynamic_cast<const AstExprLiteralString*>(expr))
+        value = literal->value_;
+    else
+        return false;
+
+    return true;
+}
+
+AstExprPtr makeLiteral(const Runtime::Value& value, int line) {
+    switch (value.type()) {
+        case Runtime::Value::Type::BOOL: return std::make_unique<AstExprLiteralBool>(line, value.as<bool>());
+        case Runtime::Value::Type::INT: return std::make_unique<AstExprLiteralInt>(line, value.as<int64_t>());
+        case Runtime::Value::Type::DOUBLE: return std::make_unique<AstExprLiteralDouble>(line, value.as<double>());
+        case Runtime::Value::Type::CHAR: return std::make_unique<AstExprLiteralChar>(line, value.as<char>());
+        case Runtime::Value::Type::STRING: return std::make_unique<AstExprLiteralString>(line, value.as<std::string>());
+        default: throw InternalCompilerError("[Internal Compiler Error]: Folded a value that has no literal.");
+    }
+}
+
+// Signed overflow wraps at runtime, so fold it the same way without relying on undefined behaviour
+int64_t wrap(uint64_t value) {
+    return static_cast<int64_t>(value);
+}
+
+template <typename T>
+bool compare(TokenType op, const T& a, const T& b, Runtime::Value& result) {
+    switch (op) {
+        case TokenType::LESS: result = a < b; return true;
+        case TokenType::LESS_EQUAL: result = a <= b; return true;
+        case TokenType::GREATER: result = a > b; return true;
+        case TokenType::GREATER_EQUAL: result = a >= b; return true;
+        case TokenType::EQUAL_EQUAL: result = a == b; return true;
+        case TokenType::BANG_EQUAL: result = a != b; return true;
+        default: return false;
+    }
+}
+
+} // namespace
+
+ConstantFolder::ConstantFolder(OptimizationReport& report)
+    : report_(report)
+    , collecting_(false)
+    , bindings_()
+    , scopes_() {}
+
+void ConstantFolder::fold(std::vector<AstStatPtr>& statements) {
+    collecting_ = true;
+    walk(statements);
+
+    collecting_ = false;
+    walk(statements);
+}
+
+void ConstantFolder::walk(std::vector<AstStatPtr>& statements) {
+    scopes_.beginScope(false);
+    transform(statements);
+    scopes_.endScope();
+}
+
+ConstantFolder::Binding& ConstantFolder::declare(const std::string& name, const void* key) {
+    // Both walks declare the same keys, so the second finds what the first recorded
+    Binding& binding = bindings_.insert({key, {false, nullptr}}).first->second;
+    binding.constant_ = nullptr;
+    scopes_.declare(name, key);
+    return binding;
+}
+
+ConstantFolder::Binding* ConstantFolder::lookup(const std::string& name) {
+    const void* key = scopes_.lookup(name);
+    return key != nullptr ? &bindings_.at(key) : nullptr;
+}
+
+bool ConstantFolder::foldBinary(const Runtime::Value& left, TokenType op, const Runtime::Value& right, Runtime::Value& result) {
+    if (left.type() != right.type())
+        return false;
+
+    switch (left.type()) {
+        case Runtime::Value::Type::INT: {
+            int64_t a = left.as<int64_t>();
+            int64_t b = right.as<int64_t>();
+            uint64_t ua = static_cast<uint64_t>(a);
+            uint64_t ub = static_cast<uint64_t>(b);
+
+            switch (op) {
+                case TokenType::PLUS: result = wrap(ua + ub); return true;
+                case TokenType::MINUS: result = wrap(ua - ub); return true;
+                case TokenType::STAR: result = wrap(ua * ub); return true;
+                case TokenType::AMPERSAND: result = a & b; return true;
+                case TokenType::PIPE: result = a | b; return true;
+                case TokenType::CARET: result = a ^ b; return true;
+                case TokenType::SLASH:
+                case TokenType::PERECENT:
+                    // These trap at runtime, which folding must not turn into a value
+                    if (b == 0 || (a == std::numeric_limits<int64_t>::min() && b == -1))
+                        return false;
+                    result = op == TokenType::SLASH ? a / b : a % b;
+                    return true;
+                case TokenType::LESS_LESS:
+                    if (b < 0 || b >= 64)
+                        return false;
+                    result = wrap(ua << b);
+                    return true;
+                case TokenType::GREATER_GREATER:
+                    if (b < 0 || b >= 64)
+                        return false;
+                    result = a >> b;
+                    return true;
+                default:
+                    return compare(op, a, b, result);
+            }
+        }
+        case Runtime::Value::Type::DOUBLE: {
+            double a = left.as<double>();
+            double b = right.as<double>();
+
+            switch (op) {
+                case TokenType::PLUS: result = a + b; return true;
+                case TokenType::MINUS: result = a - b; return true;
+                case TokenType::STAR: result = a * b; return true;
+                case TokenType::SLASH: result = a / b; return true;
+                default: return compare(op, a, b, result);
+            }
+        }
+        case Runtime::Value::Type::STRING:
+            if (op == TokenType::PLUS) {
+                result = left.as<std::string>() + right.as<std::string>();
+                return true;
+            }
+            return compare(op, left.as<std::string>(), right.as<std::string>(), result);
+        case Runtime::Value::Type::CHAR:
+            return compare(op, left.as<char>(), right.as<char>(), result);
+        case Runtime::Value::Type::BOOL:
+            // `&&` and `||` are rejected at runtime, so only equality folds
+            if (op != TokenType::EQUAL_EQUAL && op != TokenType::BANG_EQUAL)
+                return false;
+            return compare(op, left.as<bool>(), right.as<bool>(), result);
+        default:
+            return false;
+    }
+}
+
+bool ConstantFolder::foldUnary(TokenType op, const Runtime::Value& right, Runtime::Value& result) {
+    switch (op) {
+        case TokenType::BANG:
+            if (!right.is<bool>())
+                return false;
+            result = !right.as<bool>();
+            return true;
+        case TokenType::TILDE:
+            if (!right.is<int64_t>())
+                return false;
+            result = ~right.as<int64_t>();
+            return true;
+        case TokenType::MINUS:
+            if (right.is<int64_t>())
+                result = wrap(0 - static_cast<uint64_t>(right.as<int64_t>()));
+            else if (right.is<double>())
+                result = -right.as<double>();
+            else
+                return false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ConstantFolder::replace(AstExpr& expr, const Runtime::Value& value, const std::string& before, size_t firstNote) {
+    AstExprPtr literal = makeLiteral(value, expr.line_);
+    literal->type_ = expr.type_;
+
+    // One note for the whole folded subtree rather than one per fold inside it
+    if (report_.enabled()) {
+        report_.truncate(firstNote);
+        report_.note(expr.line_, "fold", before + " => " + AstPrinter().print(*literal));
+    }
+
+    exprReplacement_ = std::move(literal);
+}
+
+void ConstantFolder::visitGroupExpr(AstExprGroup& expr) {
+    AstTransformer::visitGroupExpr(expr);
+
+    Runtime::Value value;
+    if (!collecting_ && literalValue(expr.expr_.get(), value))
+        exprReplacement_ = std::move(expr.expr_);
+}
+
+void ConstantFolder::visitUnaryExpr(AstExprUnary& expr) {
+    std::string before = report_.enabled() && !collecting_ ? AstPrinter().print(expr) : "";
+    size_t firstNote = report_.size();
+
+    AstTransformer::visitUnaryExpr(expr);
+    if (collecting_)
+        return;
+
+    Runtime::Value right;
+    Runtime::Value result;
+    if (literalValue(expr.right_.get(), right) && foldUnary(expr.op_.type_, right, result))
+        replace(expr, result, before, firstNote);
+}
+
+void ConstantFolder::visitBinaryExpr(AstExprBinary& expr) {
+    std::string before = report_.enabled() && !collecting_ ? AstPrinter().print(expr) : "";
+    size_t firstNote = report_.size();
+
+    AstTransformer::visitBinaryExpr(expr);
+    if (collecting_)
+        return;
+
+    Runtime::Value left;
+    Runtime::Value right;
+    Runtime::Value result;
+    if (literalValue(expr.left_.get(), left) && literalValue(expr.right_.get(), right) && foldBinary(left, expr.op_.type_, right, result))
+        replace(expr, result, before, firstNote);
+}
+
+void ConstantFolder::visitTernaryExpr(AstExprTernary& expr) {
+    std::string before = report_.enabled() && !collecting_ ? AstPrinter().print(expr) : "";
+    size_t firstNote = report_.size();
+
+    AstTransformer::visitTernaryExpr(expr);
+    if (collecting_)
+        return;
+
+    // The branch not taken is never evaluated, so it can go whatever it contains
+    Runtime::Value condition;
+    if (!literalValue(expr.condition_.get(), condition) || !condition.is<bool>())
+        return;
+
+    AstExprPtr taken = std::move(condition.as<bool>() ? expr.thenBranch_ : expr.elseBranch_);
+    if (report_.enabled()) {
+        report_.truncate(firstNote);
+        report_.note(expr.line_, "fold", before + " => " + AstPrinter().print(*taken));
+    }
+
+    exprReplacement_ = std::move(taken);
+}
+
+void ConstantFolder::visitVariableExpr(AstExprVariable& expr) {
+    if (collecting_)
+        return;
+
+    Binding* binding = lookup(expr.name_.lexeme_);
+    if (binding == nullptr || binding->assigned_ || binding->constant_ == nullptr)
+        return;
+
+    Runtime::Value value;
+    literalValue(binding->constant_, value);
+
+    AstExprPtr literal = makeLiteral(value, expr.line_);
+    literal->type_ = expr.type_;
+    report_.note(expr.line_, "propagate", "'" + expr.name_.lexeme_ + "' => " + AstPrinter().print(*literal));
+    exprReplacement_ = std::move(literal);
+}
+
+void ConstantFolder::visitAssignmentExpr(AstExprAssignment& expr) {
+    AstTransformer::visitAssignmentExpr(expr);
+
+    if (collecting_) {
+        if (Binding* binding = lookup(expr.name_.lexeme_))
+            binding->assigned_ = true;
+    }
+}
+
+void ConstantFolder::visitVarDeclStat(AstStatVarDecl& stat) {
+    AstTransformer::visitVarDeclStat(stat);
+
+    Binding& binding = declare(stat.name_.lexeme_, &stat);
+
+    // Strings are left alone: a string literal allocates every time it is evaluated, while a
+    // variable read only copies a reference
+    Runtime::Value value;
+    if (!collecting_ && literalValue(stat.initializer_.get(), value) && !value.is<std::string>())
+        binding.constant_ = stat.initializer_.get();
+}
+
+void ConstantFolder::visitForStat(AstStatFor& stat) {
+    scopes_.beginScope(false);
+    AstTransformer::visitForStat(stat);
+    scopes_.endScope();
+}
+
+void ConstantFolder::visitBlockStat(AstStatBlock& stat) {
+    scopes_.beginScope(false);
+    AstTransformer::visitBlockStat(stat);
+    scopes_.endScope();
+}
+
+void ConstantFolder::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    std::vector<Binding*> captured;
+    for (const Token& capture : stat.captures_)
+        captured.push_back(lookup(capture.lexeme_));
+    declare(stat.name_.lexeme_, &stat);
+
+    scopes_.beginScope(true);
+    for (size_t i = 0; i < stat.captures_.size(); i++) {
+        Binding& binding = declare(stat.captures_[i].lexeme_, &stat.captures_[i]);
+        if (!collecting_ && captured[i] != nullptr && !captured[i]->assigned_)
+            binding.constant_ = captured[i]->constant_;
+    }
+    declare(stat.name_.lexeme_, &stat.name_);
+
+    scopes_.beginScope(false);
+    for (const Token& param : stat.paramNames_)
+        declare(param.lexeme_, &param);
+    for (AstStatPtr& inner : body->body_)
+        transformStat(inner);
+
+    scopes_.endScope();
+    scopes_.endScope();
+}
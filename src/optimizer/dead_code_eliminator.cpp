@@ -0,0 +1,253 @@
+#include <latimer/optimizer/dead_code_eliminator.hpp>
+
+#include <latimer/utils/error_handler.hpp>
+
+namespace {
+
+// A removed statement is replaced by an empty block, which the enclosing block then splices away
+AstStatPtr removed(int line) {
+    return std::make_unique<AstStatBlock>(line, std::vector<AstStatPtr>());
+}
+
+bool declaresNothing(const AstStatBlock& block) {
+    for (const AstStatPtr& stat : block.body_) {
+        if (dynamic_cast<const AstStatVarDecl*>(stat.get()) || dynamic_cast<const AstStatFuncDecl*>(stat.get()))
+            return false;
+    }
+    return true;
+}
+
+// Whether control never reaches the statement after this one
+bool terminates(const AstStat& stat) {
+    if (dynamic_cast<const AstStatReturn*>(&stat) || dynamic_cast<const AstStatBreak*>(&stat) || dynamic_cast<const AstStatContinue*>(&stat))
+        return true;
+    if (auto block = dynamic_cast<const AstStatBlock*>(&stat))
+        return !block->body_.empty() && terminates(*block->body_.back());
+    if (auto ifElse = dynamic_cast<const AstStatIfElse*>(&stat))
+        return ifElse->elseBranch_ != nullptr && terminates(*ifElse->thenBranch_) && terminates(*ifElse->elseBranch_);
+    return false;
+}
+
+std::string describe(const AstStat& stat) {
+    if (dynamic_cast<const AstStatReturn*>(&stat))
+        return "'return'";
+    if (dynamic_cast<const AstStatBreak*>(&stat))
+        return "'break'";
+    if (dynamic_cast<const AstStatContinue*>(&stat))
+        return "'continue'";
+    return "a statement that always leaves the block";
+}
+
+const AstExprLiteralBool* literalCondition(const AstExpr* condition) {
+    return dynamic_cast<const AstExprLiteralBool*>(condition);
+}
+
+} // namespace
+
+DeadCodeEliminator::DeadCodeEliminator(OptimizationReport& report)
+    : report_(report)
+    , phase_(Phase::SIMPLIFY)
+    , uses_()
+    , removable_()
+    , scopes_() {}
+
+void DeadCodeEliminator::eliminate(std::vector<AstStatPtr>& statements) {
+    phase_ = Phase::SIMPLIFY;
+    transform(statements);
+    simplify(statements);
+
+    phase_ = Phase::COUNT;
+    scopes_.beginScope(false);
+    transform(statements);
+    scopes_.endScope();
+
+    // The top level only declares globals, which are kept
+    phase_ = Phase::SWEEP;
+    transform(statements);
+    simplify(statements);
+}
+
+void DeadCodeEliminator::simplify(std::vector<AstStatPtr>& statements) {
+    std::vector<AstStatPtr> kept;
+
+    for (size_t i = 0; i < statements.size(); i++) {
+        AstStatPtr& stat = statements[i];
+        auto block = dynamic_cast<AstStatBlock*>(stat.get());
+
+        if (block != nullptr && declaresNothing(*block)) {
+            // Inner blocks were simplified first, so this only splices statements that all run
+            for (AstStatPtr& inner : block->body_)
+                kept.push_back(std::move(inner));
+            if (kept.empty() || !terminates(*kept.back()))
+                continue;
+        } else {
+            kept.push_back(std::move(stat));
+            if (!terminates(*kept.back()))
+                continue;
+        }
+
+        if (i + 1 < statements.size()) {
+            report_.note(statements[i + 1]->line_, "dce", "removed " + std::to_string(statements.size() - i - 1) + " unreachable statement(s) after " + describe(*kept.back()));
+        }
+        break;
+    }
+
+    statements = std::move(kept);
+}
+
+void DeadCodeEliminator::sweep(std::vector<AstStatPtr>& statements) {
+    std::vector<AstStatPtr> kept;
+
+    for (AstStatPtr& stat : statements) {
+        auto decl = dynamic_cast<const AstStatVarDecl*>(stat.get());
+        if (decl != nullptr && removable_.count(decl) && uses_[decl] == 0) {
+            report_.note(decl->line_, "dce", "removed unused local '" + decl->name_.lexeme_ + "'");
+            continue;
+        }
+
+        kept.push_back(std::move(stat));
+    }
+
+    statements = std::move(kept);
+}
+
+void DeadCodeEliminator::use(const std::string& name) {
+    if (const void* key = scopes_.lookup(name))
+        uses_[key]++;
+}
+
+bool DeadCodeEliminator::isPure(const AstExpr* expr) const {
+    if (expr == nullptr)
+        return true;
+    if (auto group = dynamic_cast<const AstExprGroup*>(expr))
+        return isPure(group->expr_.get());
+    // Reading an unresolved variable is a runtime error
+    if (auto variable = dynamic_cast<const AstExprVariable*>(expr))
+        return scopes_.lookup(variable->name_.lexeme_) != nullptr;
+
+    return dynamic_cast<const AstExprLiteralNull*>(expr)
+        || dynamic_cast<const AstExprLiteralBool*>(expr)
+        || dynamic_cast<const AstExprLiteralInt*>(expr)
+        || dynamic_cast<const AstExprLiteralDouble*>(expr)
+        || dynamic_cast<const AstExprLiteralChar*>(expr)
+        || dynamic_cast<const AstExprLiteralString*>(expr);
+}
+
+void DeadCodeEliminator::visitVariableExpr(AstExprVariable& expr) {
+    if (phase_ == Phase::COUNT)
+        use(expr.name_.lexeme_);
+}
+
+void DeadCodeEliminator::visitAssignmentExpr(AstExprAssignment& expr) {
+    AstTransformer::visitAssignmentExpr(expr);
+
+    if (phase_ == Phase::COUNT)
+        use(expr.name_.lexeme_);
+}
+
+void DeadCodeEliminator::visitVarDeclStat(AstStatVarDecl& stat) {
+    AstTransformer::visitVarDeclStat(stat);
+    if (phase_ != Phase::COUNT)
+        return;
+
+    if (!scopes_.atGlobalScope() && isPure(stat.initializer_.get()))
+        removable_.insert(&stat);
+    scopes_.declare(stat.name_.lexeme_, &stat);
+}
+
+void DeadCodeEliminator::visitIfElseStat(AstStatIfElse& stat) {
+    AstTransformer::visitIfElseStat(stat);
+    if (phase_ != Phase::SIMPLIFY)
+        return;
+
+    const AstExprLiteralBool* condition = literalCondition(stat.condition_.get());
+    if (condition == nullptr)
+        return;
+
+    if (condition->value_) {
+        report_.note(stat.line_, "dce", "'if (true)' reduced to its then branch");
+        statReplacement_ = std::move(stat.thenBranch_);
+    } else if (stat.elseBranch_ != nullptr) {
+        report_.note(stat.line_, "dce", "'if (false)' reduced to its else branch");
+        statReplacement_ = std::move(stat.elseBranch_);
+    } else {
+        report_.note(stat.line_, "dce", "removed 'if (false)'");
+        statReplacement_ = removed(stat.line_);
+    }
+}
+
+void DeadCodeEliminator::visitWhileStat(AstStatWhile& stat) {
+    AstTransformer::visitWhileStat(stat);
+    if (phase_ != Phase::SIMPLIFY)
+        return;
+
+    const AstExprLiteralBool* condition = literalCondition(stat.condition_.get());
+    if (condition != nullptr && !condition->value_) {
+        report_.note(stat.line_, "dce", "removed 'while (false)'");
+        statReplacement_ = removed(stat.line_);
+    }
+}
+
+void DeadCodeEliminator::visitForStat(AstStatFor& stat) {
+    if (phase_ == Phase::COUNT) {
+        scopes_.beginScope(false);
+        AstTransformer::visitForStat(stat);
+        scopes_.endScope();
+        return;
+    }
+
+    AstTransformer::visitForStat(stat);
+    if (phase_ != Phase::SIMPLIFY)
+        return;
+
+    const AstExprLiteralBool* condition = literalCondition(stat.condition_.get());
+    if (condition == nullptr || condition->value_)
+        return;
+
+    // The initializer still runs once, in a scope of its own like the loop's
+    report_.note(stat.line_, "dce", "removed 'for' loop whose condition is false");
+    std::vector<AstStatPtr> initializer;
+    if (stat.initializer_ != nullptr)
+        initializer.push_back(std::move(stat.initializer_));
+    statReplacement_ = std::make_unique<AstStatBlock>(stat.line_, std::move(initializer));
+}
+
+void DeadCodeEliminator::visitBlockStat(AstStatBlock& stat) {
+    switch (phase_) {
+        case Phase::SIMPLIFY:
+            AstTransformer::visitBlockStat(stat);
+            simplify(stat.body_);
+            break;
+        case Phase::COUNT:
+            scopes_.beginScope(false);
+            AstTransformer::visitBlockStat(stat);
+            scopes_.endScope();
+            break;
+        case Phase::SWEEP:
+            // Blocks left without declarations can now be spliced too
+            AstTransformer::visitBlockStat(stat);
+            sweep(stat.body_);
+            simplify(stat.body_);
+            break;
+    }
+}
+
+void DeadCodeEliminator::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    // Simplifying and sweeping only need the body's statements, which visitBlockStat handles
+    if (phase_ != Phase::COUNT) {
+        AstTransformer::visitFuncDeclStat(stat);
+        return;
+    }
+
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    for (const Token& capture : stat.captures_)
+        use(capture.lexeme_);
+
+    scopes_.beginFunction(stat);
+    for (AstStatPtr& inner : body->body_)
+        transformStat(inner);
+    scopes_.endFunction();
+}
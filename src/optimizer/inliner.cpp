@@ -0,0 +1,275 @@
+#include <latimer/optimizer/inliner.hpp>
+
+#include <latimer/utils/ast_printer.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+namespace {
+
+bool isLiteral(const AstExpr& expr) {
+    return dynamic_cast<const AstExprLiteralNull*>(&expr)
+        || dynamic_cast<const AstExprLiteralBool*>(&expr)
+        || dynamic_cast<const AstExprLiteralInt*>(&expr)
+        || dynamic_cast<const AstExprLiteralDouble*>(&expr)
+        || dynamic_cast<const AstExprLiteralChar*>(&expr)
+        || dynamic_cast<const AstExprLiteralString*>(&expr);
+}
+
+int paramIndex(const AstStatFuncDecl& decl, const std::string& name) {
+    for (size_t i = 0; i < decl.paramNames_.size(); i++) {
+        if (decl.paramNames_[i].lexeme_ == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// The expression of a body that is exactly `{ return <expr>; }`
+const AstExpr* returnedExpr(const AstStatFuncDecl& decl) {
+    auto body = dynamic_cast<const AstStatBlock*>(decl.body_.get());
+    if (body == nullptr || body->body_.size() != 1)
+        return nullptr;
+
+    auto ret = dynamic_cast<const AstStatReturn*>(body->body_[0].get());
+    return ret != nullptr ? ret->value_.get() : nullptr;
+}
+
+} // namespace
+
+Inliner::Inliner(OptimizationReport& report)
+    : report_(report)
+    , collecting_(false)
+    , scopes_()
+    , candidates_() {}
+
+void Inliner::inlineCalls(std::vector<AstStatPtr>& statements) {
+    collecting_ = true;
+    walk(statements);
+
+    collecting_ = false;
+    walk(statements);
+}
+
+void Inliner::walk(std::vector<AstStatPtr>& statements) {
+    scopes_.beginScope(false);
+    transform(statements);
+    scopes_.endScope();
+}
+
+// Called with the function's body scopes still open, once its own calls have been inlined
+void Inliner::analyze(const AstStatFuncDecl& decl) {
+    const AstExpr* body = returnedExpr(decl);
+    if (body == nullptr)
+        return;
+
+    Candidate candidate{&decl, body, std::vector<size_t>(decl.paramNames_.size(), 0), std::vector<bool>(decl.paramNames_.size(), false), {}, 0, false, true};
+    scan(*body, decl, candidate, false);
+    if (candidate.inlinable_ && candidate.size_ <= MAX_BODY_NODES)
+        candidates_[&decl] = std::move(candidate);
+}
+
+void Inliner::scan(const AstExpr& expr, const AstStatFuncDecl& decl, Candidate& candidate, bool conditional) {
+    candidate.size_++;
+
+    if (auto group = dynamic_cast<const AstExprGroup*>(&expr)) {
+        scan(*group->expr_, decl, candidate, conditional);
+    } else if (auto unary = dynamic_cast<const AstExprUnary*>(&expr)) {
+        scan(*unary->right_, decl, candidate, conditional);
+    } else if (auto binary = dynamic_cast<const AstExprBinary*>(&expr)) {
+        scan(*binary->left_, decl, candidate, conditional);
+        scan(*binary->right_, decl, candidate, conditional);
+    } else if (auto ternary = dynamic_cast<const AstExprTernary*>(&expr)) {
+        scan(*ternary->condition_, decl, candidate, conditional);
+        scan(*ternary->thenBranch_, decl, candidate, true);
+        scan(*ternary->elseBranch_, decl, candidate, true);
+    } else if (auto call = dynamic_cast<const AstExprCall*>(&expr)) {
+        candidate.calls_ = true;
+        scan(*call->callee_, decl, candidate, conditional);
+        for (const AstExprPtr& arg : call->args_)
+            scan(*arg, decl, candidate, conditional);
+    } else if (auto variable = dynamic_cast<const AstExprVariable*>(&expr)) {
+        int param = paramIndex(decl, variable->name_.lexeme_);
+        if (param >= 0) {
+            candidate.uses_[param]++;
+            if (conditional)
+                candidate.conditional_[param] = true;
+            return;
+        }
+
+        // A capture, a native, or the function itself, which would make inlining recurse
+        const void* key = scopes_.lookup(variable->name_.lexeme_);
+        if (key == &decl.name_)
+            candidate.inlinable_ = false;
+        candidate.names_.push_back({variable->name_.lexeme_, key});
+    } else if (!isLiteral(expr)) {
+        // Assignments, and the typed operators that only appear after the TypeSpecializer
+        candidate.inlinable_ = false;
+    }
+}
+
+// Can be read at each of its uses in the body instead of once before it
+bool Inliner::simpleArgument(const AstExpr& arg, bool bodyCalls) const {
+    if (isLiteral(arg))
+        return true;
+
+    auto variable = dynamic_cast<const AstExprVariable*>(&arg);
+    if (variable == nullptr)
+        return false;
+
+    const void* key = scopes_.lookup(variable->name_.lexeme_);
+    if (key == nullptr)
+        return false;
+
+    // Locals belong to one invocation, but a capture lives in the closure, which a call the body
+    // makes could reach and assign
+    return !bodyCalls || !scopes_.isCopy(key) || !scopes_.isAssigned(key);
+}
+
+// Neither calls nor assigns anything
+bool Inliner::pureArgument(const AstExpr& arg) const {
+    if (isLiteral(arg))
+        return true;
+    if (auto variable = dynamic_cast<const AstExprVariable*>(&arg))
+        return scopes_.lookup(variable->name_.lexeme_) != nullptr;
+    if (auto group = dynamic_cast<const AstExprGroup*>(&arg))
+        return pureArgument(*group->expr_);
+    if (auto unary = dynamic_cast<const AstExprUnary*>(&arg))
+        return pureArgument(*unary->right_);
+    if (auto binary = dynamic_cast<const AstExprBinary*>(&arg))
+        return pureArgument(*binary->left_) && pureArgument(*binary->right_);
+    if (auto ternary = dynamic_cast<const AstExprTernary*>(&arg))
+        return pureArgument(*ternary->condition_) && pureArgument(*ternary->thenBranch_) && pureArgument(*ternary->elseBranch_);
+    return false;
+}
+
+// Copies an expression, replacing reads of callee's parameters with copies of args when given. The
+// copies are placed on `line`, the call site, so what later passes report about an inlined body
+// points at the call; substituted arguments, and every node when `line` is negative, keep their own.
+AstExprPtr Inliner::clone(const AstExpr& expr, const AstStatFuncDecl* callee, const std::vector<AstExprPtr>* args, int line) const {
+    AstExprPtr copy;
+    int at = line < 0 ? expr.line_ : line;
+
+    if (auto group = dynamic_cast<const AstExprGroup*>(&expr)) {
+        copy = std::make_unique<AstExprGroup>(at, clone(*group->expr_, callee, args, line));
+    } else if (auto unary = dynamic_cast<const AstExprUnary*>(&expr)) {
+        copy = std::make_unique<AstExprUnary>(at, unary->op_, clone(*unary->right_, callee, args, line));
+    } else if (auto binary = dynamic_cast<const AstExprBinary*>(&expr)) {
+        copy = std::make_unique<AstExprBinary>(at, clone(*binary->left_, callee, args, line), binary->op_, clone(*binary->right_, callee, args, line));
+    } else if (auto ternary = dynamic_cast<const AstExprTernary*>(&expr)) {
+        copy = std::make_unique<AstExprTernary>(at, clone(*ternary->condition_, callee, args, line), clone(*ternary->thenBranch_, callee, args, line), clone(*ternary->elseBranch_, callee, args, line));
+    } else if (auto call = dynamic_cast<const AstExprCall*>(&expr)) {
+        std::vector<AstExprPtr> callArgs;
+        for (const AstExprPtr& arg : call->args_)
+            callArgs.push_back(clone(*arg, callee, args, line));
+        copy = std::make_unique<AstExprCall>(at, clone(*call->callee_, callee, args, line), std::move(callArgs));
+    } else if (auto variable = dynamic_cast<const AstExprVariable*>(&expr)) {
+        int param = callee != nullptr ? paramIndex(*callee, variable->name_.lexeme_) : -1;
+        if (param >= 0) {
+            // The argument keeps the parameter's static type, which the TypeSpecializer goes by
+            copy = clone(*(*args)[param], nullptr, nullptr, -1);
+            copy->type_ = expr.type_;
+            return copy;
+        }
+        copy = std::make_unique<AstExprVariable>(at, variable->name_);
+    } else if (dynamic_cast<const AstExprLiteralNull*>(&expr)) {
+        copy = std::make_unique<AstExprLiteralNull>(at);
+    } else if (auto literal = dynamic_cast<const AstExprLiteralBool*>(&expr)) {
+        copy = std::make_unique<AstExprLiteralBool>(at, literal->value_);
+    } else if (auto literal = dynamic_cast<const AstExprLiteralInt*>(&expr)) {
+        copy = std::make_unique<AstExprLiteralInt>(at, literal->value_);
+    } else if (auto literal = dynamic_cast<const AstExprLiteralDouble*>(&expr)) {
+        copy = std::make_unique<AstExprLiteralDouble>(at, literal->value_);
+    } else if (auto literal = dynamic_cast<const AstExprLiteralChar*>(&expr)) {
+        copy = std::make_unique<AstExprLiteralChar>(at, literal->value_);
+    } else if (auto literal = dynamic_cast<const AstExprLiteralString*>(&expr)) {
+        copy = std::make_unique<AstExprLiteralString>(at, literal->value_);
+    } else {
+        throw InternalCompilerError("[Internal Compiler Error]: Inliner cannot copy this expression.");
+    }
+
+    copy->type_ = expr.type_;
+    return copy;
+}
+
+void Inliner::visitAssignmentExpr(AstExprAssignment& expr) {
+    AstTransformer::visitAssignmentExpr(expr);
+
+    if (collecting_) {
+        if (const void* key = scopes_.lookup(expr.name_.lexeme_))
+            scopes_.markAssigned(key);
+    }
+}
+
+void Inliner::visitCallExpr(AstExprCall& expr) {
+    AstTransformer::visitCallExpr(expr);
+    if (collecting_)
+        return;
+
+    const AstExpr* callee = expr.callee_.get();
+    while (auto group = dynamic_cast<const AstExprGroup*>(callee))
+        callee = group->expr_.get();
+    auto variable = dynamic_cast<const AstExprVariable*>(callee);
+    if (variable == nullptr)
+        return;
+
+    auto found = candidates_.find(scopes_.origin(scopes_.lookup(variable->name_.lexeme_)));
+    if (found == candidates_.end())
+        return;
+
+    const Candidate& candidate = found->second;
+    const AstStatFuncDecl& decl = *candidate.decl_;
+    if (expr.args_.size() != decl.paramNames_.size())
+        return;
+
+    for (const auto& [name, key] : candidate.names_) {
+        const void* here = scopes_.lookup(name);
+        if (key == nullptr ? here != nullptr : (scopes_.origin(here) == nullptr || scopes_.origin(here) != scopes_.origin(key)))
+            return;
+    }
+
+    for (size_t i = 0; i < expr.args_.size(); i++) {
+        const AstExpr& arg = *expr.args_[i];
+        if (simpleArgument(arg, candidate.calls_))
+            continue;
+        if (candidate.uses_[i] != 1 || candidate.conditional_[i] || candidate.calls_ || !pureArgument(arg))
+            return;
+    }
+
+    std::string before = report_.enabled() ? AstPrinter().print(expr) : "";
+    auto inlined = std::make_unique<AstExprGroup>(expr.line_, clone(*candidate.body_, &decl, &expr.args_, expr.line_));
+    inlined->type_ = expr.type_;
+    if (report_.enabled())
+        report_.note(expr.line_, "inline", before + " => " + AstPrinter().print(*inlined) + " ('" + decl.name_.lexeme_ + "' from line " + std::to_string(decl.line_) + ")");
+
+    exprReplacement_ = std::move(inlined);
+}
+
+void Inliner::visitVarDeclStat(AstStatVarDecl& stat) {
+    AstTransformer::visitVarDeclStat(stat);
+    scopes_.declare(stat.name_.lexeme_, &stat);
+}
+
+void Inliner::visitForStat(AstStatFor& stat) {
+    scopes_.beginScope(false);
+    AstTransformer::visitForStat(stat);
+    scopes_.endScope();
+}
+
+void Inliner::visitBlockStat(AstStatBlock& stat) {
+    scopes_.beginScope(false);
+    AstTransformer::visitBlockStat(stat);
+    scopes_.endScope();
+}
+
+void Inliner::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    scopes_.beginFunction(stat);
+    for (AstStatPtr& inner : body->body_)
+        transformStat(inner);
+
+    if (!collecting_)
+        analyze(stat);
+
+    scopes_.endFunction();
+}
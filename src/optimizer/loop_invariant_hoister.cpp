@@ -0,0 +1,272 @@
+#include <latimer/optimizer/loop_invariant_hoister.hpp>
+
+#include <latimer/utils/ast_printer.hpp>
+#include <latimer/utils/error_handler.hpp>
+
+namespace {
+
+// Collects the names a loop assigns or declares. Nested function bodies are skipped: whatever they
+// assign belongs to the function.
+class LoopWrites : public AstTransformer {
+public:
+    explicit LoopWrites(std::unordered_set<std::string>& names)
+        : names_(names) {}
+
+    void collect(AstStat& loop) {
+        loop.accept(*this);
+    }
+
+private:
+    std::unordered_set<std::string>& names_;
+
+    void visitAssignmentExpr(AstExprAssignment& expr) override {
+        AstTransformer::visitAssignmentExpr(expr);
+        names_.insert(expr.name_.lexeme_);
+    }
+
+    void visitVarDeclStat(AstStatVarDecl& stat) override {
+        AstTransformer::visitVarDeclStat(stat);
+        names_.insert(stat.name_.lexeme_);
+    }
+
+    void visitFuncDeclStat(AstStatFuncDecl& stat) override {
+        names_.insert(stat.name_.lexeme_);
+    }
+};
+
+// Integer `/` and `%` trap rather than fail, and strings are left where they are
+bool hoistable(AstExprTypedBinary::Kind kind) {
+    switch (kind) {
+        case AstExprTypedBinary::INT_DIVIDE:
+        case AstExprTypedBinary::INT_MODULO:
+        case AstExprTypedBinary::STRING_CONCAT:
+        case AstExprTypedBinary::STRING_LESS:
+        case AstExprTypedBinary::STRING_LESS_EQUAL:
+        case AstExprTypedBinary::STRING_GREATER:
+        case AstExprTypedBinary::STRING_GREATER_EQUAL:
+        case AstExprTypedBinary::STRING_EQUAL:
+        case AstExprTypedBinary::STRING_NOT_EQUAL:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// A copy of an expression isInvariant accepted, for the temporary to compute before the loop while
+// the loop keeps the original
+AstExprPtr cloneInvariant(const AstExpr& expr) {
+    AstExprPtr copy;
+    if (auto group = dynamic_cast<const AstExprGroup*>(&expr))
+        copy = std::make_unique<AstExprGroup>(expr.line_, cloneInvariant(*group->expr_));
+    else if (auto unary = dynamic_cast<const AstExprTypedUnary*>(&expr))
+        copy = std::make_unique<AstExprTypedUnary>(expr.line_, unary->op_, cloneInvariant(*unary->right_), unary->kind_);
+    else if (auto binary = dynamic_cast<const AstExprTypedBinary*>(&expr))
+        copy = std::make_unique<AstExprTypedBinary>(expr.line_, cloneInvariant(*binary->left_), binary->op_, cloneInvariant(*binary->right_), binary->kind_);
+    else if (auto hoisted = dynamic_cast<const AstExprHoisted*>(&expr))
+        copy = std::make_unique<AstExprHoisted>(expr.line_, hoisted->name_, cloneInvariant(*hoisted->expr_));
+    else if (auto variable = dynamic_cast<const AstExprVariable*>(&expr))
+        copy = std::make_unique<AstExprVariable>(expr.line_, variable->name_);
+    else if (auto literal = dynamic_cast<const AstExprLiteralBool*>(&expr))
+        copy = std::make_unique<AstExprLiteralBool>(expr.line_, literal->value_);
+    else if (auto literal = dynamic_cast<const AstExprLiteralInt*>(&expr))
+        copy = std::make_unique<AstExprLiteralInt>(expr.line_, literal->value_);
+    else if (auto literal = dynamic_cast<const AstExprLiteralDouble*>(&expr))
+        copy = std::make_unique<AstExprLiteralDouble>(expr.line_, literal->value_);
+    else if (auto literal = dynamic_cast<const AstExprLiteralChar*>(&expr))
+        copy = std::make_unique<AstExprLiteralChar>(expr.line_, literal->value_);
+    else
+        throw InternalCompilerError("[Internal Compiler Error]: Hoisting an expression that is not loop invariant.");
+
+    copy->type_ = expr.type_;
+    return copy;
+}
+
+} // namespace
+
+LoopInvariantHoister::LoopInvariantHoister(OptimizationReport& report)
+    : report_(report)
+    , scopes_()
+    , temporaries_(0)
+    , extracting_(false)
+    , loopLine_(0)
+    , variant_()
+    , hoisted_()
+    , preheader_() {}
+
+void LoopInvariantHoister::hoist(std::vector<AstStatPtr>& statements) {
+    scopes_.beginScope(false);
+    transform(statements);
+    scopes_.endScope();
+}
+
+// Outer loops go first, so an expression invariant in several nested loops leaves all of them
+std::vector<AstStatPtr> LoopInvariantHoister::hoistOutOf(AstStat& loop, std::vector<AstExprPtr*> expressions, AstStatPtr& body) {
+    variant_.clear();
+    hoisted_.clear();
+    preheader_.clear();
+    LoopWrites(variant_).collect(loop);
+
+    extracting_ = true;
+    loopLine_ = loop.line_;
+    for (AstExprPtr* expr : expressions)
+        transformExpr(*expr);
+    transformStat(body);
+    extracting_ = false;
+
+    return std::move(preheader_);
+}
+
+// The temporaries are visible to the loop, and to the loops nested in it
+void LoopInvariantHoister::enterPreheader(const std::vector<AstStatPtr>& preheader) {
+    scopes_.beginScope(false);
+    for (const AstStatPtr& stat : preheader) {
+        auto decl = static_cast<const AstStatVarDecl*>(stat.get());
+        scopes_.declare(decl->name_.lexeme_, decl);
+    }
+}
+
+// Replaces the loop with a block declaring the temporaries, then running the loop
+void LoopInvariantHoister::wrapInPreheader(std::vector<AstStatPtr> preheader, AstStatPtr loop) {
+    scopes_.endScope();
+
+    int line = loop->line_;
+    preheader.push_back(std::move(loop));
+    statReplacement_ = std::make_unique<AstStatBlock>(line, std::move(preheader));
+}
+
+bool LoopInvariantHoister::isInvariant(const AstExpr* expr) const {
+    if (auto group = dynamic_cast<const AstExprGroup*>(expr))
+        return isInvariant(group->expr_.get());
+    if (auto unary = dynamic_cast<const AstExprTypedUnary*>(expr))
+        return isInvariant(unary->right_.get());
+    if (auto binary = dynamic_cast<const AstExprTypedBinary*>(expr))
+        return hoistable(binary->kind_) && isInvariant(binary->left_.get()) && isInvariant(binary->right_.get());
+    if (auto variable = dynamic_cast<const AstExprVariable*>(expr))
+        return !variant_.count(variable->name_.lexeme_) && scopes_.lookup(variable->name_.lexeme_) != nullptr;
+
+    return dynamic_cast<const AstExprLiteralBool*>(expr)
+        || dynamic_cast<const AstExprLiteralInt*>(expr)
+        || dynamic_cast<const AstExprLiteralDouble*>(expr)
+        || dynamic_cast<const AstExprLiteralChar*>(expr);
+}
+
+void LoopInvariantHoister::extract(AstExprPtr expr) {
+    std::string printed = AstPrinter().print(*expr);
+    int line = expr->line_;
+    TypePtr type = expr->type_;
+
+    auto found = hoisted_.find(printed);
+    if (found == hoisted_.end()) {
+        // `$` cannot start an identifier, so the temporaries never clash with the script's names
+        std::string name = "$licm" + std::to_string(temporaries_++);
+        found = hoisted_.insert({printed, name}).first;
+        report_.note(line, "licm", "'" + printed + "' hoisted out of the loop at line " + std::to_string(loopLine_));
+
+        // Nothing after the Checker reads declared types, so the temporary does without one
+        Token token(TokenType::IDENTIFIER, name, std::monostate(), loopLine_);
+        auto decl = std::make_unique<AstStatVarDecl>(loopLine_, nullptr, token, cloneInvariant(*expr));
+        decl->speculative_ = true;
+        preheader_.push_back(std::move(decl));
+    }
+
+    auto hoisted = std::make_unique<AstExprHoisted>(line, Token(TokenType::IDENTIFIER, found->second, std::monostate(), line), std::move(expr));
+    hoisted->type_ = type;
+    exprReplacement_ = std::move(hoisted);
+}
+
+// Already hoisted out of an outer loop, so an inner one only reads the temporary
+void LoopInvariantHoister::visitHoistedExpr(AstExprHoisted& expr) {
+}
+
+// A visit cannot move its own node, so an expression being hoisted is rebuilt from its parts
+void LoopInvariantHoister::visitTypedUnaryExpr(AstExprTypedUnary& expr) {
+    if (!extracting_ || !isInvariant(&expr)) {
+        AstTransformer::visitUnaryExpr(expr);
+        return;
+    }
+
+    auto moved = std::make_unique<AstExprTypedUnary>(expr.line_, expr.op_, std::move(expr.right_), expr.kind_);
+    moved->type_ = expr.type_;
+    extract(std::move(moved));
+}
+
+void LoopInvariantHoister::visitTypedBinaryExpr(AstExprTypedBinary& expr) {
+    if (!extracting_ || !isInvariant(&expr)) {
+        AstTransformer::visitBinaryExpr(expr);
+        return;
+    }
+
+    auto moved = std::make_unique<AstExprTypedBinary>(expr.line_, std::move(expr.left_), expr.op_, std::move(expr.right_), expr.kind_);
+    moved->type_ = expr.type_;
+    extract(std::move(moved));
+}
+
+void LoopInvariantHoister::visitVarDeclStat(AstStatVarDecl& stat) {
+    AstTransformer::visitVarDeclStat(stat);
+
+    if (!extracting_)
+        scopes_.declare(stat.name_.lexeme_, &stat);
+}
+
+void LoopInvariantHoister::visitWhileStat(AstStatWhile& stat) {
+    if (extracting_) {
+        AstTransformer::visitWhileStat(stat);
+        return;
+    }
+
+    std::vector<AstStatPtr> preheader = hoistOutOf(stat, {&stat.condition_}, stat.body_);
+    if (preheader.empty()) {
+        AstTransformer::visitWhileStat(stat);
+        return;
+    }
+
+    enterPreheader(preheader);
+    AstTransformer::visitWhileStat(stat);
+    wrapInPreheader(std::move(preheader), std::make_unique<AstStatWhile>(stat.line_, std::move(stat.condition_), std::move(stat.body_)));
+}
+
+void LoopInvariantHoister::visitForStat(AstStatFor& stat) {
+    if (extracting_) {
+        AstTransformer::visitForStat(stat);
+        return;
+    }
+
+    // The initializer runs once, so there is nothing to gain from it
+    std::vector<AstStatPtr> preheader = hoistOutOf(stat, {&stat.condition_, &stat.increment_}, stat.body_);
+    bool hoisted = !preheader.empty();
+    if (hoisted)
+        enterPreheader(preheader);
+
+    scopes_.beginScope(false);
+    AstTransformer::visitForStat(stat);
+    scopes_.endScope();
+
+    if (hoisted)
+        wrapInPreheader(std::move(preheader), std::make_unique<AstStatFor>(stat.line_, std::move(stat.initializer_), std::move(stat.condition_), std::move(stat.increment_), std::move(stat.body_)));
+}
+
+void LoopInvariantHoister::visitBlockStat(AstStatBlock& stat) {
+    if (extracting_) {
+        AstTransformer::visitBlockStat(stat);
+        return;
+    }
+
+    scopes_.beginScope(false);
+    AstTransformer::visitBlockStat(stat);
+    scopes_.endScope();
+}
+
+void LoopInvariantHoister::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    // A nested function's body runs when it is called, not as part of the loop
+    if (extracting_)
+        return;
+
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    scopes_.beginFunction(stat);
+    for (AstStatPtr& inner : body->body_)
+        transformStat(inner);
+    scopes_.endFunction();
+}
@@ -0,0 +1,40 @@
+#include <latimer/optimizer/optimization_report.hpp>
+
+#include <map>
+
+OptimizationReport::OptimizationReport(bool enabled)
+    : enabled_(enabled)
+    , entries_() {}
+
+bool OptimizationReport::enabled() const {
+    return enabled_;
+}
+
+void OptimizationReport::note(int line, const std::string& pass, std::string message) {
+    if (enabled_)
+        entries_.push_back({line, pass, std::move(message)});
+}
+
+size_t OptimizationReport::size() const {
+    return entries_.size();
+}
+
+void OptimizationReport::truncate(size_t size) {
+    if (size < entries_.size())
+        entries_.resize(size);
+}
+
+void OptimizationReport::print(std::ostream& out) const {
+    std::map<std::string, size_t> counts;
+    for (const Entry& entry : entries_) {
+        out << "[line " << entry.line_ << "] " << entry.pass_ << ": " << entry.message_ << std::endl;
+        counts[entry.pass_]++;
+    }
+
+    out << "optimizations:";
+    if (counts.empty())
+        out << " none";
+    for (const auto& count : counts)
+        out << " " << count.first << "=" << count.second;
+    out << std::endl;
+}
@@ -0,0 +1,93 @@
+#include <latimer/optimizer/purity_analyzer.hpp>
+
+#include <latimer/utils/error_handler.hpp>
+
+void PurityAnalyzer::analyze(std::vector<AstStatPtr>& statements) {
+    scopes_.beginScope(false);
+    transform(statements);
+    scopes_.endScope();
+
+    // Optimistic start: a function stays pure until it calls something that is not
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto& [key, function] : functions_) {
+            if (!function.pure_)
+                continue;
+
+            for (const void* callee : function.callees_) {
+                auto found = functions_.find(scopes_.origin(callee));
+                if (found == functions_.end() || !found->second.pure_) {
+                    function.pure_ = false;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (auto& [key, function] : functions_)
+        function.decl_->pure_ = function.pure_;
+}
+
+void PurityAnalyzer::visitAssignmentExpr(AstExprAssignment& expr) {
+    AstTransformer::visitAssignmentExpr(expr);
+
+    const void* key = scopes_.lookup(expr.name_.lexeme_);
+    if (key == nullptr)
+        return;
+    scopes_.markAssigned(key);
+
+    // A body only sees past its locals into its own closure
+    if (scopes_.isCopy(key) && !running_.empty())
+        running_.back()->pure_ = false;
+}
+
+void PurityAnalyzer::visitCallExpr(AstExprCall& expr) {
+    AstTransformer::visitCallExpr(expr);
+    if (running_.empty())
+        return;
+
+    const AstExpr* callee = expr.callee_.get();
+    while (auto group = dynamic_cast<const AstExprGroup*>(callee))
+        callee = group->expr_.get();
+
+    auto variable = dynamic_cast<const AstExprVariable*>(callee);
+    if (variable == nullptr) {
+        running_.back()->pure_ = false;
+        return;
+    }
+
+    running_.back()->callees_.push_back(scopes_.lookup(variable->name_.lexeme_));
+}
+
+void PurityAnalyzer::visitVarDeclStat(AstStatVarDecl& stat) {
+    AstTransformer::visitVarDeclStat(stat);
+    scopes_.declare(stat.name_.lexeme_, &stat);
+}
+
+void PurityAnalyzer::visitForStat(AstStatFor& stat) {
+    scopes_.beginScope(false);
+    AstTransformer::visitForStat(stat);
+    scopes_.endScope();
+}
+
+void PurityAnalyzer::visitBlockStat(AstStatBlock& stat) {
+    scopes_.beginScope(false);
+    AstTransformer::visitBlockStat(stat);
+    scopes_.endScope();
+}
+
+void PurityAnalyzer::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    scopes_.beginFunction(stat);
+    running_.push_back(&functions_.insert({&stat, {&stat, true, {}}}).first->second);
+    for (AstStatPtr& inner : body->body_)
+        transformStat(inner);
+
+    running_.pop_back();
+    scopes_.endFunction();
+}
@@ -0,0 +1,80 @@
+#include <latimer/optimizer/scope_tracker.hpp>
+
+void ScopeTracker::beginScope(bool isClosure) {
+    scopes_.push_back({{}, isClosure});
+}
+
+void ScopeTracker::endScope() {
+    scopes_.pop_back();
+}
+
+bool ScopeTracker::atGlobalScope() const {
+    return scopes_.size() == 1;
+}
+
+void ScopeTracker::declare(const std::string& name, const void* key) {
+    scopes_.back().names_.insert({name, key});
+}
+
+const void* ScopeTracker::lookup(const std::string& name) const {
+    for (size_t i = scopes_.size(); i-- > 0;) {
+        auto found = scopes_[i].names_.find(name);
+        if (found != scopes_[i].names_.end())
+            return found->second;
+
+        // Closure environments have no enclosing environment at runtime
+        if (scopes_[i].isClosure_)
+            break;
+    }
+
+    return nullptr;
+}
+
+void ScopeTracker::beginFunction(const AstStatFuncDecl& decl) {
+    std::vector<const void*> captured;
+    for (const Token& capture : decl.captures_)
+        captured.push_back(lookup(capture.lexeme_));
+    declare(decl.name_.lexeme_, &decl);
+
+    beginScope(true);
+    for (size_t i = 0; i < decl.captures_.size(); i++) {
+        declare(decl.captures_[i].lexeme_, &decl.captures_[i]);
+        copies_[&decl.captures_[i]] = captured[i];
+    }
+    declare(decl.name_.lexeme_, &decl.name_);
+    copies_[&decl.name_] = &decl;
+
+    beginScope(false);
+    for (const Token& param : decl.paramNames_)
+        declare(param.lexeme_, &param);
+}
+
+void ScopeTracker::endFunction() {
+    endScope();
+    endScope();
+}
+
+void ScopeTracker::markAssigned(const void* key) {
+    assigned_.insert(key);
+}
+
+bool ScopeTracker::isAssigned(const void* key) const {
+    return assigned_.count(key) != 0;
+}
+
+bool ScopeTracker::isCopy(const void* key) const {
+    return copies_.count(key) != 0;
+}
+
+const void* ScopeTracker::origin(const void* key) const {
+    while (key != nullptr) {
+        if (assigned_.count(key) != 0)
+            return nullptr;
+
+        auto found = copies_.find(key);
+        if (found == copies_.end())
+            return key;
+        key = found->second;
+    }
+    return nullptr;
+}
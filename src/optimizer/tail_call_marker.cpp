@@ -0,0 +1,14 @@
+#include <latimer/optimizer/tail_call_marker.hpp>
+
+void TailCallMarker::mark(std::vector<AstStatPtr>& statements) {
+    transform(statements);
+}
+
+void TailCallMarker::visitReturnStat(AstStatReturn& stat) {
+    AstTransformer::visitReturnStat(stat);
+
+    while (auto* group = dynamic_cast<AstExprGroup*>(stat.value_.get()))
+        stat.value_ = std::move(group->expr_);
+
+    stat.tailCall_ = dynamic_cast<AstExprCall*>(stat.value_.get()) != nullptr;
+}
@@ -0,0 +1,131 @@
+#include <latimer/optimizer/type_specializer.hpp>
+
+namespace {
+
+bool primitiveKind(const TypePtr& type, PrimitiveType::PrimitiveKind& kind) {
+    if (type == nullptr || !std::holds_alternative<PrimitiveType>(type->type_))
+        return false;
+
+    kind = std::get<PrimitiveType>(type->type_).type_;
+    return true;
+}
+
+} // namespace
+
+bool TypeSpecializer::unaryKind(TokenType op, PrimitiveType::PrimitiveKind operand, AstExprTypedUnary::Kind& kind) {
+    switch (operand) {
+        case PrimitiveType::Integer:
+            if (op == TokenType::MINUS) { kind = AstExprTypedUnary::INT_NEGATE; return true; }
+            if (op == TokenType::TILDE) { kind = AstExprTypedUnary::INT_BIT_NOT; return true; }
+            return false;
+        case PrimitiveType::Double:
+            if (op == TokenType::MINUS) { kind = AstExprTypedUnary::DOUBLE_NEGATE; return true; }
+            return false;
+        case PrimitiveType::Boolean:
+            if (op == TokenType::BANG) { kind = AstExprTypedUnary::BOOL_NOT; return true; }
+            return false;
+        default:
+            return false;
+    }
+}
+
+bool TypeSpecializer::binaryKind(TokenType op, PrimitiveType::PrimitiveKind operands, AstExprTypedBinary::Kind& kind) {
+    switch (operands) {
+        case PrimitiveType::Integer:
+            switch (op) {
+                case TokenType::PLUS: kind = AstExprTypedBinary::INT_ADD; return true;
+                case TokenType::MINUS: kind = AstExprTypedBinary::INT_SUBTRACT; return true;
+                case TokenType::STAR: kind = AstExprTypedBinary::INT_MULTIPLY; return true;
+                case TokenType::SLASH: kind = AstExprTypedBinary::INT_DIVIDE; return true;
+                case TokenType::PERECENT: kind = AstExprTypedBinary::INT_MODULO; return true;
+                case TokenType::LESS_LESS: kind = AstExprTypedBinary::INT_SHIFT_LEFT; return true;
+                case TokenType::GREATER_GREATER: kind = AstExprTypedBinary::INT_SHIFT_RIGHT; return true;
+                case TokenType::AMPERSAND: kind = AstExprTypedBinary::INT_BIT_AND; return true;
+                case TokenType::PIPE: kind = AstExprTypedBinary::INT_BIT_OR; return true;
+                case TokenType::CARET: kind = AstExprTypedBinary::INT_BIT_XOR; return true;
+                case TokenType::LESS: kind = AstExprTypedBinary::INT_LESS; return true;
+                case TokenType::LESS_EQUAL: kind = AstExprTypedBinary::INT_LESS_EQUAL; return true;
+                case TokenType::GREATER: kind = AstExprTypedBinary::INT_GREATER; return true;
+                case TokenType::GREATER_EQUAL: kind = AstExprTypedBinary::INT_GREATER_EQUAL; return true;
+                case TokenType::EQUAL_EQUAL: kind = AstExprTypedBinary::INT_EQUAL; return true;
+                case TokenType::BANG_EQUAL: kind = AstExprTypedBinary::INT_NOT_EQUAL; return true;
+                default: return false;
+            }
+        case PrimitiveType::Double:
+            switch (op) {
+                case TokenType::PLUS: kind = AstExprTypedBinary::DOUBLE_ADD; return true;
+                case TokenType::MINUS: kind = AstExprTypedBinary::DOUBLE_SUBTRACT; return true;
+                case TokenType::STAR: kind = AstExprTypedBinary::DOUBLE_MULTIPLY; return true;
+                case TokenType::SLASH: kind = AstExprTypedBinary::DOUBLE_DIVIDE; return true;
+                case TokenType::LESS: kind = AstExprTypedBinary::DOUBLE_LESS; return true;
+                case TokenType::LESS_EQUAL: kind = AstExprTypedBinary::DOUBLE_LESS_EQUAL; return true;
+                case TokenType::GREATER: kind = AstExprTypedBinary::DOUBLE_GREATER; return true;
+                case TokenType::GREATER_EQUAL: kind = AstExprTypedBinary::DOUBLE_GREATER_EQUAL; return true;
+                case TokenType::EQUAL_EQUAL: kind = AstExprTypedBinary::DOUBLE_EQUAL; return true;
+                case TokenType::BANG_EQUAL: kind = AstExprTypedBinary::DOUBLE_NOT_EQUAL; return true;
+                default: return false;
+            }
+        case PrimitiveType::Character:
+            switch (op) {
+                case TokenType::LESS: kind = AstExprTypedBinary::CHAR_LESS; return true;
+                case TokenType::LESS_EQUAL: kind = AstExprTypedBinary::CHAR_LESS_EQUAL; return true;
+                case TokenType::GREATER: kind = AstExprTypedBinary::CHAR_GREATER; return true;
+                case TokenType::GREATER_EQUAL: kind = AstExprTypedBinary::CHAR_GREATER_EQUAL; return true;
+                case TokenType::EQUAL_EQUAL: kind = AstExprTypedBinary::CHAR_EQUAL; return true;
+                case TokenType::BANG_EQUAL: kind = AstExprTypedBinary::CHAR_NOT_EQUAL; return true;
+                default: return false;
+            }
+        case PrimitiveType::Boolean:
+            switch (op) {
+                case TokenType::EQUAL_EQUAL: kind = AstExprTypedBinary::BOOL_EQUAL; return true;
+                case TokenType::BANG_EQUAL: kind = AstExprTypedBinary::BOOL_NOT_EQUAL; return true;
+                default: return false;
+            }
+        case PrimitiveType::String:
+            switch (op) {
+                case TokenType::PLUS: kind = AstExprTypedBinary::STRING_CONCAT; return true;
+                case TokenType::LESS: kind = AstExprTypedBinary::STRING_LESS; return true;
+                case TokenType::LESS_EQUAL: kind = AstExprTypedBinary::STRING_LESS_EQUAL; return true;
+                case TokenType::GREATER: kind = AstExprTypedBinary::STRING_GREATER; return true;
+                case TokenType::GREATER_EQUAL: kind = AstExprTypedBinary::STRING_GREATER_EQUAL; return true;
+                case TokenType::EQUAL_EQUAL: kind = AstExprTypedBinary::STRING_EQUAL; return true;
+                case TokenType::BANG_EQUAL: kind = AstExprTypedBinary::STRING_NOT_EQUAL; return true;
+                default: return false;
+            }
+        default:
+            return false;
+    }
+}
+
+void TypeSpecializer::specialize(std::vector<AstStatPtr>& statements) {
+    transform(statements);
+}
+
+void TypeSpecializer::visitUnaryExpr(AstExprUnary& expr) {
+    AstTransformer::visitUnaryExpr(expr);
+
+    PrimitiveType::PrimitiveKind operand;
+    AstExprTypedUnary::Kind kind;
+    if (!primitiveKind(expr.right_->type_, operand) || !unaryKind(expr.op_.type_, operand, kind))
+        return;
+
+    auto typed = std::make_unique<AstExprTypedUnary>(expr.line_, expr.op_, std::move(expr.right_), kind);
+    typed->type_ = expr.type_;
+    exprReplacement_ = std::move(typed);
+}
+
+void TypeSpecializer::visitBinaryExpr(AstExprBinary& expr) {
+    AstTransformer::visitBinaryExpr(expr);
+
+    PrimitiveType::PrimitiveKind left;
+    PrimitiveType::PrimitiveKind right;
+    AstExprTypedBinary::Kind kind;
+    if (!primitiveKind(expr.left_->type_, left) || !primitiveKind(expr.right_->type_, right) || left != right)
+        return;
+    if (!binaryKind(expr.op_.type_, left, kind))
+        return;
+
+    auto typed = std::make_unique<AstExprTypedBinary>(expr.line_, std::move(expr.left_), expr.op_, std::move(expr.right_), kind);
+    typed->type_ = expr.type_;
+    exprReplacement_ = std::move(typed);
+}
@@ -75,7 +75,9 @@ TypePtr TypeEnvironment::assignedType(const std::string& name) {
 Checker::Checker(Utils::ErrorHandler& errorHandler)
     : errorHandler_(errorHandler)
     , globals_(std::make_shared<TypeEnvironment>())
-    , env_(globals_) {}
+    , env_(globals_)
+    , loopDepth_(0)
+    , currFunctionRetTy_(nullptr) {}
 
 void Checker::check(const std::vector<AstStatPtr> &statements) {
     // type checking
@@ -100,6 +102,7 @@ void Checker::checkStat(AstStat& stat) {
 
 TypePtr Checker::checkExpr(AstExpr& expr) {
     expr.accept(*this);
+    expr.type_ = result_;
     return std::move(result_);
 }
 
@@ -552,7 +555,11 @@ void Checker::visitFuncDeclStat(AstStatFuncDecl& stat) {
     TypeEnvironmentGuard guard(env_, fnScope);
     TypePtr previousReturnTy = currFunctionRetTy_;
     currFunctionRetTy_ = returnTy;
+    // A loop around the declaration does not reach into the body, which runs wherever it is called
+    int previousLoopDepth = loopDepth_;
+    loopDepth_ = 0;
     checkStat(*stat.body_);
+    loopDepth_ = previousLoopDepth;
     currFunctionRetTy_ = previousReturnTy;
 }
 
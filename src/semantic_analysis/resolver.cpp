@@ -0,0 +1,239 @@
+#include <latimer/semantic_analysis/resolver.hpp>
+
+#include <iostream>
+
+#include <latimer/interpreter/native_functions.hpp>
+
+Resolver::Resolver(Utils::ErrorHandler& errorHandler)
+    : errorHandler_(errorHandler)
+    , scopes_()
+    , natives_() {}
+
+void Resolver::resolve(const std::vector<AstStatPtr>& statements) {
+    scopes_.clear();
+    natives_.clear();
+
+    // Natives take the first global slots, in the order the AstInterpreter defines them
+    beginScope(false);
+    for (auto& native : nativeFunctions())
+        natives_.insert({native.first, declare(native.first)});
+
+    try {
+        for (const AstStatPtr& stat : statements) {
+            if (!stat) throw InternalCompilerError("[Internal Compiler Error]: nullptr statement in AST list.");
+
+            resolveStat(*stat);
+        }
+    } catch (InternalCompilerError error) {
+        std::cerr << error.what() << std::endl;
+        errorHandler_.hadError_ = true;
+    }
+}
+
+void Resolver::resolveStat(AstStat& stat) {
+    stat.accept(*this);
+}
+
+void Resolver::resolveExpr(AstExpr& expr) {
+    expr.accept(*this);
+}
+
+void Resolver::beginScope(bool isClosure) {
+    scopes_.push_back({{}, 0, isClosure});
+}
+
+size_t Resolver::endScope() {
+    size_t slotCount = scopes_.back().slotCount_;
+    scopes_.pop_back();
+    return slotCount;
+}
+
+int Resolver::declare(const std::string& name) {
+    Scope& scope = scopes_.back();
+    int slot = scope.slotCount_++;
+    scope.slots_.insert({name, slot}); // Like Environment::define, the first definition of a name wins
+    return slot;
+}
+
+VariableSlot Resolver::lookup(const std::string& name) {
+    for (size_t i = scopes_.size(); i-- > 0;) {
+        const Scope& scope = scopes_[i];
+        auto found = scope.slots_.find(name);
+
+        if (found != scope.slots_.end()) {
+            if (scope.isClosure_)
+                return {VariableSlot::CAPTURE, found->second};
+
+            int depth = i == 0 ? VariableSlot::GLOBAL : static_cast<int>(scopes_.size() - 1 - i);
+            return {depth, found->second};
+        }
+
+        // A function sees nothing past its closure
+        if (scope.isClosure_)
+            break;
+    }
+
+    auto native = natives_.find(name);
+    if (native != natives_.end())
+        return {VariableSlot::GLOBAL, native->second};
+
+    return {VariableSlot::UNRESOLVED, 0};
+}
+
+void Resolver::visitPrimitiveType(AstTypePrimitive& type) {
+
+}
+
+void Resolver::visitFunctionType(AstTypeFunction& type) {
+
+}
+
+void Resolver::visitGroupExpr(AstExprGroup& expr) {
+    resolveExpr(*expr.expr_);
+}
+
+void Resolver::visitUnaryExpr(AstExprUnary& expr) {
+    resolveExpr(*expr.right_);
+}
+
+void Resolver::visitBinaryExpr(AstExprBinary& expr) {
+    resolveExpr(*expr.left_);
+    resolveExpr(*expr.right_);
+}
+
+void Resolver::visitTernaryExpr(AstExprTernary& expr) {
+    resolveExpr(*expr.condition_);
+    resolveExpr(*expr.thenBranch_);
+    resolveExpr(*expr.elseBranch_);
+}
+
+void Resolver::visitLiteralNullExpr(AstExprLiteralNull& expr) {
+
+}
+
+void Resolver::visitLiteralBoolExpr(AstExprLiteralBool& expr) {
+
+}
+
+void Resolver::visitLiteralIntExpr(AstExprLiteralInt& expr) {
+
+}
+
+void Resolver::visitLiteralDoubleExpr(AstExprLiteralDouble& expr) {
+
+}
+
+void Resolver::visitLiteralStringExpr(AstExprLiteralString& expr) {
+
+}
+
+void Resolver::visitLiteralCharExpr(AstExprLiteralChar& expr) {
+
+}
+
+void Resolver::visitVariableExpr(AstExprVariable& expr) {
+    expr.slot_ = lookup(expr.name_.lexeme_);
+}
+
+void Resolver::visitHoistedExpr(AstExprHoisted& expr) {
+    expr.slot_ = lookup(expr.name_.lexeme_);
+    resolveExpr(*expr.expr_);
+}
+
+void Resolver::visitAssignmentExpr(AstExprAssignment& expr) {
+    resolveExpr(*expr.value_);
+    expr.slot_ = lookup(expr.name_.lexeme_);
+}
+
+void Resolver::visitCallExpr(AstExprCall& expr) {
+    resolveExpr(*expr.callee_);
+    for (const auto& arg : expr.args_)
+        resolveExpr(*arg);
+}
+
+void Resolver::visitVarDeclStat(AstStatVarDecl& stat) {
+    if (stat.initializer_ != nullptr)
+        resolveExpr(*stat.initializer_);
+
+    stat.slot_ = declare(stat.name_.lexeme_);
+}
+
+void Resolver::visitExpressionStat(AstStatExpression& stat) {
+    resolveExpr(*stat.expr_);
+}
+
+void Resolver::visitIfElseStat(AstStatIfElse& stat) {
+    resolveExpr(*stat.condition_);
+    resolveStat(*stat.thenBranch_);
+
+    if (stat.elseBranch_ != nullptr)
+        resolveStat(*stat.elseBranch_);
+}
+
+void Resolver::visitWhileStat(AstStatWhile& stat) {
+    resolveExpr(*stat.condition_);
+    resolveStat(*stat.body_);
+}
+
+void Resolver::visitForStat(AstStatFor& stat) {
+    beginScope(false);
+
+    if (stat.initializer_ != nullptr)
+        resolveStat(*stat.initializer_);
+    if (stat.condition_ != nullptr)
+        resolveExpr(*stat.condition_);
+    if (stat.increment_ != nullptr)
+        resolveExpr(*stat.increment_);
+    resolveStat(*stat.body_);
+
+    stat.localCount_ = endScope();
+}
+
+void Resolver::visitBreakStat(AstStatBreak& stat) {
+
+}
+
+void Resolver::visitContinueStat(AstStatContinue& stat) {
+
+}
+
+void Resolver::visitBlockStat(AstStatBlock& stat) {
+    beginScope(false);
+
+    for (const AstStatPtr& inner : stat.body_)
+        resolveStat(*inner);
+
+    stat.localCount_ = endScope();
+}
+
+void Resolver::visitFuncDeclStat(AstStatFuncDecl& stat) {
+    AstStatBlock* body = dynamic_cast<AstStatBlock*>(stat.body_.get());
+    if (!body)
+        throw InternalCompilerError("[Internal Compiler Error]: Function body is not a block statement.");
+
+    // Captures are read from the declaring scope before the function itself is defined there
+    stat.captureSlots_.clear();
+    for (const Token& capture : stat.captures_)
+        stat.captureSlots_.push_back(lookup(capture.lexeme_));
+    stat.slot_ = declare(stat.name_.lexeme_);
+
+    beginScope(true);
+    for (const Token& capture : stat.captures_)
+        declare(capture.lexeme_);
+    declare(stat.name_.lexeme_);
+
+    // UserFunction::call runs the body's statements directly in the parameters' environment
+    beginScope(false);
+    for (const Token& param : stat.paramNames_)
+        declare(param.lexeme_);
+    for (const AstStatPtr& inner : body->body_)
+        resolveStat(*inner);
+
+    stat.localCount_ = endScope();
+    endScope();
+}
+
+void Resolver::visitReturnStat(AstStatReturn& stat) {
+    if (stat.value_ != nullptr)
+        resolveExpr(*stat.value_);
+}
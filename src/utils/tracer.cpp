@@ -0,0 +1,124 @@
+#include <latimer/utils/tracer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+
+namespace {
+
+double microseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+} // namespace
+
+Tracer::Tracer(bool enabled, bool traceCalls)
+    : enabled_(enabled || traceCalls)
+    , traceCalls_(traceCalls)
+    , origin_(Clock::now())
+    , phases_()
+    , inPhase_(false)
+    , calls_()
+    , open_()
+    , droppedCalls_(0) {}
+
+bool Tracer::enabled() const {
+    return enabled_;
+}
+
+bool Tracer::tracesCalls() const {
+    return traceCalls_;
+}
+
+void Tracer::beginPhase(std::string name) {
+    if (!enabled_)
+        return;
+
+    endPhase();
+    phases_.push_back({std::move(name), Clock::now() - origin_, Clock::duration::zero(), {}});
+    inPhase_ = true;
+}
+
+void Tracer::endPhase() {
+    if (!enabled_ || !inPhase_)
+        return;
+
+    Phase& phase = phases_.back();
+    phase.duration_ = Clock::now() - origin_ - phase.start_;
+    inPhase_ = false;
+}
+
+void Tracer::count(std::string name, size_t value) {
+    if (!enabled_ || phases_.empty())
+        return;
+
+    phases_.back().counts_.push_back({std::move(name), value});
+}
+
+void Tracer::enterCall(const AstStatFuncDecl* function) {
+    if (calls_.size() >= MAX_CALL_SPANS) {
+        droppedCalls_++;
+        open_.push_back(SIZE_MAX);
+        return;
+    }
+
+    open_.push_back(calls_.size());
+    calls_.push_back({function, Clock::now() - origin_, Clock::duration::zero()});
+}
+
+void Tracer::exitCall() {
+    size_t index = open_.back();
+    open_.pop_back();
+    if (index != SIZE_MAX)
+        calls_[index].duration_ = Clock::now() - origin_ - calls_[index].start_;
+}
+
+void Tracer::printPhases(std::ostream& out) const {
+    Clock::duration total = Clock::duration::zero();
+    for (const Phase& phase : phases_)
+        total += phase.duration_;
+    double overall = std::max(microseconds(total), 1e-9);
+
+    out << std::fixed;
+    out << std::left << std::setw(12) << "phase" << std::right << std::setw(12) << "ms" << std::setw(9) << "%" << std::endl;
+    for (const Phase& phase : phases_) {
+        out << std::left << std::setw(12) << phase.name_ << std::right
+            << std::setw(12) << std::setprecision(3) << microseconds(phase.duration_) / 1000.0
+            << std::setw(8) << std::setprecision(1) << 100.0 * microseconds(phase.duration_) / overall << "%";
+        for (const auto& count : phase.counts_)
+            out << "  " << count.second << " " << count.first;
+        out << std::endl;
+    }
+    out << std::left << std::setw(12) << "total" << std::right << std::setw(12) << std::setprecision(3) << microseconds(total) / 1000.0 << std::endl;
+    out << std::defaultfloat;
+}
+
+void Tracer::writeTrace(std::ostream& out) const {
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+
+    bool first = true;
+    auto separate = [&]() {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    for (const Phase& phase : phases_) {
+        separate();
+        out << "{\"name\":\"" << phase.name_ << "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << microseconds(phase.start_) << ",\"dur\":" << microseconds(phase.duration_) << ",\"args\":{";
+        for (size_t i = 0; i < phase.counts_.size(); i++)
+            out << (i == 0 ? "" : ",") << "\"" << phase.counts_[i].first << "\":" << phase.counts_[i].second;
+        out << "}}";
+    }
+
+    for (const Call& call : calls_) {
+        separate();
+        out << "{\"name\":\"" << call.function_->name_.lexeme_ << "\",\"cat\":\"call\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << microseconds(call.start_) << ",\"dur\":" << microseconds(call.duration_)
+            << ",\"args\":{\"line\":" << call.function_->line_ << "}}";
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedCalls\":" << droppedCalls_ << "}}\n";
+    out << std::defaultfloat;
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+# Runs every script in tests/ through each engine and checks its output (stdout and stderr
+# together) against the .out file next to it. A runtime error is part of the expected output, so
+# every engine has to fail the same way at the same point.
+#
+#   tests/run.sh ./latimer                    # every test
+#   tests/run.sh ./latimer tests/null_*.lt    # just these
+#
+# ENGINES overrides the engine flags tried (default: the interpreter, --vm, --ir, --jit, --memoize,
+# --check-types, --no-opt and --emit-c, which builds the C with $CC, or cc, and runs it).
+
+latimer=${1:?usage: run.sh path/to/latimer [file.lt ...]}
+shift
+[ $# -eq 0 ] && set -- "$(dirname "$0")"/*.lt
+
+engines=${ENGINES:-"- --vm --ir --jit --memoize --check-types --no-opt --emit-c"}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+failed=0
+for file in "$@"; do
+    name=$(basename "$file" .lt)
+    expected="${file%.lt}.out"
+
+    for engine in $engines; do
+        [ "$engine" = "-" ] && flag="" || flag=$engine
+        if [ "$engine" = "--emit-c" ]; then
+            # What the C backend emits is compiled and run; a program it does not support is skipped
+            if "$latimer" --emit-c "$work/program.c" "$file" > "$work/actual.out" 2>&1; then
+                if ${CC:-cc} -O2 -o "$work/program" "$work/program.c" > "$work/actual.out" 2>&1; then
+                    "$work/program" > "$work/actual.out" 2>&1
+                fi
+            elif grep -q "The C backend does not support" "$work/actual.out"; then
+                continue
+            fi
+        else
+            "$latimer" $flag "$file" > "$work/actual.out" 2>&1
+        fi
+
+        if ! cmp -s "$expected" "$work/actual.out"; then
+            printf 'FAIL %-28s %s\n' "$name" "${flag:-(interpreter)}"
+            diff "$expected" "$work/actual.out" | head -n 10
+            failed=$((failed + 1))
+        fi
+    done
+done
+
+[ "$failed" -eq 0 ] && echo "all passed" || echo "$failed failed"
+[ "$failed" -eq 0 ]